@@ -0,0 +1,93 @@
+/* admission_control.h
+Header file for the connection and in-flight request limits that shed load.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef ADMISSION_CONTROL_HPP
+#define ADMISSION_CONTROL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+#include "config_parser.h"
+#include "request_dispatcher.h"
+#include "request_handler.h"
+#include "response.h"
+
+/// Decides whether a new connection or request may start.
+///
+/// Global limits come from max_connections and max_requests_in_flight, and each
+/// location may set its own max_requests_in_flight. A value of 0 means no limit.
+/// All counting is lock free, so the checks are cheap enough to do on every accept
+/// and every request. When the connection limit is reached the servers stop
+/// accepting for a while; when a request limit is reached the session answers with
+/// the prebuilt 503 from shed_request() and the handler never runs.
+///
+/// Bodies are limited the same way: by client_max_body_size, which a location may
+/// override, checked by the session once a request's head says where it goes.
+///
+/// Once begin_drain() is called no new connection is admitted, while requests on
+/// connections that are already open still run (see server::drain()).
+class admission_control {
+ public:
+    admission_control(const NginxConfig& config, request_dispatcher& dispatcher);
+
+    admission_control(const admission_control&) = delete;
+    admission_control& operator=(const admission_control&) = delete;
+
+    /// Reserve a connection slot before accepting. False means stop accepting for now,
+    /// or for good while draining.
+    bool try_open_connection();
+    /// Count a connection the kernel already accepted, with no limit to check.
+    void open_connection();
+    /// Give back a slot from try_open_connection() or open_connection().
+    void close_connection();
+
+    /// Reserve a request slot globally and for handler's location. False means no slot
+    /// is free; the request is only counted as shed once it is answered with
+    /// shed_request(), since the session may try again once its body has arrived.
+    bool try_start_request(const request_handler* handler);
+    /// Give back a slot from try_start_request().
+    void finish_request(const request_handler* handler);
+
+    /// Most body bytes a request for handler's location may send, 0 for no limit.
+    std::size_t max_body_size(const request_handler* handler) const;
+
+    /// Stop admitting connections for good, ahead of a graceful shutdown.
+    void begin_drain() { draining_.store(true); }
+    bool draining() const { return draining_.load(); }
+
+    /// 503 sent to shed requests, built once.
+    const Response& service_unavailable() const { return service_unavailable_; }
+    /// Count a request as shed and return the 503 to answer it with.
+    const Response& shed_request();
+
+ private:
+    static bool try_acquire(std::atomic<int>& counter, int limit);
+
+    std::atomic<bool> draining_{false};
+    int max_connections_;
+    int max_requests_in_flight_;
+    // Location limits keyed by the location's handler, which is what the dispatcher
+    // resolves for each request. Built once, then only read.
+    struct location_limit {
+        int max_requests_in_flight;
+        std::atomic<int> requests_in_flight{0};
+    };
+    std::unordered_map<const request_handler*, std::unique_ptr<location_limit> > location_limits_;
+    std::size_t max_body_size_;
+    std::unordered_map<const request_handler*, std::size_t> location_max_body_size_;
+    Response service_unavailable_;
+};
+
+#endif  // ADMISSION_CONTROL_HPP
@@ -13,6 +13,7 @@ Date Created:
 #ifndef HTTP_BLOG_UPLOAD_REQUEST_HANDLER_HPP
 #define HTTP_BLOG_UPLOAD_REQUEST_HANDLER_HPP
 
+#include <memory>
 #include <string>
 #include "request_handler.h"
 #include "config_parser.h"
@@ -26,19 +27,20 @@ class blog_upload_request_handler: public request_handler {
     ~blog_upload_request_handler();
     static blog_upload_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
+    virtual std::unique_ptr<body_consumer> start_body_stream(const RequestView& head);
     std::string getLocationPrefix();
 
  private:
+    class form_stream;
+
     Response handle_get_one_blog(int id);
     Response handle_get_all_blogs();
     Response handle_post_blog(std::string title, std::string body);
 
-    std::map<std::string, std::string> parseRequestBody(std::string body);
-    std::string urldecode(const std::string & sSrc);
-    unsigned char from_hex (unsigned char ch);
+    static unsigned char from_hex (unsigned char ch);
     bool is_number(const std::string& enter_string);
 
-    std::map<std::string, std::string> form_to_value_;
     std::string location_prefix_;
     database* bd_;
 };
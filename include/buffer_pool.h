@@ -0,0 +1,80 @@
+/* buffer_pool.h
+Header file for the per-thread pool of session read buffers.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <cstddef>
+
+/// Per-thread free lists of read buffers, one list per size class.
+///
+/// Blocks are plain heap allocations, so a block acquired on one thread may be
+/// released on another; it simply joins the releasing thread's free list.
+class buffer_pool {
+ public:
+    enum {
+        num_size_classes = 5,
+        // Free blocks kept per size class per thread, the rest go back to the heap.
+        max_free_per_class = 64
+    };
+
+    /// Smallest size class that holds at least min_size bytes, or the largest class.
+    static std::size_t size_class(std::size_t min_size);
+    static std::size_t class_capacity(std::size_t size_class);
+
+    /// Borrow a block of class_capacity(size_class) bytes.
+    static char* acquire(std::size_t size_class);
+    /// Return a block borrowed with acquire(size_class).
+    static void release(char* block, std::size_t size_class);
+
+    /// Number of free blocks of a size class held by the calling thread.
+    static std::size_t free_count(std::size_t size_class);
+};
+
+/// A growable buffer that borrows its storage from buffer_pool.
+///
+/// Holds no storage until reserve() is called and gives it back on release(),
+/// so an idle session costs nothing but the object itself.
+class pooled_buffer {
+ public:
+    pooled_buffer();
+    ~pooled_buffer();
+    pooled_buffer(const pooled_buffer&) = delete;
+    pooled_buffer& operator=(const pooled_buffer&) = delete;
+
+    /// Make room for at least min_free more bytes, borrowing or growing the block.
+    void reserve(std::size_t min_free);
+    /// Give the block back to the pool. Any unconsumed bytes are dropped.
+    void release();
+
+    bool has_storage() const { return data_ != nullptr; }
+    char* data() { return data_; }
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const;
+
+    /// Free space after the filled bytes, where the next read lands.
+    char* tail() { return data_ + size_; }
+    std::size_t tail_capacity() const { return capacity() - size_; }
+
+    /// Mark n bytes after tail() as filled.
+    void commit(std::size_t n) { size_ += n; }
+    /// Drop the first n filled bytes, moving the rest to the front.
+    void consume(std::size_t n);
+
+ private:
+    char* data_;
+    std::size_t size_;
+    std::size_t size_class_;
+};
+
+#endif  // BUFFER_POOL_HPP
@@ -14,6 +14,9 @@ Date Created:
 #ifndef NGINX_CONFIG_PARSER
 #define NGINX_CONFIG_PARSER
 
+#include <sys/socket.h>
+
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -33,10 +36,93 @@ class NginxConfigStatement {
 // The parsed representation of the entire config.
 class NginxConfig {
  public:
-  NginxConfig() : port_number(-1) {}
+  NginxConfig() : port_number(-1), worker_threads(0),
+                  worker_cpu_affinity(CPU_AFFINITY_AUTO), reuse_port(false),
+                  io_backend(IO_BACKEND_EPOLL),
+                  client_header_timeout_ms(60000), client_body_timeout_ms(60000),
+                  keepalive_timeout_ms(75000), send_timeout_ms(60000),
+                  listen_backlog(0), accept_concurrency(1),
+                  accept_flags(SOCK_NONBLOCK | SOCK_CLOEXEC),
+                  max_connections(0), max_requests_in_flight(0), drain_timeout_ms(30000),
+                  client_max_uri_size(8 * 1024), client_max_header_size(64 * 1024),
+                  client_max_header_count(100), client_max_body_size(1024 * 1024) {}
   std::vector<std::shared_ptr<NginxConfigStatement> > statements_;
   int port_number;
 
+  // Whether io threads get pinned to a CPU. AUTO pins only in reuseport mode,
+  // where each thread owns its own io_service and acceptor.
+  enum CpuAffinity {
+    CPU_AFFINITY_AUTO = 0,
+    CPU_AFFINITY_ON = 1,
+    CPU_AFFINITY_OFF = 2
+  };
+
+  // Number of io threads, 0 means one per available CPU ("worker_threads auto;")
+  int worker_threads;
+  CpuAffinity worker_cpu_affinity;
+  // One io_service and SO_REUSEPORT acceptor per io thread ("reuseport on;")
+  bool reuse_port;
+
+  // How sessions and acceptors do their socket I/O ("io_backend io_uring;"). The asio
+  // reactor (epoll) is the default; io_uring falls back to it when unavailable.
+  enum IoBackend {
+    IO_BACKEND_EPOLL = 0,
+    IO_BACKEND_IO_URING = 1
+  };
+  IoBackend io_backend;
+
+  // Connection timeouts in milliseconds, 0 disables one. Header covers a whole request
+  // head, body and send apply between two successive reads or writes, keepalive is the
+  // idle time allowed between requests.
+  int client_header_timeout_ms;
+  int client_body_timeout_ms;
+  int keepalive_timeout_ms;
+  int send_timeout_ms;
+  // How long SIGTERM waits for open connections to finish before exiting anyway.
+  int drain_timeout_ms;
+
+  // listen() backlog, 0 means the system maximum (SOMAXCONN).
+  int listen_backlog;
+  // Readiness waits kept outstanding on each acceptor. Each wake-up drains the accept
+  // queue, so more than one only helps when several threads share an acceptor.
+  int accept_concurrency;
+  // Flags passed to accept4 ("accept_flags nonblock,cloexec;").
+  int accept_flags;
+
+  // Admission limits, 0 means unlimited. Over max_connections the servers stop
+  // accepting, over max_requests_in_flight requests get a 503.
+  int max_connections;
+  int max_requests_in_flight;
+  // key: location path, value: max_requests_in_flight set inside that location block
+  std::unordered_map<std::string, int> location_max_requests_in_flight_;
+
+  // Request size limits in bytes (a count for headers), 0 means unlimited. The head limit
+  // covers the request line, the headers and the empty line after them. Requests over
+  // them get a 414, 431 or 413.
+  std::size_t client_max_uri_size;
+  std::size_t client_max_header_size;
+  std::size_t client_max_header_count;
+  std::size_t client_max_body_size;
+  // key: location path, value: client_max_body_size set inside that location block
+  std::unordered_map<std::string, std::size_t> location_client_max_body_size_;
+
+  // Response compression, see response_compressor.h ("gzip on;"). text/html is always
+  // among the MIME types compressed and gzip_types adds more ("*" for any type).
+  // Bodies shorter than gzip_min_length are sent as they are. gzip_static has static
+  // locations serve .gz siblings of the files they would compress. A location block
+  // may set its own; it starts from the server's settings wherever it appears.
+  struct Compression {
+    bool enabled = false;
+    bool static_variants = false;
+    std::vector<std::string> types{"text/html"};
+    std::size_t min_length = 256;
+    // zlib level, 1 (fastest) to 9 (smallest)
+    int level = 6;
+  };
+  Compression compression;
+  // key: location path, value: compression settings of that location block
+  std::unordered_map<std::string, Compression> location_compression_;
+
   // key: client path, value: server path
   std::unordered_map<std::string, std::string> static_locations_;
   std::unordered_set<std::string> echo_locations_;
@@ -61,6 +147,16 @@ class NginxConfigParser {
   // parsed config in the provided NginxConfig out-param.  Returns true
   // iff the input config file is valid.
   void SetConfigPortNumberFromToken(std::string port_token, NginxConfig* config);
+  void ParseServerDirectives(NginxConfig* config);
+  void ParseLocationDirectives(const std::string& location, const NginxConfig& block, NginxConfig* config);
+  // Applies a gzip, gzip_static, gzip_types, gzip_min_length or gzip_comp_level
+  // statement to compression. Returns false if the statement is none of those.
+  static bool ParseCompressionDirective(const std::vector<std::string>& tokens,
+                                        NginxConfig::Compression* compression);
+  // Returns the duration in milliseconds ("30", "30s", "500ms", "2m"), or -1 if invalid.
+  static int ParseDuration(const std::string& value);
+  // Returns the size in bytes ("512", "8k", "1m", "1g"), or -1 if invalid.
+  static long long ParseSize(const std::string& value);
   bool Parse(std::istream* config_file, NginxConfig* config);
   bool Parse(const char* file_name, NginxConfig* config);
 
@@ -22,9 +22,10 @@ class echo_request_handler: public request_handler {
  public:  // API uses public functions
     static echo_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
  private:
     std::string echo_path_;
-    std::string build_request_string(const Request& request);
+    std::string build_request_string(const RequestView& request);
 };
 
 #endif  // INCLUDE_ECHO_REQUEST_HANDLER_H_
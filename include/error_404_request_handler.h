@@ -22,6 +22,7 @@ class error_404_request_handler: public request_handler {
  public:
     static error_404_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
 
  private:
     std::string error_path_;
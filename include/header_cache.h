@@ -0,0 +1,45 @@
+/* header_cache.h
+Header file for the per-thread cache of the headers every response carries.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HEADER_CACHE_HPP
+#define HEADER_CACHE_HPP
+
+#include <cstddef>
+#include <ctime>
+#include <string_view>
+
+/// The Server, Date and Connection header lines the response serializer splices
+/// into every head, kept as ready-to-copy bytes.
+///
+/// Each thread has its own Server and Date block, formatted again only when a
+/// response is written in a new second, so a response costs a coarse clock read
+/// instead of formatting a date. The views common() returns stay valid on the
+/// calling thread until the next call, and always have the same size.
+class header_cache {
+ public:
+    /// Length of an IMF-fixdate, "Sun, 06 Nov 1994 08:49:37 GMT".
+    enum { date_size = 29 };
+
+    /// "Server: ...\r\nDate: ...\r\n" for the current second.
+    static std::string_view common();
+    /// The Server line on its own, which never changes.
+    static std::string_view server_line();
+    static std::string_view connection_close();
+    static std::string_view connection_keep_alive();
+
+    /// Format a time as an IMF-fixdate (RFC 7231 7.1.1.1) into out, which has room
+    /// for date_size bytes.
+    static void format_date(std::time_t time, char* out);
+};
+
+#endif  // HEADER_CACHE_HPP
@@ -0,0 +1,149 @@
+/* header_map.h
+Header file for the header container of Request and Response.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HTTP_HEADER_MAP_HPP
+#define HTTP_HEADER_MAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "http_tokens.h"
+
+/// Headers the server itself reads or writes, which header_map finds without
+/// searching.
+enum class header_id : unsigned char {
+    other,
+    accept,
+    accept_encoding,
+    connection,
+    content_encoding,
+    content_length,
+    content_type,
+    date,
+    expect,
+    host,
+    location,
+    retry_after,
+    server,
+    transfer_encoding,
+    user_agent,
+    vary,
+    count  // Number of ids, not a header
+};
+
+/// Canonical spelling of a well-known header's name, e.g. "Content-Length".
+std::string_view header_name(header_id id);
+
+/// Id of a header name, compared case-insensitively; header_id::other if the
+/// header is not well known.
+header_id lookup_header_id(std::string_view name);
+
+/// Hash of a header name that ignores ASCII case (FNV-1a over the name with
+/// letters folded to lower case), the same one http_tokens::headers uses.
+constexpr std::uint32_t header_name_hash(std::string_view name) {
+    return http_tokens::token_hash(name, true);
+}
+
+struct header_entry {
+    std::string name;
+    std::string value;
+    header_id id = header_id::other;
+    std::uint32_t hash = 0;
+};
+
+/// Headers in the order they were added, duplicates included, with names
+/// compared case-insensitively.
+///
+/// The first inline_capacity headers live inside the object, so a typical
+/// request or response allocates nothing for its headers; past that they all
+/// move to the heap. Other headers are found by a scan that compares name
+/// hashes before names, and the first header with each well-known id is kept
+/// in a table, so operator[](header_id) is a single lookup.
+class header_map {
+    public:
+        enum { inline_capacity = 16 };
+
+        typedef header_entry value_type;
+        typedef header_entry* iterator;
+        typedef const header_entry* const_iterator;
+
+        header_map();
+        header_map(std::initializer_list<std::pair<std::string_view, std::string_view>> headers);
+        header_map(const header_map& other);
+        header_map(header_map&& other) noexcept;
+        header_map& operator=(const header_map& other);
+        header_map& operator=(header_map&& other) noexcept;
+
+        iterator begin() { return data(); }
+        iterator end() { return data() + size(); }
+        const_iterator begin() const { return data(); }
+        const_iterator end() const { return data() + size(); }
+        std::size_t size() const { return on_heap_ ? heap_.size() : size_; }
+        bool empty() const { return size() == 0; }
+        void clear();
+
+        /// Value of the first header called name, added with an empty value if
+        /// there is none.
+        std::string& operator[](std::string_view name);
+        std::string& operator[](header_id id);
+
+        /// The first header called name, or end().
+        iterator find(std::string_view name);
+        const_iterator find(std::string_view name) const;
+        iterator find(header_id id);
+        const_iterator find(header_id id) const;
+
+        /// Value of the first header called name; throws std::out_of_range if
+        /// there is none.
+        const std::string& at(std::string_view name) const;
+        /// Value of the first header with a well-known id, or an empty view.
+        std::string_view get(header_id id) const;
+        std::size_t count(std::string_view name) const;
+
+        /// Add a header after the others, even if one with its name is there.
+        void add(std::string_view name, std::string_view value);
+        /// Remove every header called name, returning how many there were.
+        std::size_t erase(std::string_view name);
+
+    private:
+        header_entry* data() { return on_heap_ ? heap_.data() : inline_.data(); }
+        const header_entry* data() const { return on_heap_ ? heap_.data() : inline_.data(); }
+        std::size_t index(header_id id) const { return static_cast<std::size_t>(id); }
+        std::size_t find_position(std::string_view name, std::uint32_t hash) const;
+        header_entry& append(std::string_view name, header_id id, std::uint32_t hash);
+        void reindex();
+
+        std::array<header_entry, inline_capacity> inline_;
+        std::size_t size_;
+        // Holds every header instead of inline_ once there are too many.
+        std::vector<header_entry> heap_;
+        bool on_heap_;
+        // Position + 1 of the first header with each well-known id, 0 if there is none.
+        std::array<std::uint16_t, static_cast<std::size_t>(header_id::count)> first_;
+};
+
+/// Equal when both have the same headers with the same values. Like HTTP, this
+/// ignores the order of headers with different names but not the order of
+/// headers with the same name.
+bool operator==(const header_map& lhs, const header_map& rhs);
+inline bool operator!=(const header_map& lhs, const header_map& rhs) {
+    return !(lhs == rhs);
+}
+
+#endif  // HTTP_HEADER_MAP_HPP
@@ -0,0 +1,50 @@
+/* http_scanner.h
+Header file for the vectorized character scans used by request_parser.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HTTP_SCANNER_HPP
+#define HTTP_SCANNER_HPP
+
+/// Finds where a run of one kind of request-head character ends, 16 or 32 bytes
+/// at a time.
+///
+/// Each find_*_end returns the first byte in [begin, end) that does not belong
+/// to the run, or end. The character classes match request_parser's per-byte
+/// checks:
+///     token: method and header name characters (no CTLs, tspecials or bytes
+///            above 127).
+///     uri:   anything but CTLs and SP.
+///     value: anything but CTLs (so it stops at CR).
+///
+/// find_either is the scan the URI decoder uses to skip to the next byte it has to
+/// look at (a '%' escape, a '.' that may start a dot segment, a '+' in a query).
+///
+/// The implementation is picked once from what the CPU supports: AVX2, then
+/// SSE4.2, then a table-driven scalar loop on other CPUs and architectures.
+class http_scanner {
+    public:
+        enum level { scalar, sse42, avx2 };
+
+        static const char* find_token_end(const char* begin, const char* end);
+        static const char* find_uri_end(const char* begin, const char* end);
+        static const char* find_value_end(const char* begin, const char* end);
+        /// The first byte in [begin, end) equal to a or b, or end.
+        static const char* find_either(const char* begin, const char* end, char a, char b);
+
+        /// The implementation in use.
+        static level active();
+        /// Switch implementations, for tests and benchmarks. False if the CPU
+        /// lacks the instructions, in which case nothing changes.
+        static bool use(level implementation);
+};
+
+#endif  // HTTP_SCANNER_HPP
@@ -0,0 +1,300 @@
+/* http_tokens.h
+Header file for the compile-time lookup tables of HTTP tokens: request methods,
+well-known header names, MIME types by file extension and status lines.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HTTP_TOKENS_HPP
+#define HTTP_TOKENS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace http_tokens {
+
+/// FNV-1a hash of a token, with ASCII letters folded to lower case if fold_case.
+constexpr std::uint32_t token_hash(std::string_view token, bool fold_case) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : token) {
+        unsigned char byte = c;
+        if (fold_case && c >= 'A' && c <= 'Z') {
+            byte = c + ('a' - 'A');
+        }
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+constexpr bool tokens_equal(std::string_view lhs, std::string_view rhs, bool fold_case) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        char a = lhs[i];
+        char b = rhs[i];
+        if (fold_case) {
+            a = (a >= 'A' && a <= 'Z') ? a + ('a' - 'A') : a;
+            b = (b >= 'A' && b <= 'Z') ? b + ('a' - 'A') : b;
+        }
+        if (a != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// A fixed set of N tokens with a collision-free hash, found by the compiler.
+///
+/// The constructor tries seeds until every token's slot, (token_hash ^ seed) times a
+/// large odd constant and shifted down, is one no other token uses. A lookup is then
+/// one hash, one slot and one compare, with no probing. Tables are built in constant
+/// expressions only: a set no seed separates (e.g. one with a duplicate) makes the
+/// constructor throw, which stops the build.
+template <std::size_t N, bool FoldCase>
+class perfect_hash {
+    public:
+        static_assert(N > 0 && N < 255, "slots hold a token index in a byte");
+
+        constexpr explicit perfect_hash(const std::string_view (&tokens)[N])
+            : tokens_(), hashes_(), seed_(0), slots_() {
+            for (std::size_t i = 0; i < N; ++i) {
+                tokens_[i] = tokens[i];
+                hashes_[i] = hash(tokens[i]);
+            }
+            for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+                if (try_seed(seed)) {
+                    seed_ = seed;
+                    return;
+                }
+            }
+            throw "no seed separates these tokens";
+        }
+
+        static constexpr std::uint32_t hash(std::string_view token) {
+            return token_hash(token, FoldCase);
+        }
+
+        /// Index of token in the array the table was built from, or -1.
+        constexpr int find(std::string_view token) const {
+            return find(token, hash(token));
+        }
+
+        /// Same, for a caller that already has the token's hash.
+        constexpr int find(std::string_view token, std::uint32_t token_hash) const {
+            int index = static_cast<int>(slots_[slot(token_hash, seed_)]) - 1;
+            if (index < 0 || hashes_[index] != token_hash ||
+                !tokens_equal(tokens_[index], token, FoldCase)) {
+                return -1;
+            }
+            return index;
+        }
+
+        constexpr std::string_view operator[](std::size_t index) const { return tokens_[index]; }
+        constexpr std::uint32_t hash_of(std::size_t index) const { return hashes_[index]; }
+        static constexpr std::size_t size() { return N; }
+
+    private:
+        static constexpr unsigned slot_bits() {
+            unsigned bits = 1;
+            while ((std::size_t(1) << bits) < 2 * N) {
+                ++bits;
+            }
+            return bits;
+        }
+        static constexpr std::size_t slot_count = std::size_t(1) << slot_bits();
+
+        static constexpr std::size_t slot(std::uint32_t token_hash, std::uint32_t seed) {
+            return static_cast<std::uint32_t>((token_hash ^ seed) * 2654435761u) >> (32 - slot_bits());
+        }
+
+        constexpr bool try_seed(std::uint32_t seed) {
+            for (std::size_t i = 0; i < slot_count; ++i) {
+                slots_[i] = 0;
+            }
+            for (std::size_t i = 0; i < N; ++i) {
+                std::size_t s = slot(hashes_[i], seed);
+                if (slots_[s] != 0) {
+                    return false;
+                }
+                slots_[s] = static_cast<std::uint8_t>(i + 1);
+            }
+            return true;
+        }
+
+        std::array<std::string_view, N> tokens_;
+        std::array<std::uint32_t, N> hashes_;
+        std::uint32_t seed_;
+        // Index + 1 of the token in each slot, 0 for an empty slot.
+        std::array<std::uint8_t, slot_count> slots_;
+};
+
+/// Request methods, case-sensitive, in the order of Request::MethodEnum.
+inline constexpr perfect_hash<8, false> methods({
+    "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE",
+});
+
+/// Canonical names of the well-known headers, compared case-insensitively, in the
+/// order of header_id (index 0 is header_id::other).
+inline constexpr perfect_hash<16, true> headers({
+    "",
+    "Accept",
+    "Accept-Encoding",
+    "Connection",
+    "Content-Encoding",
+    "Content-Length",
+    "Content-Type",
+    "Date",
+    "Expect",
+    "Host",
+    "Location",
+    "Retry-After",
+    "Server",
+    "Transfer-Encoding",
+    "User-Agent",
+    "Vary",
+});
+
+/// File extensions the static handler knows, and their MIME types in the same order.
+inline constexpr perfect_hash<9, false> mime_extensions({
+    "gif", "htm", "html", "jpg", "jpeg", "png", "zip", "txt", "pdf",
+});
+inline constexpr std::string_view mime_types[] = {
+    "image/gif", "text/html", "text/html", "image/jpeg", "image/jpeg", "image/png",
+    "application/zip", "text/plain", "application/pdf",
+};
+static_assert(sizeof(mime_types) / sizeof(mime_types[0]) == mime_extensions.size(),
+              "a MIME type for every extension");
+
+/// MIME type of a file extension (without the dot), or an empty view if unknown.
+inline std::string_view mime_type(std::string_view extension) {
+    int index = mime_extensions.find(extension);
+    return index < 0 ? std::string_view() : mime_types[index];
+}
+
+struct status {
+    int code;
+    std::string_view line;
+};
+
+/// Status lines of the HTTP/1.1 status codes (RFC 7231 and its successors), every one
+/// in Response::StatusCode among them. Each is written for HTTP/1.1; an answer to an
+/// HTTP/1.0 request changes the version digit at status_minor_version_offset.
+inline constexpr status statuses[] = {
+    {100, "HTTP/1.1 100 Continue\r\n"},
+    {101, "HTTP/1.1 101 Switching Protocols\r\n"},
+    {200, "HTTP/1.1 200 OK\r\n"},
+    {201, "HTTP/1.1 201 Created\r\n"},
+    {202, "HTTP/1.1 202 Accepted\r\n"},
+    {203, "HTTP/1.1 203 Non-Authoritative Information\r\n"},
+    {204, "HTTP/1.1 204 No Content\r\n"},
+    {205, "HTTP/1.1 205 Reset Content\r\n"},
+    {206, "HTTP/1.1 206 Partial Content\r\n"},
+    {300, "HTTP/1.1 300 Multiple Choices\r\n"},
+    {301, "HTTP/1.1 301 Moved Permanently\r\n"},
+    {302, "HTTP/1.1 302 Found\r\n"},
+    {303, "HTTP/1.1 303 See Other\r\n"},
+    {304, "HTTP/1.1 304 Not Modified\r\n"},
+    {305, "HTTP/1.1 305 Use Proxy\r\n"},
+    {307, "HTTP/1.1 307 Temporary Redirect\r\n"},
+    {308, "HTTP/1.1 308 Permanent Redirect\r\n"},
+    {400, "HTTP/1.1 400 Bad Request\r\n"},
+    {401, "HTTP/1.1 401 Unauthorized\r\n"},
+    {402, "HTTP/1.1 402 Payment Required\r\n"},
+    {403, "HTTP/1.1 403 Forbidden\r\n"},
+    {404, "HTTP/1.1 404 Not Found\r\n"},
+    {405, "HTTP/1.1 405 Method Not Allowed\r\n"},
+    {406, "HTTP/1.1 406 Not Acceptable\r\n"},
+    {407, "HTTP/1.1 407 Proxy Authentication Required\r\n"},
+    {408, "HTTP/1.1 408 Request Timeout\r\n"},
+    {409, "HTTP/1.1 409 Conflict\r\n"},
+    {410, "HTTP/1.1 410 Gone\r\n"},
+    {411, "HTTP/1.1 411 Length Required\r\n"},
+    {412, "HTTP/1.1 412 Precondition Failed\r\n"},
+    {413, "HTTP/1.1 413 Payload Too Large\r\n"},
+    {414, "HTTP/1.1 414 URI Too Long\r\n"},
+    {415, "HTTP/1.1 415 Unsupported Media Type\r\n"},
+    {416, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+    {417, "HTTP/1.1 417 Expectation Failed\r\n"},
+    {421, "HTTP/1.1 421 Misdirected Request\r\n"},
+    {422, "HTTP/1.1 422 Unprocessable Entity\r\n"},
+    {426, "HTTP/1.1 426 Upgrade Required\r\n"},
+    {428, "HTTP/1.1 428 Precondition Required\r\n"},
+    {429, "HTTP/1.1 429 Too Many Requests\r\n"},
+    {431, "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+    {451, "HTTP/1.1 451 Unavailable For Legal Reasons\r\n"},
+    {500, "HTTP/1.1 500 Internal Server Error\r\n"},
+    {501, "HTTP/1.1 501 Not Implemented\r\n"},
+    {502, "HTTP/1.1 502 Bad Gateway\r\n"},
+    {503, "HTTP/1.1 503 Service Unavailable\r\n"},
+    {504, "HTTP/1.1 504 Gateway Timeout\r\n"},
+    {505, "HTTP/1.1 505 HTTP Version Not Supported\r\n"},
+};
+inline constexpr std::size_t status_minor_version_offset = 7;
+
+/// Status codes are small integers, so their perfect hash is the code itself: a
+/// table from code - 100 to the index + 1 of its entry in statuses.
+struct status_index {
+    std::uint8_t slots[500];
+
+    constexpr status_index() : slots() {
+        for (std::size_t i = 0; i < sizeof(statuses) / sizeof(statuses[0]); ++i) {
+            slots[statuses[i].code - 100] = static_cast<std::uint8_t>(i + 1);
+        }
+    }
+};
+inline constexpr status_index status_slots;
+
+/// Status line of a code, e.g. "HTTP/1.1 404 Not Found\r\n", or an empty view if unknown.
+inline std::string_view status_line(int code) {
+    if (code < 100 || code >= 600 || status_slots.slots[code - 100] == 0) {
+        return std::string_view();
+    }
+    return statuses[status_slots.slots[code - 100] - 1].line;
+}
+
+/// Status lines for the codes in 100-599 without an entry in statuses, such as an
+/// upstream's 418, with the code and an empty reason phrase: "HTTP/1.1 418 \r\n".
+struct generic_status_lines {
+    static constexpr std::size_t line_size = 15;
+    char lines[500][line_size];
+
+    constexpr generic_status_lines() : lines() {
+        for (int code = 100; code < 600; ++code) {
+            char* line = lines[code - 100];
+            const char prefix[] = "HTTP/1.1 ";
+            for (std::size_t i = 0; i < 9; ++i) {
+                line[i] = prefix[i];
+            }
+            line[9] = static_cast<char>('0' + code / 100);
+            line[10] = static_cast<char>('0' + code / 10 % 10);
+            line[11] = static_cast<char>('0' + code % 10);
+            line[12] = ' ';
+            line[13] = '\r';
+            line[14] = '\n';
+        }
+    }
+};
+inline constexpr generic_status_lines generic_statuses;
+
+/// Status line of any code in 100-599, from statuses if it has a reason phrase there.
+inline std::string_view any_status_line(int code) {
+    std::string_view line = status_line(code);
+    if (line.empty() && code >= 100 && code < 600) {
+        line = std::string_view(generic_statuses.lines[code - 100], generic_status_lines::line_size);
+    }
+    return line;
+}
+
+}  // namespace http_tokens
+
+#endif  // HTTP_TOKENS_HPP
@@ -0,0 +1,59 @@
+/* io_service_pool.h
+Header file for the pool of io_services (and the threads running them) that serve sessions.
+
+Copyright (c) 2003-2017 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+
+Distributed under the Boost Software License, Version 1.0. (See accompanying
+file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+Library Source adapted from https://www.boost.org/doc/libs/1_65_1/doc/html/boost_asio/example/cpp03/http/server2/io_service_pool.hpp
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef IO_SERVICE_POOL_HPP
+#define IO_SERVICE_POOL_HPP
+
+#include <memory>
+#include <vector>
+#include <boost/asio.hpp>
+
+/// A pool of io_service objects, each run by one or more threads.
+///
+/// Sharded mode uses one io_service per thread, so a session only ever runs on the
+/// thread (and, when pinned, the CPU) whose acceptor accepted it. Shared mode uses a
+/// single io_service run by every thread.
+class io_service_pool {
+ public:
+    io_service_pool(std::size_t pool_size, std::size_t threads_per_io_service, bool pin_threads);
+
+    /// Run all io_service objects in the pool, blocking until they have all stopped.
+    void run();
+
+    /// Stop all io_service objects in the pool.
+    void stop();
+
+    std::size_t size() const;
+    boost::asio::io_service& get_io_service(std::size_t index);
+
+    /// Number of CPUs this process may run on, used for "worker_threads auto;".
+    static std::size_t available_cpus();
+
+ private:
+    static void pin_to_cpu(std::size_t thread_index);
+
+    std::vector<std::shared_ptr<boost::asio::io_service> > io_services_;
+    // Keeps each io_service running while it has no pending work.
+    std::vector<std::shared_ptr<boost::asio::io_service::work> > work_;
+    std::size_t threads_per_io_service_;
+    bool pin_threads_;
+};
+
+#endif  // IO_SERVICE_POOL_HPP
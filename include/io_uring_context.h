@@ -0,0 +1,134 @@
+/* io_uring_context.h
+Header file for the optional io_uring transport used by server and session.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef IO_URING_CONTEXT_HPP
+#define IO_URING_CONTEXT_HPP
+
+#include <sys/socket.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+
+/// One io_uring instance per io_service.
+///
+/// Operations are queued as submission entries and submitted together by one
+/// io_uring_enter once the handlers that queued them have run, so a round of
+/// handlers on a thread costs one syscall however many connections it touched.
+/// Completions are signalled through an eventfd that the io_service's reactor
+/// watches, and each one calls the on_complete of the operation it belongs to.
+///
+/// Reads use a ring of provided buffers owned by the context; a completed read
+/// names the buffer it landed in, which must be handed back with
+/// recycle_buffer(). An operation must stay alive and must not be queued again
+/// until its completion has been delivered.
+///
+/// Only built when WEBSERVER_HAS_IO_URING is defined; otherwise supported()
+/// is false and the constructor throws.
+class io_uring_context {
+    public:
+        enum {
+            // Submission queue size. The completion queue is four times larger.
+            queue_entries = 1024,
+            // Provided read buffers, a power of two.
+            buffer_count = 256,
+            buffer_size = 8 * 1024
+        };
+
+        struct operation {
+            /// Called with the operation's result (a negative errno on failure) and
+            /// the completion flags.
+            boost::function<void(int, unsigned)> on_complete;
+        };
+
+        /// True if this build and the running kernel support the features used here.
+        static bool supported();
+        /// True while a multishot operation stays armed after this completion.
+        static bool more_completions(unsigned flags);
+
+        /// post_completions runs each completion as its own handler on the io_service,
+        /// for io_services shared by several threads. Throws boost::system::system_error
+        /// if the ring cannot be set up.
+        io_uring_context(boost::asio::io_service& io_service, bool post_completions);
+        ~io_uring_context();
+        io_uring_context(const io_uring_context&) = delete;
+        io_uring_context& operator=(const io_uring_context&) = delete;
+
+        /// Accept on listen_fd with accept4 flags. A multishot accept completes once per
+        /// connection, with IORING_CQE_F_MORE set while it stays armed.
+        void async_accept(int listen_fd, int flags, bool multishot, operation& op);
+        /// Receive into one of the provided buffers. Fails with -ENOBUFS if none is free.
+        void async_recv(int fd, operation& op);
+        /// Send all of msg. With shutdown_after, a linked shutdown(SHUT_WR) runs once the
+        /// send completes in full, without a completion of its own.
+        void async_sendmsg(int fd, const msghdr* msg, bool shutdown_after, operation& op);
+        /// Cancel op if it is still pending; it then completes with -ECANCELED.
+        void async_cancel(operation& op);
+
+        /// Data of the buffer a read completed into.
+        const char* buffer(unsigned flags) const;
+        /// Give a read's buffer back to the ring, if it used one.
+        void recycle_buffer(unsigned flags);
+
+        /// Submissions made through io_uring_enter, for tests and benchmarks.
+        std::size_t submit_calls() const { return submit_calls_.load(); }
+
+    private:
+        void release_ring();
+        struct io_uring_sqe* get_sqe(unsigned count);
+        void schedule_flush();
+        void flush();
+        void submit_locked();
+        void wait_for_completions();
+        void handle_completions(const boost::system::error_code& error);
+        void reap();
+        static void complete(operation* op, int result, unsigned flags);
+
+        boost::asio::io_service& io_service_;
+        bool post_completions_;
+        int ring_fd_;
+        boost::asio::posix::stream_descriptor event_fd_;
+        std::uint64_t event_count_;
+
+        // Guards the submission queue and the buffer ring.
+        std::mutex mutex_;
+        bool flush_pending_;
+        unsigned to_submit_;
+        std::atomic<std::size_t> submit_calls_;
+
+        void* sq_ring_;
+        std::size_t sq_ring_size_;
+        void* cq_ring_;
+        struct io_uring_sqe* sqes_;
+        std::size_t sqes_size_;
+        unsigned* sq_head_;
+        unsigned* sq_tail_;
+        unsigned sq_mask_;
+        unsigned sq_entries_;
+        unsigned* sq_flags_;
+        unsigned* cq_head_;
+        unsigned* cq_tail_;
+        unsigned cq_mask_;
+        struct io_uring_cqe* cqes_;
+
+        struct io_uring_buf* buffer_ring_;
+        std::size_t buffer_ring_size_;
+        std::vector<char> buffers_;
+        std::uint16_t buffer_tail_;
+};
+
+#endif  // IO_URING_CONTEXT_HPP
@@ -0,0 +1,58 @@
+/* listener_handoff.h
+Header file for passing listening sockets to an upgraded webserver binary.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef LISTENER_HANDOFF_HPP
+#define LISTENER_HANDOFF_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <vector>
+
+/// Hot upgrade without closing the listening port.
+///
+/// The running process execs the new binary with its listening fds left open and
+/// names them in listen_fds_env. The new process builds its acceptors on those fds,
+/// so connections keep queueing on the same sockets throughout, then writes a byte
+/// to the pipe in ready_fd_env. Only then does the old process stop accepting and
+/// drain.
+class listener_handoff {
+    public:
+        /// Comma-separated listening fds, one per server of the old process.
+        static const char* const listen_fds_env;
+        /// Write end of the pipe the new process reports readiness on.
+        static const char* const ready_fd_env;
+
+        /// Takes the fds named in the environment, if any, and clears the variables.
+        listener_handoff();
+        ~listener_handoff();
+
+        /// True when this process was started by a hot upgrade.
+        bool inherited() const;
+        /// Returns inherited fd index if it listens on port, otherwise -1.
+        int take(std::size_t index, int port);
+        /// Closes inherited fds no server took and tells the old process to drain.
+        void notify_ready();
+
+        /// Forks and execs argv with listen_fds inherited. Returns the child pid, or -1,
+        /// and stores the read end of the readiness pipe in ready_fd.
+        static pid_t spawn(char* const argv[], const std::vector<int>& listen_fds, int* ready_fd);
+
+    private:
+        void close_untaken();
+
+        std::vector<int> fds_;
+        int ready_fd_;
+};
+
+#endif  // LISTENER_HANDOFF_HPP
@@ -14,7 +14,9 @@ Date Created:
 #ifndef HTTP_PROXY_REQUEST_HANDLER_HPP
 #define HTTP_PROXY_REQUEST_HANDLER_HPP
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <boost/log/trivial.hpp>
 #include <libxml2/libxml/HTMLparser.h>
@@ -26,13 +28,19 @@ class proxy_request_handler: public request_handler {
  public: // API uses public member functions
     static proxy_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual std::unique_ptr<body_consumer> start_body_stream(const RequestView& head);
  private:
+    class upload_stream;
+
+    std::string upstream_uri(std::string_view request_uri);
     Response proxy_request(const Request& request, std::string uri, std::string url, int port);
+    Response finish_response(Response& response);
     void modify_html_doc(xmlNode *node);
     void handle_property(xmlNode *node, const char *property);
     Response handle_html(Response& response);
     bool read_response(boost::asio::ip::tcp::socket& socket, Response &response);
     std::string build_request_string(const Request& request);
+    std::string build_request_head(const RequestView& head, const std::string& uri);
     std::string decompress_gzip(std::string compressed);
     Response get_error_response();
 
@@ -25,6 +25,7 @@ class redirect_request_handler: public request_handler {
  public: // API uses public member functions
     static redirect_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
  private:
     std::string server_url_;
 };
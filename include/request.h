@@ -15,7 +15,8 @@ Date Created:
 #define HTTP_REQUEST_HPP
 
 #include <string>
-#include <map>
+
+#include "header_map.h"
 
 class Request {
     public:
@@ -38,8 +39,9 @@ class Request {
         // The HTTP version string as given in the request line, e.g. "HTTP/1.1"
         std::string version_;
 
-        // A map of header, for convenient lookup ("Content-Type", "Cookie", etc)
-        std::map<std::string, std::string> headers_;
+        // Headers in the order they were received, duplicates included, looked up by
+        // name in any case ("Content-Type", "cookie", etc) or by header_id
+        header_map headers_;
 
         // The content of the request
         std::string body_;
@@ -21,53 +21,147 @@ Date Created:
 #ifndef HTTP_REQUESTBUILDER_HPP
 #define HTTP_REQUESTBUILDER_HPP
 
+#include <cstddef>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include "header.h"
+#include "http_tokens.h"
 #include "request.h"
+#include "request_view.h"
 
-/// A request received from a client.
+/// One field of a request being parsed. While its bytes sit back to back in the
+/// buffer being parsed it is only a pointer and a length into that buffer; once
+/// they do not (a field cut in two by the end of a read), or once the buffer is
+/// about to go away (detach()), it copies them into a string of its own.
+class request_field {
+    public:
+        void append(const char* data, std::size_t size) {
+            if (!owned_ && (size_ == 0 || data_ + size_ == data)) {
+                if (size_ == 0) {
+                    data_ = data;
+                }
+                size_ += size;
+            } else {
+                detach();
+                copy_.append(data, size);
+            }
+        }
+
+        /// Point at bytes the field does not own, such as part of another field.
+        void refer(std::string_view bytes) {
+            data_ = bytes.data();
+            size_ = bytes.size();
+            owned_ = false;
+            copy_.clear();
+        }
+
+        /// The field's own string, emptied, for a value built rather than received.
+        std::string& own() {
+            owned_ = true;
+            copy_.clear();
+            return copy_;
+        }
+        bool owned() const { return owned_; }
+
+        /// Stop pointing into the parse buffer.
+        void detach() {
+            if (!owned_) {
+                copy_.assign(data_, size_);
+                owned_ = true;
+            }
+        }
+
+        std::string_view view() const {
+            return owned_ ? std::string_view(copy_) : std::string_view(data_, size_);
+        }
+        operator std::string_view() const { return view(); }
+        const char* begin() const { return view().data(); }
+        const char* end() const { return view().data() + view().size(); }
+        std::size_t size() const { return view().size(); }
+        bool empty() const { return size() == 0; }
+
+    private:
+        const char* data_ = nullptr;
+        std::size_t size_ = 0;
+        bool owned_ = false;
+        std::string copy_;
+};
+
+inline bool operator==(const request_field& lhs, std::string_view rhs) {
+    return lhs.view() == rhs;
+}
+
+inline std::ostream& operator<<(std::ostream& out, const request_field& field) {
+    return out << field.view();
+}
+
+struct header_field {
+    request_field name;
+    request_field value;
+};
+
+/// A request received from a client, as request_parser fills it in.
 class request_builder {
     public:
-        std::string method;
-        std::string uri;
+        request_field method;
+        request_field uri;
+        // The URI's path, percent-decoded and without dot segments, and its query
+        // string. Both refer to the bytes of uri unless the path had to be decoded.
+        request_field path;
+        request_field query;
+        // "HTTP/" and the version digits as received
+        request_field version;
         int http_version_major;
         int http_version_minor;
-        std::vector<header> headers;
+        std::vector<header_field> headers;
         int bodysize;
-        std::vector<char> body;
-        std::vector<char> fullmessage;
+        request_field body;
+        // Bytes of the request parsed so far, head and body.
+        std::size_t message_size = 0;
+        // Whether the connection stays open after the response: for HTTP/1.1 unless the
+        // client sent "Connection: close", for HTTP/1.0 only with "Connection: keep-alive".
         bool keep_alive = false;
-        Request build_request() {
-            Request req;
-            if (method == "GET") {
-                req.method_ = Request::MethodEnum::GET;
-            } else if (method == "POST") {
-                req.method_ = Request::MethodEnum::POST;
-            } else if (method == "DELETE") {
-                req.method_ = Request::MethodEnum::DELETE;
-            } else if (method == "HEAD") {
-                req.method_ = Request::MethodEnum::HEAD;
-            } else if (method == "PUT") {
-                req.method_ = Request::MethodEnum::PUT;
-            } else if (method == "CONNECT") {
-                req.method_ = Request::MethodEnum::CONNECT;
-            } else if (method == "OPTIONS") {
-                req.method_ = Request::MethodEnum::OPTIONS;
-            } else if (method == "TRACE") {
-                req.method_ = Request::MethodEnum::TRACE;
+
+        /// Copy every field out of the buffer being parsed, before it is reused.
+        void detach() {
+            method.detach();
+            uri.detach();
+            path.detach();
+            query.detach();
+            version.detach();
+            for (header_field& h : headers) {
+                h.name.detach();
+                h.value.detach();
+            }
+            body.detach();
+        }
+
+        /// View of the request for handlers. Valid while the builder is unchanged and
+        /// the parsed bytes are still alive.
+        RequestView view() const {
+            RequestView req;
+            std::string_view name = method;
+            int known = http_tokens::methods.find(name);
+            if (known >= 0) {
+                req.method_ = static_cast<Request::MethodEnum>(known);
             }
+            req.method_name_ = name;
             req.uri_ = uri;
-            std::string version = "HTTP/" + std::to_string(http_version_major) + "." + std::to_string(http_version_minor);
+            req.path_ = path;
+            req.query_ = query_view(query);
             req.version_ = version;
-            for (int i = 0; i < headers.size(); i++) {
-                header h = headers[i];
-                req.headers_[h.name] = h.value;
+            req.headers_.reserve(headers.size());
+            for (const header_field& h : headers) {
+                req.headers_.push_back(header_view{h.name, h.value});
             }
-            std::string body_string(body.begin(), body.end());
-            req.body_ = body_string;
+            req.body_ = body;
             return req;
         }
+
+        Request build_request() const {
+            return view().to_request();
+        }
 };
 
 #endif // HTTP_REQUESTBUILDER_HPP
@@ -15,6 +15,7 @@ Date Created:
 #define REQUEST_DISPATCHER
 
 #include <string>
+#include <string_view>
 #include "request_handler.h"
 #include "config_parser.h"
 #include "error_404_request_handler.h"
@@ -28,14 +29,15 @@ class request_dispatcher {
     public:
         request_dispatcher(const NginxConfig& config);
         void create_handler_mapping();
-        request_handler* get_handler(std::string uri);
+        request_handler* get_handler(std::string_view path);
+        request_handler* get_location_handler(const std::string& location) const;
         status_request_handler* get_status_handler();
         bool status_handler_enabled = false;
 
     private:
         const NginxConfig& config_;
         std::unordered_map<std::string, request_handler*> dispatcher;  // URI to Handler Mapping
-        std::string longest_prefix_match(std::string uri);
+        request_handler* longest_prefix_match(const std::string& uri) const;
         request_handler* error_handler_ = error_404_request_handler::Init("error_404", config_);
 };
 
@@ -21,12 +21,27 @@ Date Created:
 #ifndef HTTP_REQUEST_HANDLER_HPP
 #define HTTP_REQUEST_HANDLER_HPP
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <sstream>
 
 #include "response.h"
 #include "request.h"
+#include "request_view.h"
+
+// Takes a request body piece by piece as it is read, see
+// request_handler::start_body_stream. A chunked body arrives decoded. Destroyed without on_complete() being called
+// if the connection goes away before the whole body arrived.
+class body_consumer {
+ public:
+    virtual ~body_consumer() {}
+    // The next bytes of the body, only valid during the call.
+    virtual void on_data(const char* data, std::size_t size) = 0;
+    // Called after the last byte of the body to produce the response.
+    virtual Response on_complete() = 0;
+};
 
 // The common handler for all incoming requests.
 class request_handler {
@@ -34,6 +49,21 @@ class request_handler {
     // Handle a request and produce a Response
     // Pure virtual function. We need to derive from and then implement this method
     virtual Response handle_request(const Request& request) = 0;
+    // Handle a request that still points into the connection's read buffer; this is
+    // what the session calls. By default it is copied into a Request for the method
+    // above. Handlers that only read the request override this to skip the copy.
+    virtual Response handle_request(const RequestView& request) {
+        return handle_request(request.to_request());
+    }
+    // Called once the head of a request with a body has been read, before any of the
+    // body. A handler that returns a consumer gets the body through it as it arrives,
+    // and the session reads no more from the socket until on_data returns, so a slow
+    // consumer slows the client down instead of buffering. The default returns null,
+    // which has the whole body buffered and passed to handle_request. The head (whose
+    // body_ is empty) is only valid during the call.
+    virtual std::unique_ptr<body_consumer> start_body_stream(const RequestView& head) {
+        return nullptr;
+    }
     // static RequestHandler* Init(const std::string& location_path, const NginxConfig& config);
 };
 
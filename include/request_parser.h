@@ -21,9 +21,11 @@ Date Created:
 #ifndef HTTP_REQUEST_PARSER_HPP
 #define HTTP_REQUEST_PARSER_HPP
 
+#include <cstddef>
+#include <string_view>
 #include <tuple>
 
-struct request_builder;
+class request_builder;
 
 class request_parser {
 public:
@@ -33,34 +35,89 @@ public:
   /// Reset to initial parser state.
   void reset();
 
-  /// Result of parse.
-  enum result_type { good, bad, indeterminate };
+  /// Result of parse. The last three mean the request went over one of the
+  /// limits (see set_limits) and was refused without reading any further.
+  enum result_type { good, bad, indeterminate, head_complete,
+                     uri_too_long, header_too_large, body_too_large };
+
+  /// Size limits checked as the bytes arrive, 0 meaning no limit. The head is
+  /// everything before the body: request line, headers and the empty line.
+  struct limits {
+    std::size_t max_uri_size = 0;
+    std::size_t max_header_size = 0;
+    std::size_t max_header_count = 0;
+    std::size_t max_body_size = 0;
+  };
+
+  /// Limits for every request from now on.
+  void set_limits(const limits& limits) { limits_ = limits; max_body_size_ = limits.max_body_size; }
+
+  /// Change the body limit of the current request only, e.g. to its location's
+  /// once head_complete says which location that is. Returns false if the
+  /// Content-Length it declared is already over the new limit; a chunked body
+  /// is checked as each chunk size arrives.
+  bool limit_body(std::size_t max_body_size);
 
   /// Parse some data. The enum return value is good when a complete request has
   /// been parsed, bad if the data is invalid, indeterminate when more data is
-  /// required. The InputIterator return value indicates how much of the input
-  /// has been consumed.
-  template <typename InputIterator>
-  std::tuple<result_type, InputIterator> parse(request_builder& req,
-      InputIterator begin, InputIterator end) {
-    while (begin != end)
-    {
-      result_type result = consume(req, *begin++);
-      // TODO(Kubilay Agi): Doesn't handle the case where a client sends multiple consecutive packets
-      if ((result == good && (begin == end)) || result == bad) {
-          return std::make_tuple(result, begin);
-      } else if ((result == good && (begin != end))) {
-        // Request header is good, but unexpected input after request,
-        // then signal bad request
-          return std::make_tuple(bad, begin);
-      }
-    }
-    return std::make_tuple(indeterminate, begin);
-  }
+  /// required (or head_complete, see pause_before_body). The pointer return
+  /// value indicates how much of the input has
+  /// been consumed. Parsing stops right after a complete request, so any input
+  /// left over belongs to the next (pipelined) request.
+  ///
+  /// The fields of req point into the input rather than copying it, so a
+  /// complete request is only valid while its input is. A request that is not
+  /// complete yet is copied out of the input (request_builder::detach()) before
+  /// returning, so the caller may reuse its buffer for the next read.
+  ///
+  /// Runs of method, URI, header name and header value characters (and of chunk
+  /// extensions and trailers) are found with http_scanner and taken in one go,
+  /// and the body is taken in bulk, chunk by chunk for a chunked body. The
+  /// per-byte state machine only handles the delimiters between runs and the
+  /// version, and resumes a request cut off anywhere by the end of a read.
+  std::tuple<result_type, const char*> parse(request_builder& req,
+      const char* begin, const char* end);
+  std::tuple<result_type, char*> parse(request_builder& req, char* begin, char* end);
+
+  /// Have parse return head_complete once the head of a request with a body has
+  /// been read, before taking any of the body. The request is detached as for
+  /// indeterminate. The caller then either calls parse again, which buffers the
+  /// body into req as usual, or takes the body itself through parse_body.
+  void pause_before_body(bool pause) { pause_before_body_ = pause; }
+
+  /// Parse body bytes without appending them to req, for a caller that handles
+  /// the body itself after head_complete. data is set to the body bytes found,
+  /// at most one contiguous run of the input per call (a chunked body is
+  /// decoded, so its framing is never part of data). The result is good once
+  /// the body is complete, bad if its chunked framing is invalid, and
+  /// indeterminate otherwise; the pointer says how far the input was consumed.
+  std::tuple<result_type, const char*> parse_body(request_builder& req,
+      const char* begin, const char* end, std::string_view& data);
+
+  /// True once any byte of the current request has been consumed.
+  bool started() const { return state_ != method_start; }
+
+  /// True once the request head is complete and the parser is reading the body.
+  bool in_body() const { return state_ >= expecting_body; }
 
 private:
   /// Handle the next character of input.
-  result_type consume(request_builder& req, char input);
+  result_type consume(request_builder& req, const char* input);
+
+  /// Append the run of characters the current state accepts, returning where it ends.
+  const char* consume_run(request_builder& req, const char* begin, const char* end);
+
+  /// Split the URI just read into its decoded path and its query; false if the path
+  /// cannot be decoded.
+  bool split_target(request_builder& req);
+
+  /// The over-limit result the request has run into, or indeterminate.
+  result_type check_head_limits(const request_builder& req) const;
+
+  /// True if pending more bytes of body would go over the body limit.
+  bool over_body_limit(std::size_t pending) const {
+    return max_body_size_ != 0 && (pending > max_body_size_ || body_size_ > max_body_size_ - pending);
+  }
 
   /// Check if a byte is an HTTP character.
   static bool is_char(int c);
@@ -74,6 +131,9 @@ private:
   /// Check if a byte is a digit.
   static bool is_digit(int c);
 
+  /// Value of a hex digit, or -1 if the byte is not one.
+  static int hex_value(int c);
+
   /// The current state of the parser.
   enum state {
     method_start,
@@ -96,10 +156,37 @@ private:
     header_value,
     expecting_newline_2,
     expecting_newline_3,
+    // Everything from here on is part of the body.
     expecting_body,
+    chunk_size_start,
+    chunk_size,
+    chunk_extension,
+    chunk_size_newline,
+    chunk_data,
+    chunk_data_cr,
+    chunk_data_newline,
+    trailer_line_start,
+    trailer_line,
+    trailer_newline,
+    final_newline,
   } state_;
 
   int contentsize_;
+
+  /// Set by a Transfer-Encoding: chunked header. The body is then a series of
+  /// chunks, each a hex size line and that many bytes, ended by an empty chunk
+  /// and optional trailer lines. Chunk extensions and trailers are checked and
+  /// dropped.
+  bool chunked_;
+  std::size_t chunk_remaining_;
+
+  bool pause_before_body_;
+
+  limits limits_;
+  /// Body limit of the current request, and the body bytes it has declared so
+  /// far (its Content-Length, or the sizes of the chunks read).
+  std::size_t max_body_size_;
+  std::size_t body_size_;
 };
 
 #endif // HTTP_REQUEST_PARSER_HPP
@@ -0,0 +1,77 @@
+/* request_view.h
+Header file for the non-owning view of a parsed HTTP request.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HTTP_REQUEST_VIEW_HPP
+#define HTTP_REQUEST_VIEW_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "request.h"
+#include "uri_decoder.h"
+
+struct header_view {
+    std::string_view name;
+    std::string_view value;
+};
+
+inline bool operator==(const header_view& lhs, const header_view& rhs) {
+    return lhs.name == rhs.name && lhs.value == rhs.value;
+}
+
+/// A request whose fields point into the bytes it was parsed from, normally the
+/// session's read buffer, so handing it to a handler copies nothing. It is only
+/// valid during handle_request; a handler that keeps any part of it must copy it,
+/// or call to_request() for a Request that owns its data.
+class RequestView {
+    public:
+        RequestView() = default;
+        /// View of a Request, which must outlive the view. Its path is decoded as the
+        /// parser would, or left as received if the parser would reject it.
+        explicit RequestView(const Request& request);
+
+        // The method as parsed, and as text ("GET", or whatever the client sent)
+        Request::MethodEnum method_ = Request::GET;
+        std::string_view method_name_;
+
+        // The URI as received, and its path decoded and normalized (see
+        // uri_decoder::normalize_path) and query parameters. Routing and handlers go
+        // by path_; uri_ is for passing the request on unchanged.
+        std::string_view uri_;
+        std::string_view path_;
+        query_view query_;
+
+        // The HTTP version string as given in the request line, e.g. "HTTP/1.1"
+        std::string_view version_;
+
+        // Headers in the order they were received, duplicates included
+        std::vector<header_view> headers_;
+
+        std::string_view body_;
+
+        /// Value of the first header called name (compared case-insensitively), or an
+        /// empty view if there is none.
+        std::string_view header(std::string_view name) const;
+
+        /// Copy into a Request that owns its data.
+        Request to_request() const;
+
+    private:
+        // Holds path_ when a Request's path had to be decoded; shared so copies of
+        // the view stay valid.
+        std::shared_ptr<const std::string> decoded_path_;
+};
+
+#endif  // HTTP_REQUEST_VIEW_HPP
@@ -22,9 +22,32 @@ Date Created:
 #define HTTP_RESPONSE_HPP
 
 #include <boost/asio.hpp>
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+
+#include "header_map.h"
+
+/// Produces a response body a piece at a time, in place of Response::body_. The
+/// session asks for the next piece only once the one before it has been written to
+/// the socket, so a large body is never held whole and a slow client slows the
+/// producer down instead of piling up buffers. Destroyed once the body is written or
+/// the connection goes away, whichever is first.
+class body_producer {
+  public:
+    virtual ~body_producer() {}
+    /// Length of the whole body, sent as Content-Length. -1 if it is not known up
+    /// front: the body then goes chunked to an HTTP/1.1 client, and to an HTTP/1.0
+    /// client with the connection closing after it.
+    virtual long long size() const { return -1; }
+    /// Copy the next bytes of the body into buffer, at most capacity of them, and set
+    /// size to how many; 0 means the body is done. False if the body cannot be
+    /// finished, in which case the connection is closed without ending it, so the
+    /// client can tell it was cut short.
+    virtual bool read(char* buffer, std::size_t capacity, std::size_t& size) = 0;
+};
 
 /// A Response to be sent to a client.
 class Response {
@@ -44,17 +67,44 @@ class Response {
       unauthorized = 401,
       forbidden = 403,
       not_found = 404,
+      payload_too_large = 413,
+      uri_too_long = 414,
+      request_header_fields_too_large = 431,
       internal_server_error = 500,
       not_implemented = 501,
       bad_gateway = 502,
       service_unavailable = 503
     } code_;
 
-    // A map of headers, for convenient lookup ("Content-Type", "Cookie", etc)
-    std::map<std::string, std::string> headers_;
+    // Headers in the order they are sent, looked up by name in any case ("Content-Type",
+    // "cookie", etc) or by header_id for the common ones
+    header_map headers_;
 
     // The content of the response
     std::string body_;
+
+    // Set instead of body_ for a body that is never changed once made, such as a stock
+    // page or a page a handler builds at startup. Responses on any thread share it and
+    // are written straight from it, so copying the Response does not copy the body.
+    std::shared_ptr<const std::string> shared_body_;
+
+    // Set instead of body_ for a body written as it is produced, see body_producer.
+    // The session adds the Content-Length or Transfer-Encoding header.
+    std::shared_ptr<body_producer> body_producer_;
+
+    // Minor version of the status line, "HTTP/1.<minor>". The session sets the one
+    // of the request being answered, so an HTTP/1.0 client gets an HTTP/1.0 reply.
+    int http_version_minor_ = 1;
+
+    // Set by the session on the last response before it closes the connection, so the
+    // head says "Connection: close"
+    bool close_connection_ = false;
+
+    /// The body to send when there is no body_producer_: shared_body_ if it is set,
+    /// otherwise body_.
+    std::string_view body() const {
+      return shared_body_ ? std::string_view(*shared_body_) : std::string_view(body_);
+    }
 };
 
 #endif // HTTP_RESPONSE_HPP
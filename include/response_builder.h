@@ -42,7 +42,7 @@ class response_builder {
             res.code_ = static_cast<Response::StatusCode>(code);
             for (int i = 0; i < headers.size(); i++) {
                 header h = headers[i];
-                res.headers_[h.name] = h.value;
+                res.headers_.add(h.name, h.value);
             }
             std::string body_string(body.begin(), body.end());
             res.body_ = body_string;
@@ -0,0 +1,95 @@
+/* response_compressor.h
+Header file for the gzip and deflate compression of response bodies.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef RESPONSE_COMPRESSOR_HPP
+#define RESPONSE_COMPRESSOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "config_parser.h"
+#include "request_dispatcher.h"
+#include "request_handler.h"
+#include "request_view.h"
+#include "response.h"
+
+/// Compresses response bodies for the clients that accept it, between the handler
+/// and the response serializer.
+///
+/// Settings come from the gzip directives, and each location may set its own (see
+/// NginxConfig::Compression). A response is compressed when its location has gzip
+/// on, its Content-Type is on the location's list, its body is at least the minimum
+/// length (or of unknown length), it has no Content-Encoding yet, and the request's
+/// Accept-Encoding allows gzip or deflate. Every response that would be compressed
+/// gets "Vary: Accept-Encoding", whichever encoding the client gets.
+///
+/// A small body is compressed whole when the response is queued. A larger one, or a
+/// body_producer_, is compressed a piece at a time as it is written and goes out
+/// chunked. zlib streams are kept in per-thread pools and reset between responses,
+/// so a response does not pay for setting one up.
+///
+/// Compression costs CPU on the io thread that writes the response. When that thread
+/// has been busy most of the last sample period, the level drops to the fastest, and
+/// when it has been busy nearly all of it, responses go out uncompressed until it
+/// calms down.
+class response_compressor {
+ public:
+    enum encoding { identity, gzip, deflate };
+
+    enum {
+        // Bodies up to this size are compressed whole when the response is queued.
+        buffered_limit = 64 * 1024,
+        // How often each io thread measures how busy it is.
+        sample_ms = 100,
+        // Busy percentages of an io thread at which compression drops to level 1 and
+        // stops.
+        backoff_busy_percent = 75,
+        off_busy_percent = 95
+    };
+
+    response_compressor(const NginxConfig& config, request_dispatcher& dispatcher);
+
+    response_compressor(const response_compressor&) = delete;
+    response_compressor& operator=(const response_compressor&) = delete;
+
+    /// Compress the body of a response from handler to request, if it should be.
+    void compress(const RequestView& request, const request_handler* handler, Response& response) const;
+
+    /// The encoding to use for an Accept-Encoding value: whichever of gzip and deflate
+    /// has the higher qvalue, gzip on a tie, or identity if neither is acceptable.
+    /// Codings with q=0 are refused, and "*" stands for the codings not named.
+    static encoding negotiate(std::string_view accept_encoding);
+    /// Level to compress at when the io thread is busy_percent busy, 0 for not at all.
+    static int level_for_load(int configured_level, int busy_percent);
+    /// Compress data whole into compressed. False if zlib fails.
+    static bool compress_whole(encoding coding, int level, std::string_view data, std::string& compressed);
+    /// A producer of source's body compressed as it is read, or null if zlib could
+    /// not set up a stream.
+    static std::shared_ptr<body_producer> compressing_producer(encoding coding, int level,
+                                                               std::shared_ptr<body_producer> source);
+    /// Whether a Content-Type value names one of types, ignoring its parameters.
+    static bool compressible_type(const std::vector<std::string>& types, std::string_view content_type);
+
+ private:
+    const NginxConfig::Compression& settings(const request_handler* handler) const;
+    static int busy_percent();
+
+    NginxConfig::Compression compression_;
+    std::unordered_map<const request_handler*, NginxConfig::Compression> location_compression_;
+};
+
+#endif  // RESPONSE_COMPRESSOR_HPP
@@ -19,53 +19,42 @@ Date Created:
 #include <vector>
 #include <map>
 
+#include "buffer_pool.h"
 #include "response.h"
 
 class ResponseHelperLibrary {
   public:
     static boost::asio::const_buffer to_buffer(Response::StatusCode status);
-    static std::vector<boost::asio::const_buffer> to_buffers(Response& response);
+    /// Bytes in the status line and headers of a response, blank line included.
+    static std::size_t head_size(const Response& response);
+    /// Write the status line and headers of a response to out, which has room for
+    /// head_size(response) bytes, returning the end of what was written.
+    static char* write_head(const Response& response, char* out);
+    /// Append to buffers every response in order: its head serialized into heads, one
+    /// block for all of them, and its body as a buffer of its own. heads is emptied
+    /// first and must stay unchanged until the buffers are written. A response with a
+    /// body_producer_ only gets its head; the session writes the body.
+    static void to_buffers(const std::vector<Response>& responses, pooled_buffer& heads,
+                           std::vector<boost::asio::const_buffer>& buffers);
+    /// The same for the first count responses.
+    static void to_buffers(const Response* responses, std::size_t count, pooled_buffer& heads,
+                           std::vector<boost::asio::const_buffer>& buffers);
+
+    /// Room frame_chunk needs before and after the data of a chunk.
+    enum { chunk_head_room = 2 * sizeof(std::size_t) + 2, chunk_tail_room = 2 };
+    /// Frame size bytes at data as one chunk of a chunked body, writing the chunk
+    /// size line into the chunk_head_room bytes before data and CRLF after it.
+    static boost::asio::const_buffer frame_chunk(char* data, std::size_t size);
+    /// The empty chunk and blank line that end a chunked body.
+    static boost::asio::const_buffer last_chunk();
+    /// A response with the stock page for status as its body, shared with every other
+    /// stock response of that status.
     static Response stock_response(Response::StatusCode status);
     static std::string to_string(Response::StatusCode status);
+    /// The stock page for status, made once and shared from then on.
+    static std::shared_ptr<const std::string> stock_body(Response::StatusCode status);
 };
 
-namespace status_strings {
-
-const std::string ok =
-  "HTTP/1.0 200 OK\r\n";
-const std::string created =
-  "HTTP/1.0 201 Created\r\n";
-const std::string accepted =
-  "HTTP/1.0 202 Accepted\r\n";
-const std::string no_content =
-  "HTTP/1.0 204 No Content\r\n";
-const std::string multiple_choices =
-  "HTTP/1.0 300 Multiple Choices\r\n";
-const std::string moved_permanently =
-  "HTTP/1.0 301 Moved Permanently\r\n";
-const std::string moved_temporarily =
-  "HTTP/1.0 302 Moved Temporarily\r\n";
-const std::string not_modified =
-  "HTTP/1.0 304 Not Modified\r\n";
-const std::string bad_request =
-  "HTTP/1.0 400 Bad Request\r\n";
-const std::string unauthorized =
-  "HTTP/1.0 401 Unauthorized\r\n";
-const std::string forbidden =
-  "HTTP/1.0 403 Forbidden\r\n";
-const std::string not_found =
-  "HTTP/1.0 404 Not Found\r\n";
-const std::string internal_server_error =
-  "HTTP/1.0 500 Internal Server Error\r\n";
-const std::string not_implemented =
-  "HTTP/1.0 501 Not Implemented\r\n";
-const std::string bad_gateway =
-  "HTTP/1.0 502 Bad Gateway\r\n";
-const std::string service_unavailable =
-  "HTTP/1.0 503 Service Unavailable\r\n";
-
-}  // namespace status_strings
-
 namespace stock_responses {
 
 const char ok[] = "";
@@ -96,8 +85,8 @@ const char moved_permanently[] =
   "</html>";
 const char moved_temporarily[] =
   "<html>"
-  "<head><title>Moved Temporarily</title></head>"
-  "<body><h1>302 Moved Temporarily</h1></body>"
+  "<head><title>Found</title></head>"
+  "<body><h1>302 Found</h1></body>"
   "</html>";
 const char not_modified[] =
   "<html>"
@@ -124,6 +113,21 @@ const char not_found[] =
   "<head><title>Not Found</title></head>"
   "<body><h1>404 Not Found</h1></body>"
   "</html>";
+const char payload_too_large[] =
+  "<html>"
+  "<head><title>Payload Too Large</title></head>"
+  "<body><h1>413 Payload Too Large</h1></body>"
+  "</html>";
+const char uri_too_long[] =
+  "<html>"
+  "<head><title>URI Too Long</title></head>"
+  "<body><h1>414 URI Too Long</h1></body>"
+  "</html>";
+const char request_header_fields_too_large[] =
+  "<html>"
+  "<head><title>Request Header Fields Too Large</title></head>"
+  "<body><h1>431 Request Header Fields Too Large</h1></body>"
+  "</html>";
 const char internal_server_error[] =
   "<html>"
   "<head><title>Internal Server Error</title></head>"
@@ -11,10 +11,22 @@ Date Created:
     April 8th, 2020
 */
 
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include "admission_control.h"
 #include "config_parser.h"
+#include "io_uring_context.h"
 #include "request_dispatcher.h"
+#include "response_compressor.h"
+#include "session_pool.h"
+#include "timing_wheel.h"
 
 class session;
 
@@ -22,12 +34,47 @@ using boost::asio::ip::tcp;
 
 class server {
     public:
-        server(boost::asio::io_service& io_service, int port_number, request_dispatcher* request_dispatcher);
+        enum {
+            // Connections taken per wake-up before yielding to other handlers.
+            accept_batch_limit = 64,
+            // Pause after accept4 fails for lack of descriptors or memory.
+            accept_backoff_ms = 100,
+            // Pause while max_connections are open.
+            accept_pause_ms = 10
+        };
+
+        server(boost::asio::io_service& io_service, const NginxConfig& config,
+            request_dispatcher* request_dispatcher, admission_control* admission_control,
+            const response_compressor* response_compressor, int listen_fd = -1);
+        int native_listen_handle();
+        void drain();
 
     private:
-        void start_accept();
-        void handle_accept(session* new_session, const boost::system::error_code& error);
+        void start_accept(std::size_t slot);
+        void handle_accept(std::size_t slot, const boost::system::error_code& error);
+        void pause_accept(std::size_t slot, int pause_ms);
+        void handle_accept_backoff(std::size_t slot, const boost::system::error_code& error);
+        void stop_accept_slot();
+        void handle_drain();
+        void handle_uring_accept(int result, unsigned flags);
+        void start_session(int socket_fd, const tcp::endpoint& remote_endpoint);
+        static io_uring_context* create_uring(boost::asio::io_service& io_service,
+                                              const NginxConfig& config);
         boost::asio::io_service& io_service_;
         tcp::acceptor acceptor_;
+        const NginxConfig& config_;
         request_dispatcher* request_dispatcher_;
+        admission_control* admission_control_;
+        // Timeouts of every session accepted here, ticked on io_service_.
+        timing_wheel timing_wheel_;
+        // Set when the io_uring backend is in use; sessions borrow it, so it outlives them.
+        std::unique_ptr<io_uring_context> uring_;
+        io_uring_context::operation accept_op_;
+        session_pool session_pool_;
+        // One per outstanding accept, only touched by that accept's handlers.
+        std::vector<std::unique_ptr<boost::asio::steady_timer> > accept_backoff_timers_;
+        // Outstanding accepts, plus the pending drain, that have not retired yet.
+        std::atomic<std::size_t> accept_slots_;
 };
+
+#endif  // SERVER_HPP
@@ -0,0 +1,69 @@
+/* server_metrics.h
+Header file for the process wide counters reported by the status handler.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef SERVER_METRICS_HPP
+#define SERVER_METRICS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// Counters shared by every server and session in the process.
+///
+/// Updated from the io threads with relaxed atomics and only read by the status
+/// handler, so keeping them costs no locking on the hot paths.
+class server_metrics {
+ public:
+    static server_metrics& get();
+
+    /// Record one wake-up of an accept loop that took batch_size connections.
+    void record_accept_batch(std::uint64_t batch_size, bool hit_limit);
+
+    /// Human readable report, one "name: value" per line, for the status handler.
+    std::string report() const;
+
+    std::atomic<std::uint64_t> connections_accepted{0};
+    // Wake-ups of the accept loops, and how many of them stopped at the batch limit
+    // with connections still queued. Many accepts per wake-up or frequent limit hits
+    // mean the accept queue is backing up.
+    std::atomic<std::uint64_t> accept_wakeups{0};
+    std::atomic<std::uint64_t> accept_batch_limit_hits{0};
+    std::atomic<std::uint64_t> largest_accept_batch{0};
+    // accept4 failures other than an empty queue, e.g. running out of descriptors.
+    std::atomic<std::uint64_t> accept_errors{0};
+
+    // Gauges kept by admission_control, which also enforces the limits on them.
+    std::atomic<int> active_connections{0};
+    std::atomic<int> requests_in_flight{0};
+    // Requests answered with 503 instead of running their handler, and times a
+    // server stopped accepting because max_connections was reached.
+    std::atomic<std::uint64_t> requests_shed{0};
+    std::atomic<std::uint64_t> accept_pauses{0};
+
+    // Requests refused for going over a size limit, by the limit they broke: the URI
+    // (414), the head's size or header count (431), and the body (413).
+    std::atomic<std::uint64_t> uri_too_long{0};
+    std::atomic<std::uint64_t> header_too_large{0};
+    std::atomic<std::uint64_t> body_too_large{0};
+
+    // Responses sent compressed, and compressible ones sent at a lower level or not
+    // compressed at all because their io thread was busy (see response_compressor).
+    std::atomic<std::uint64_t> responses_compressed{0};
+    std::atomic<std::uint64_t> compression_backoffs{0};
+    std::atomic<std::uint64_t> compression_skipped_busy{0};
+
+ private:
+    server_metrics() {}
+};
+
+#endif  // SERVER_METRICS_HPP
@@ -11,36 +11,139 @@ Date Created:
     April 8th, 2020
 */
 
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <sys/uio.h>
+
 #include <boost/asio.hpp>
+#include <chrono>
+#include <memory>
 #include <string>
+#include "admission_control.h"
+#include "buffer_pool.h"
 #include "request_builder.h"
 #include "request.h"
 #include "request_parser.h"
 #include "response.h"
 #include "config_parser.h"
+#include "io_uring_context.h"
 #include "request_dispatcher.h"
+#include "response_compressor.h"
 #include "response_helper_library.h"
+#include "timing_wheel.h"
+
+class session_pool;
 
 class session {
  public:
-    session(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher_);
+    enum {
+        // How long a closing connection waits for the client to close its side.
+        lingering_timeout_ms = 5000,
+        // Reads a wakeup may follow with another read straight away, before the session
+        // goes back to the reactor and lets the other connections on its thread run.
+        max_direct_reads = 4
+    };
+
+    session(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher_,
+        admission_control* admission_control, const response_compressor* response_compressor,
+        timing_wheel* timing_wheel, const NginxConfig* config, io_uring_context* uring,
+        session_pool* session_pool);
+    ~session();
     boost::asio::ip::tcp::socket& socket();
     void start();
 
  private:
+    void do_read(bool wait_readable = false);
+    void handle_readable(const boost::system::error_code& error);
     void handle_read(const boost::system::error_code& error, size_t bytes_transferred);
+    void handle_uring_read(int result, unsigned flags);
+    void parse_requests(const char* begin, const char* end);
+    void start_body_stream();
+    bool expects_continue(const RequestView& head) const;
+    const char* stream_body(const char* begin, const char* end);
+    void end_body_stream();
+    Response dispatch_request();
+    void record_request(const RequestView& req, const Response& response);
+    void push_response(Response response);
+    void queue_response(Response response);
+    void queue_bad_request();
+    void queue_rejection(request_parser::result_type result);
+    void frame_body(Response& response);
+    void write_responses();
+    void next_body_piece();
+    void start_write();
+    void start_uring_write();
+    void handle_uring_write(int result, unsigned flags);
     void handle_write(const boost::system::error_code& error);
     void shutdown(const boost::system::error_code& error);
+    void linger();
+    void handle_linger(const boost::system::error_code& error);
+    void close();
+    void reset();
+    void arm_read_timer();
+    void handle_timeout();
     Request build_request();
     std::string get_entire_request();
     boost::asio::ip::tcp::socket socket_;
-    enum { max_length = 1024 };
-    char data_[max_length+1];
+    // Borrowed from the thread's buffer_pool only while bytes are being read and parsed.
+    pooled_buffer read_buffer_;
+    // Bytes to ask for on the next read. Grows while reads keep filling the buffer.
+    std::size_t read_size_;
+    // Reads made straight after a full one in the current wakeup, see handle_read.
+    int direct_reads_;
 
     request_builder request_builder_;
     request_parser request_parser_;
-    Response response_;
+    // Responses to pipelined requests, written together in request order.
+    std::vector<Response> responses_;
+    std::vector<boost::asio::const_buffer> write_buffers_;
+    // Status lines and headers of the responses being written, borrowed from the
+    // thread's buffer_pool only until the write completes.
+    pooled_buffer write_heads_;
+    // Responses at the front of responses_ whose heads are in the write going out.
+    std::size_t written_responses_;
+    // The last of them has a body_producer_ whose body is still being written, one
+    // piece per write from body_buffer_. It ends after body_left_ more bytes, or with
+    // an empty piece when its length is unknown (-1).
+    bool streaming_;
+    bool chunked_;
+    long long body_left_;
+    pooled_buffer body_buffer_;
+    bool close_after_write_;
+    // The write going out is the last on the connection and is followed by a shutdown.
+    bool final_write_;
+    // The current request's head asked for 100 Continue, and it goes out behind the
+    // responses queued so far unless the request completes first.
+    bool send_continue_;
 
-    NginxConfig* config_;
+    // Set while the body of the current request goes to its handler as it is read
+    // instead of into request_builder_, see request_handler::start_body_stream.
+    std::unique_ptr<body_consumer> body_consumer_;
+    request_handler* body_handler_;
+
+    // Null when the session does its I/O through the asio reactor. Otherwise reads land
+    // in the ring's provided buffers and writes go out as one sendmsg of write_iov_.
+    io_uring_context* uring_;
+    io_uring_context::operation read_op_;
+    io_uring_context::operation write_op_;
+    std::vector<iovec> write_iov_;
+    msghdr write_msg_;
+
+    // Armed only while an async wait or write is outstanding; every completion handler
+    // cancels it first thing.
+    timing_wheel* timing_wheel_;
+    timing_wheel::timer timer_;
+    // When the head of the current request must be complete, unset between requests.
+    std::chrono::steady_clock::time_point header_deadline_;
+    bool served_request_;
+
+    const NginxConfig* config_;
     request_dispatcher* request_dispatcher_;
+    admission_control* admission_control_;
+    const response_compressor* response_compressor_;
+    // Takes the session back once it is closed.
+    session_pool* session_pool_;
 };
+
+#endif  // SESSION_HPP
@@ -0,0 +1,81 @@
+/* session_pool.h
+Header file for the free list that recycles session objects.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef SESSION_POOL_HPP
+#define SESSION_POOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include <boost/asio.hpp>
+
+#include "admission_control.h"
+#include "config_parser.h"
+#include "io_uring_context.h"
+#include "request_dispatcher.h"
+#include "response_compressor.h"
+#include "timing_wheel.h"
+
+class session;
+
+/// Owns every session of one io_service.
+///
+/// A closed session is reset and put on the free list instead of being deleted,
+/// so accepting a connection normally reuses a session (socket, parser state and
+/// vector capacity included) rather than allocating one. Sessions are bound to
+/// the io_service they were created on, which is why there is one pool per
+/// io_service: in sharded mode that makes the free list per thread.
+class session_pool {
+ public:
+    enum {
+        // Free sessions kept for reuse, the rest are deleted.
+        default_max_free = 1024
+    };
+
+    session_pool(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher,
+                 admission_control* admission_control, const response_compressor* response_compressor,
+                 timing_wheel* timing_wheel, const NginxConfig* config,
+                 io_uring_context* uring, std::size_t max_free = default_max_free);
+    /// Deletes the free sessions. Sessions still in use must be gone by then.
+    ~session_pool();
+
+    session_pool(const session_pool&) = delete;
+    session_pool& operator=(const session_pool&) = delete;
+
+    /// A reset session ready to accept on, reused if one is free.
+    session* acquire();
+    /// Take back a session that has been reset. It must not be touched afterwards.
+    void release(session* s);
+
+    /// Sessions handed out by acquire() and not yet released.
+    std::size_t live_count() const;
+    std::size_t free_count() const;
+
+ private:
+    boost::asio::io_service& io_service_;
+    request_dispatcher* request_dispatcher_;
+    admission_control* admission_control_;
+    const response_compressor* response_compressor_;
+    timing_wheel* timing_wheel_;
+    const NginxConfig* config_;
+    // Null when sessions use the asio reactor.
+    io_uring_context* uring_;
+    std::size_t max_free_;
+
+    std::vector<session*> free_;
+    std::size_t live_;
+    // Only contended when several threads share one io_service.
+    mutable std::mutex mutex_;
+};
+
+#endif  // SESSION_POOL_HPP
@@ -14,6 +14,8 @@ Date Created:
 #ifndef HTTP_STATIC_REQUEST_HANDLER_HPP
 #define HTTP_STATIC_REQUEST_HANDLER_HPP
 
+#include <sys/stat.h>
+
 #include <string>
 #include <unordered_map>
 
@@ -22,14 +24,21 @@ Date Created:
 
 class static_request_handler: public request_handler {
     public: // API uses public member functions
+        // Largest file gzip_static makes a variant of; larger ones are left to the
+        // compressor rather than keep the variant builder busy for long.
+        enum { max_variant_size = 32 * 1024 * 1024 };
         static static_request_handler* Init(const std::string& location_path, const NginxConfig& config);
         virtual Response handle_request(const Request& request);
+        virtual Response handle_request(const RequestView& request);
 
     private:
         void default_bad_request(Response& response);
         std::string get_mime_type(std::string file_name);
+        int open_gzip_variant(const std::string& file_name, const struct stat& source, struct stat& variant_stat);
         std::string client_location_path_;
         std::string server_root_path_;
+        // The location's compression settings, for gzip_static.
+        NginxConfig::Compression compression_;
 };
 
 #endif  // INCLUDE_STATIC_REQUEST_HANDLER_H_
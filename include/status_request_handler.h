@@ -24,6 +24,7 @@ class status_request_handler: public request_handler {
     static status_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     void record_received_request(std::string request_uri, Response::StatusCode response_status);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
  private:
     std::string status_path_;
     std::string handler_list;
@@ -0,0 +1,93 @@
+/* timing_wheel.h
+Header file for the hashed timing wheel that enforces connection timeouts.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/function.hpp>
+
+/// A hashed timing wheel driven by one steady_timer per io_service.
+///
+/// Arming and cancelling a timer only links or unlinks it from a slot's list, so
+/// both are O(1) and a connection needs no steady_timer of its own. Each tick
+/// visits one slot and fires the timers in it whose deadline has passed; timers
+/// further than one revolution away stay in the slot until their turn comes.
+class timing_wheel {
+ public:
+    /// A timer embedded in its owner. Must be cancelled before the owner goes away.
+    class timer {
+     public:
+        timer() : idle(false), prev_(nullptr), next_(nullptr), expiry_tick_(0) {}
+        timer(const timer&) = delete;
+        timer& operator=(const timer&) = delete;
+
+        bool armed() const { return prev_ != nullptr; }
+
+        /// Called on the wheel's io_service, with the wheel locked, when the deadline passes.
+        boost::function<void()> on_expire;
+
+        /// Set by the owner while it is only waiting for new work, see expire_idle().
+        /// Only written while the timer is not armed.
+        bool idle;
+
+     private:
+        friend class timing_wheel;
+        timer* prev_;
+        timer* next_;
+        std::uint64_t expiry_tick_;
+    };
+
+    timing_wheel(boost::asio::io_service& io_service,
+                 std::chrono::milliseconds tick = std::chrono::milliseconds(250),
+                 std::size_t num_slots = 1024);
+    ~timing_wheel();
+
+    /// Start ticking. Until then armed timers never fire.
+    void start();
+    void stop();
+
+    /// Arm t to fire after timeout, replacing any deadline it already had.
+    /// A timeout of zero just cancels t.
+    void schedule(timer& t, std::chrono::milliseconds timeout);
+    void cancel(timer& t);
+
+    /// Fire every armed idle timer now, as if its deadline had passed. Returns how many
+    /// fired. Walks the whole wheel, so it is meant for rare events such as shutdown.
+    std::size_t expire_idle();
+
+    std::chrono::milliseconds tick() const { return tick_; }
+    std::size_t size() const;
+
+ private:
+    void link(timer& t, std::size_t slot);
+    void unlink(timer& t);
+    void handle_tick(const boost::system::error_code& error);
+
+    boost::asio::steady_timer tick_timer_;
+    std::chrono::milliseconds tick_;
+    // Each slot is a circular list whose head is a sentinel timer.
+    std::vector<timer> slots_;
+    std::uint64_t current_tick_;
+    std::size_t size_;
+    bool running_;
+    // Only contended when several threads share one io_service.
+    mutable std::mutex mutex_;
+};
+
+#endif  // TIMING_WHEEL_HPP
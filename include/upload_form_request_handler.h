@@ -14,6 +14,7 @@ Date Created:
 #ifndef HTTP_UPLOAD_FORM_REQUEST_HANDLER_HPP
 #define HTTP_UPLOAD_FORM_REQUEST_HANDLER_HPP
 
+#include <memory>
 #include <string>
 #include "request_handler.h"
 #include "config_parser.h"
@@ -22,9 +23,11 @@ class upload_form_request_handler: public request_handler {
  public:
     static upload_form_request_handler* Init(const std::string& location_path, const NginxConfig& config);
     virtual Response handle_request(const Request& request);
+    virtual Response handle_request(const RequestView& request);
 
  private:
-    std::string form_html_;
+    // Made once in Init and shared by every response.
+    std::shared_ptr<const std::string> form_html_;
 };
 
 #endif  // HTTP_UPLOAD_FORM_REQUEST_HANDLER_HPP
@@ -0,0 +1,104 @@
+/* uri_decoder.h
+Header file for splitting, decoding and normalizing request targets, and for the
+query-parameter view over the query string.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#ifndef HTTP_URI_DECODER_HPP
+#define HTTP_URI_DECODER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace uri_decoder {
+
+/// Split a request target at the first '?' into its path and its query (without
+/// the '?'). A target with no '?' has an empty query.
+void split(std::string_view target, std::string_view& path, std::string_view& query);
+
+/// Whether a path has to go through normalize_path: it has a percent escape, or a
+/// "." or ".." segment. Most paths have neither and are used as received.
+bool needs_normalizing(std::string_view path);
+
+/// Decode the percent escapes in path and then remove its "." and ".." segments
+/// (RFC 3986 5.2.4), so "/a/./b/../c%20d" becomes "/a/c d". A ".." at the root
+/// stays at the root. False if an escape is not two hex digits or decodes to NUL.
+bool normalize_path(std::string_view path, std::string& normalized);
+
+/// Decode the percent escapes in text into decoded, and '+' to a space if
+/// plus_is_space (as in query strings). False if an escape is not two hex digits.
+bool percent_decode(std::string_view text, bool plus_is_space, std::string& decoded);
+
+/// Remove the "." and ".." segments of a path that starts with '/', in place.
+/// Other paths (e.g. the absolute form "http://host/...") are left alone.
+void remove_dot_segments(std::string& path);
+
+}  // namespace uri_decoder
+
+/// The parameters of a query string, "a=1&b=two+words", read straight from the
+/// request's bytes. Nothing is parsed until the parameters are iterated or looked
+/// up, and names and values are only decoded when get() is asked for one, so a
+/// handler that never looks at the query pays nothing for it.
+class query_view {
+    public:
+        /// A parameter as received, still encoded. A parameter without '=' has an
+        /// empty value.
+        struct param {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        class iterator {
+            public:
+                iterator() = default;
+                explicit iterator(std::string_view rest) : rest_(rest), done_(false) { next(); }
+
+                const param& operator*() const { return current_; }
+                const param* operator->() const { return &current_; }
+                iterator& operator++() {
+                    next();
+                    return *this;
+                }
+                bool operator==(const iterator& other) const {
+                    return done_ == other.done_ && (done_ || current_.name.data() == other.current_.name.data());
+                }
+                bool operator!=(const iterator& other) const { return !(*this == other); }
+
+            private:
+                void next();
+
+                std::string_view rest_;
+                param current_;
+                bool done_ = true;
+        };
+
+        query_view() = default;
+        explicit query_view(std::string_view query) : query_(query) {}
+
+        iterator begin() const { return iterator(query_); }
+        iterator end() const { return iterator(); }
+        bool empty() const { return query_.empty(); }
+        /// The query string as received, without the '?'.
+        std::string_view raw() const { return query_; }
+
+        /// Decoded value of the first parameter whose decoded name is name. False if
+        /// there is none, or its value has a bad escape.
+        bool get(std::string_view name, std::string& value) const;
+        bool has(std::string_view name) const;
+
+    private:
+        bool find(std::string_view name, param& found) const;
+
+        std::string_view query_;
+};
+
+#endif  // HTTP_URI_DECODER_HPP
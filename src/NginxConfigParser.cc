@@ -19,10 +19,13 @@ Date Created:
     April 9th, 2020
 */
 
+#include <cctype>
+#include <climits>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <stack>
 #include <string>
 #include <vector>
@@ -463,6 +466,7 @@ bool NginxConfigParser::Parse(std::istream* config_file, NginxConfig* config) {
         // Error.
         break;
       }
+      ParseServerDirectives(config);
       BOOST_LOG_TRIVIAL(info) << "Parsed configuration file successfully.";
       return bracket_stack.empty();
     } else {
@@ -533,3 +537,349 @@ void NginxConfigParser::SetConfigPortNumberFromToken(std::string port_token, Ngi
     BOOST_LOG_TRIVIAL(error) << "Exception: " << e.what();
   }
 }
+
+/* void NginxConfigParser::ParseServerDirectives(NginxConfig* config)
+  Parameter(s):
+    - config: Parsed representation of configuration file (see config_parser.h). Its top level
+    statements are read, and the resulting server settings are stored back into it.
+  Returns:
+    - N/A
+  Description:
+    - Reads the top level "directive value;" statements that tune the server itself rather than
+    a location (worker_threads, worker_cpu_affinity, reuseport, io_backend, the timeouts, the accept
+    settings, the admission limits, the request size limits and compression), plus the generic
+    directives inside location blocks (see ParseLocationDirectives). Unknown or invalid values are
+    logged and the defaults are kept.
+    - Location blocks are read last, so that they start from the server's compression settings
+    even when those come after them in the file.  */
+void NginxConfigParser::ParseServerDirectives(NginxConfig* config) {
+  for (const auto& statement : config->statements_) {
+    const std::vector<std::string>& tokens = statement->tokens_;
+    if (statement->child_block_ == nullptr && ParseCompressionDirective(tokens, &config->compression)) {
+      continue;
+    }
+    if (tokens.size() != 2 || statement->child_block_ != nullptr) {
+      continue;
+    }
+    const std::string& directive = tokens[0];
+    const std::string& value = tokens[1];
+
+    if (directive == "worker_threads") {
+      if (value == "auto") {
+        config->worker_threads = 0;
+      } else {
+        try {
+          int worker_threads = std::stoi(value);
+          if (worker_threads > 0) {
+            config->worker_threads = worker_threads;
+          } else {
+            BOOST_LOG_TRIVIAL(error) << "worker_threads must be positive, got " << value;
+          }
+        } catch (std::exception& e) {
+          BOOST_LOG_TRIVIAL(error) << "Invalid worker_threads value: " << value;
+        }
+      }
+      BOOST_LOG_TRIVIAL(info) << "Worker threads: " << value;
+    } else if (directive == "worker_cpu_affinity") {
+      if (value == "auto") {
+        config->worker_cpu_affinity = NginxConfig::CPU_AFFINITY_AUTO;
+      } else if (value == "on") {
+        config->worker_cpu_affinity = NginxConfig::CPU_AFFINITY_ON;
+      } else if (value == "off") {
+        config->worker_cpu_affinity = NginxConfig::CPU_AFFINITY_OFF;
+      } else {
+        BOOST_LOG_TRIVIAL(error) << "Invalid worker_cpu_affinity value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << "Worker CPU affinity: " << value;
+    } else if (directive == "io_backend") {
+      if (value == "epoll") {
+        config->io_backend = NginxConfig::IO_BACKEND_EPOLL;
+      } else if (value == "io_uring") {
+        config->io_backend = NginxConfig::IO_BACKEND_IO_URING;
+      } else {
+        BOOST_LOG_TRIVIAL(error) << "Invalid io_backend value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << "I/O backend: " << value;
+    } else if (directive == "reuseport") {
+      if (value == "on") {
+        config->reuse_port = true;
+      } else if (value == "off") {
+        config->reuse_port = false;
+      } else {
+        BOOST_LOG_TRIVIAL(error) << "Invalid reuseport value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << "Reuseport: " << value;
+    } else if (directive == "client_header_timeout" || directive == "client_body_timeout" ||
+               directive == "keepalive_timeout" || directive == "send_timeout" ||
+               directive == "drain_timeout") {
+      int timeout_ms = ParseDuration(value);
+      if (timeout_ms < 0) {
+        BOOST_LOG_TRIVIAL(error) << "Invalid " << directive << " value: " << value;
+        continue;
+      }
+      if (directive == "client_header_timeout") {
+        config->client_header_timeout_ms = timeout_ms;
+      } else if (directive == "client_body_timeout") {
+        config->client_body_timeout_ms = timeout_ms;
+      } else if (directive == "keepalive_timeout") {
+        config->keepalive_timeout_ms = timeout_ms;
+      } else if (directive == "drain_timeout") {
+        config->drain_timeout_ms = timeout_ms;
+      } else {
+        config->send_timeout_ms = timeout_ms;
+      }
+      BOOST_LOG_TRIVIAL(info) << "Timeout " << directive << ": " << timeout_ms << "ms";
+    } else if (directive == "listen_backlog" || directive == "accept_concurrency" ||
+               directive == "max_connections" || directive == "max_requests_in_flight") {
+      try {
+        int number = std::stoi(value);
+        if (number <= 0) {
+          BOOST_LOG_TRIVIAL(error) << directive << " must be positive, got " << value;
+        } else if (directive == "listen_backlog") {
+          config->listen_backlog = number;
+        } else if (directive == "accept_concurrency") {
+          config->accept_concurrency = number;
+        } else if (directive == "max_connections") {
+          config->max_connections = number;
+        } else {
+          config->max_requests_in_flight = number;
+        }
+      } catch (std::exception& e) {
+        BOOST_LOG_TRIVIAL(error) << "Invalid " << directive << " value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << directive << ": " << value;
+    } else if (directive == "client_max_uri_size" || directive == "client_max_header_size" ||
+               directive == "client_max_body_size") {
+      long long size = ParseSize(value);
+      if (size < 0) {
+        BOOST_LOG_TRIVIAL(error) << "Invalid " << directive << " value: " << value;
+        continue;
+      }
+      if (directive == "client_max_uri_size") {
+        config->client_max_uri_size = size;
+      } else if (directive == "client_max_header_size") {
+        config->client_max_header_size = size;
+      } else {
+        config->client_max_body_size = size;
+      }
+      BOOST_LOG_TRIVIAL(info) << directive << ": " << size << " bytes";
+    } else if (directive == "client_max_header_count") {
+      try {
+        int count = std::stoi(value);
+        if (count >= 0) {
+          config->client_max_header_count = count;
+        } else {
+          BOOST_LOG_TRIVIAL(error) << "client_max_header_count must not be negative, got " << value;
+        }
+      } catch (std::exception& e) {
+        BOOST_LOG_TRIVIAL(error) << "Invalid client_max_header_count value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << "client_max_header_count: " << value;
+    } else if (directive == "accept_flags") {
+      // Comma separated list of nonblock and cloexec, or none.
+      int flags = 0;
+      bool valid = true;
+      std::stringstream flag_stream(value);
+      std::string flag;
+      while (std::getline(flag_stream, flag, ',')) {
+        if (flag == "nonblock") {
+          flags |= SOCK_NONBLOCK;
+        } else if (flag == "cloexec") {
+          flags |= SOCK_CLOEXEC;
+        } else if (flag != "none") {
+          valid = false;
+        }
+      }
+      if (valid) {
+        config->accept_flags = flags;
+      } else {
+        BOOST_LOG_TRIVIAL(error) << "Invalid accept_flags value: " << value;
+      }
+      BOOST_LOG_TRIVIAL(info) << "Accept flags: " << value;
+    }
+  }
+
+  for (const auto& statement : config->statements_) {
+    const std::vector<std::string>& tokens = statement->tokens_;
+    if (tokens.size() >= 2 && tokens[0] == "location" && statement->child_block_ != nullptr) {
+      ParseLocationDirectives(tokens[1].substr(1, tokens[1].size() - 2), *statement->child_block_, config);
+    }
+  }
+}
+
+/* void NginxConfigParser::ParseLocationDirectives(const std::string& location,
+    const NginxConfig& block, NginxConfig* config)
+  Parameter(s):
+    - location: Path of the location block, without quotes.
+    - block: Statements inside the location block.
+    - config: Parsed representation of configuration file (see config_parser.h). The
+    resulting per-location settings are stored into it.
+  Returns:
+    - N/A
+  Description:
+    - Reads the directives any location may carry regardless of its handler type
+    (max_requests_in_flight, client_max_body_size and the compression directives).  */
+void NginxConfigParser::ParseLocationDirectives(const std::string& location, const NginxConfig& block,
+                                                NginxConfig* config) {
+  NginxConfig::Compression compression = config->compression;
+  bool has_compression = false;
+  for (const auto& statement : block.statements_) {
+    const std::vector<std::string>& tokens = statement->tokens_;
+    if (ParseCompressionDirective(tokens, &compression)) {
+      has_compression = true;
+      continue;
+    }
+    if (tokens.size() == 2 && tokens[0] == "client_max_body_size") {
+      long long size = ParseSize(tokens[1]);
+      if (size >= 0) {
+        config->location_client_max_body_size_[location] = size;
+        BOOST_LOG_TRIVIAL(info) << "Max body size for " << location << ": " << size << " bytes";
+      } else {
+        BOOST_LOG_TRIVIAL(error) << "Invalid client_max_body_size value for " << location << ": " << tokens[1];
+      }
+      continue;
+    }
+    if (tokens.size() != 2 || tokens[0] != "max_requests_in_flight") {
+      continue;
+    }
+    int limit = 0;
+    try {
+      limit = std::stoi(tokens[1]);
+    } catch (std::exception& e) {
+      limit = 0;
+    }
+    if (limit > 0) {
+      config->location_max_requests_in_flight_[location] = limit;
+      BOOST_LOG_TRIVIAL(info) << "Max requests in flight for " << location << ": " << limit;
+    } else {
+      BOOST_LOG_TRIVIAL(error) << "Invalid max_requests_in_flight value for " << location << ": " << tokens[1];
+    }
+  }
+  if (has_compression) {
+    config->location_compression_[location] = compression;
+  }
+}
+
+/* bool NginxConfigParser::ParseCompressionDirective(const std::vector<std::string>& tokens,
+    NginxConfig::Compression* compression)
+  Parameter(s):
+    - tokens: Tokens of one statement.
+    - compression: Settings the statement is applied to.
+  Returns:
+    - bool which is false if the statement is not a compression directive.
+  Description:
+    - Reads "gzip on|off", "gzip_static on|off", "gzip_types type...", "gzip_min_length size"
+    and "gzip_comp_level 1-9". An invalid value is logged and leaves the setting as it was.  */
+bool NginxConfigParser::ParseCompressionDirective(const std::vector<std::string>& tokens,
+                                                  NginxConfig::Compression* compression) {
+  if (tokens.size() < 2) {
+    return false;
+  }
+  const std::string& directive = tokens[0];
+  const std::string& value = tokens[1];
+  if (directive == "gzip_types") {
+    compression->types.assign(1, "text/html");
+    for (std::size_t i = 1; i < tokens.size(); i++) {
+      if (tokens[i] != "text/html") {
+        compression->types.push_back(tokens[i]);
+      }
+    }
+    BOOST_LOG_TRIVIAL(info) << "gzip_types: " << tokens.size() - 1 << " types";
+    return true;
+  }
+  if (tokens.size() != 2) {
+    return false;
+  }
+  if (directive == "gzip" || directive == "gzip_static") {
+    bool& setting = directive == "gzip" ? compression->enabled : compression->static_variants;
+    if (value == "on") {
+      setting = true;
+    } else if (value == "off") {
+      setting = false;
+    } else {
+      BOOST_LOG_TRIVIAL(error) << "Invalid " << directive << " value: " << value;
+    }
+  } else if (directive == "gzip_min_length") {
+    long long size = ParseSize(value);
+    if (size >= 0) {
+      compression->min_length = size;
+    } else {
+      BOOST_LOG_TRIVIAL(error) << "Invalid gzip_min_length value: " << value;
+    }
+  } else if (directive == "gzip_comp_level") {
+    int level = 0;
+    try {
+      level = std::stoi(value);
+    } catch (std::exception& e) {
+      level = 0;
+    }
+    if (level >= 1 && level <= 9) {
+      compression->level = level;
+    } else {
+      BOOST_LOG_TRIVIAL(error) << "Invalid gzip_comp_level value: " << value;
+    }
+  } else {
+    return false;
+  }
+  BOOST_LOG_TRIVIAL(info) << directive << ": " << value;
+  return true;
+}
+
+/* int NginxConfigParser::ParseDuration(const std::string& value)
+  Parameter(s):
+    - value: Duration token, a whole number with an optional ms, s or m suffix (seconds when
+    there is no suffix, as in nginx).
+  Returns:
+    - int holding the duration in milliseconds, or -1 if the token is not a valid duration.
+  Description:
+    - Converts the value of a timeout directive to milliseconds.  */
+int NginxConfigParser::ParseDuration(const std::string& value) {
+  size_t digits = 0;
+  while (digits < value.size() && isdigit(static_cast<unsigned char>(value[digits]))) {
+    digits++;
+  }
+  if (digits == 0 || digits > 6) {
+    return -1;
+  }
+  long long amount = std::stoll(value.substr(0, digits));
+  std::string unit = value.substr(digits);
+  if (unit == "" || unit == "s") {
+    amount *= 1000;
+  } else if (unit == "m") {
+    amount *= 60 * 1000;
+  } else if (unit != "ms") {
+    return -1;
+  }
+  return amount <= INT_MAX ? static_cast<int>(amount) : -1;
+}
+
+/* long long NginxConfigParser::ParseSize(const std::string& value)
+  Parameter(s):
+    - value: Size token, a whole number with an optional k, m or g suffix (bytes when there is
+    no suffix, as in nginx), in either case.
+  Returns:
+    - long long holding the size in bytes, or -1 if the token is not a valid size.
+  Description:
+    - Converts the value of a size directive to bytes.  */
+long long NginxConfigParser::ParseSize(const std::string& value) {
+  size_t digits = 0;
+  while (digits < value.size() && isdigit(static_cast<unsigned char>(value[digits]))) {
+    digits++;
+  }
+  if (digits == 0 || digits > 18) {
+    return -1;
+  }
+  long long size = std::stoll(value.substr(0, digits));
+  std::string unit = value.substr(digits);
+  long long scale = 1;
+  if (unit == "k" || unit == "K") {
+    scale = 1024;
+  } else if (unit == "m" || unit == "M") {
+    scale = 1024 * 1024;
+  } else if (unit == "g" || unit == "G") {
+    scale = 1024 * 1024 * 1024;
+  } else if (unit != "") {
+    return -1;
+  }
+  return size <= LLONG_MAX / scale ? size * scale : -1;
+}
@@ -0,0 +1,123 @@
+/* admission_control.cc
+Description:
+    Connection and in-flight request limits, and the 503 used to shed requests
+    over them.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <boost/log/trivial.hpp>
+
+#include "admission_control.h"
+#include "response_helper_library.h"
+#include "server_metrics.h"
+
+/* admission_control Constructor
+Parameter(s):
+    - config: parsed config holding the global and per-location limits.
+    - dispatcher: dispatcher whose location handlers the per-location limits attach to.
+Description:
+    - Resolves each location limit to its handler and builds the 503 response. */
+admission_control::admission_control(const NginxConfig& config, request_dispatcher& dispatcher)
+    : max_connections_(config.max_connections), max_requests_in_flight_(config.max_requests_in_flight),
+      max_body_size_(config.client_max_body_size),
+      service_unavailable_(ResponseHelperLibrary::stock_response(Response::service_unavailable)) {
+    for (const auto& limit : config.location_max_requests_in_flight_) {
+        const request_handler* handler = dispatcher.get_location_handler(limit.first);
+        if (handler == nullptr) {
+            BOOST_LOG_TRIVIAL(error) << "No handler for limited location " << limit.first;
+            continue;
+        }
+        std::unique_ptr<location_limit> location(new location_limit);
+        location->max_requests_in_flight = limit.second;
+        location_limits_[handler] = std::move(location);
+    }
+    for (const auto& limit : config.location_client_max_body_size_) {
+        const request_handler* handler = dispatcher.get_location_handler(limit.first);
+        if (handler == nullptr) {
+            BOOST_LOG_TRIVIAL(error) << "No handler for limited location " << limit.first;
+            continue;
+        }
+        location_max_body_size_[handler] = limit.second;
+    }
+    // Clients should come back rather than treat the 503 as final.
+    service_unavailable_.headers_[header_id::retry_after] = "1";
+}
+
+/* bool admission_control::try_acquire(std::atomic<int>& counter, int limit)
+Parameter(s):
+    - counter: number of slots in use.
+    - limit: most slots allowed, 0 for no limit.
+Returns:
+    - bool which is true if a slot was taken.
+Description:
+    - Takes a slot unless that would go over the limit. */
+bool admission_control::try_acquire(std::atomic<int>& counter, int limit) {
+    int in_use = counter.fetch_add(1, std::memory_order_relaxed);
+    if (limit > 0 && in_use >= limit) {
+        counter.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool admission_control::try_open_connection() {
+    if (draining()) {
+        return false;
+    }
+    return try_acquire(server_metrics::get().active_connections, max_connections_);
+}
+
+void admission_control::open_connection() {
+    server_metrics::get().active_connections.fetch_add(1, std::memory_order_relaxed);
+}
+
+void admission_control::close_connection() {
+    server_metrics::get().active_connections.fetch_sub(1, std::memory_order_relaxed);
+}
+
+/* bool admission_control::try_start_request(const request_handler* handler)
+Parameter(s):
+    - handler: handler the dispatcher picked for the request.
+Returns:
+    - bool which is true if the request may run.
+Description:
+    - Takes a global in-flight slot, then one for the handler's location if it has a limit. */
+bool admission_control::try_start_request(const request_handler* handler) {
+    server_metrics& metrics = server_metrics::get();
+    if (!try_acquire(metrics.requests_in_flight, max_requests_in_flight_)) {
+        return false;
+    }
+    auto location = location_limits_.find(handler);
+    if (location != location_limits_.end() &&
+        !try_acquire(location->second->requests_in_flight, location->second->max_requests_in_flight)) {
+        metrics.requests_in_flight.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+const Response& admission_control::shed_request() {
+    server_metrics::get().requests_shed.fetch_add(1, std::memory_order_relaxed);
+    return service_unavailable_;
+}
+
+void admission_control::finish_request(const request_handler* handler) {
+    auto location = location_limits_.find(handler);
+    if (location != location_limits_.end()) {
+        location->second->requests_in_flight.fetch_sub(1, std::memory_order_relaxed);
+    }
+    server_metrics::get().requests_in_flight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t admission_control::max_body_size(const request_handler* handler) const {
+    auto location = location_max_body_size_.find(handler);
+    return location != location_max_body_size_.end() ? location->second : max_body_size_;
+}
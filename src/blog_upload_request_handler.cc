@@ -11,14 +11,170 @@ Author(s):
 Date Created:
   June 4th, 2020
 */
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include <boost/log/trivial.hpp>
 #include "blog_upload_request_handler.h"
 #include "response_helper_library.h"
 #include "request.h"
 
+// Decodes an urlencoded form as it arrives, keeping only the fields a blog post needs,
+// so an upload costs no more memory than its title and body. Bytes are url decoded
+// first and the decoded text is then split at '&' and '=', so an encoded "%26" splits
+// fields too.
+class blog_upload_request_handler::form_stream : public body_consumer {
+ public:
+  explicit form_stream(blog_upload_request_handler* handler)
+    : handler_(handler), percent_(0), at_key_(true) {}
+
+  void on_data(const char* data, std::size_t size) override {
+    for (std::size_t i = 0; i < size; ++i) {
+      decode(data[i]);
+    }
+  }
+
+  Response on_complete() override {
+    // A '%' without two characters after it is kept as it is.
+    while (percent_ != 0) {
+      add('%');
+      bool had_digit = percent_ == 2;
+      percent_ = 0;
+      if (had_digit) {
+        decode(first_digit_);
+      }
+    }
+    end_field();
+    return handler_->handle_post_blog(title_, body_);
+  }
+
+ private:
+  void decode(char c) {
+    if (percent_ == 1) {
+      first_digit_ = c;
+      percent_ = 2;
+    } else if (percent_ == 2) {
+      percent_ = 0;
+      add(static_cast<char>((from_hex(first_digit_) << 4) | from_hex(c)));
+    } else if (c == '%') {
+      percent_ = 1;
+    } else {
+      // Replaces +'s with spaces
+      add(c == '+' ? ' ' : c);
+    }
+  }
+
+  void add(char c) {
+    if (c == '=') {
+      if (at_key_) {
+        start_value();
+      }
+    } else if (c == '&') {
+      end_field();
+    } else if (at_key_) {
+      key_ += c;
+    } else if (value_ != nullptr) {
+      *value_ += c;
+    }
+  }
+
+  // A later field with the same name replaces an earlier one.
+  void start_value() {
+    at_key_ = false;
+    value_ = key_ == "submissiontitle" ? &title_ :
+             key_ == "submissionbody" ? &body_ : nullptr;
+    if (value_ != nullptr) {
+      value_->clear();
+    }
+  }
+
+  // A field without '=' has an empty value.
+  void end_field() {
+    if (at_key_) {
+      start_value();
+    }
+    at_key_ = true;
+    key_.clear();
+    value_ = nullptr;
+  }
+
+  blog_upload_request_handler* handler_;
+  // Characters of a %XY escape seen so far, and the first hex digit once there is one.
+  int percent_;
+  char first_digit_;
+  bool at_key_;
+  std::string key_;
+  // Where the value of the current field goes, null for fields that are not kept.
+  std::string* value_ = nullptr;
+  std::string title_;
+  std::string body_;
+};
+
+namespace {
+
+// Renders the page listing every post one post at a time, as the session writes it, so
+// the page is never built whole next to the posts it is made from. Each post is let go
+// once it is rendered.
+class blog_list_producer : public body_producer {
+ public:
+  explicit blog_list_producer(std::vector<Blog> blogs)
+    : blogs_(std::move(blogs)), next_blog_(0), offset_(0), ended_(false) {
+    piece_ = "<!DOCTYPE html>\n\
+<html>\n\
+    <head>\n\
+        <meta charset='utf-8'>\n\
+        <title>All Blogs</title>\n\
+    </head>\n\
+    <body style=\"text-align:center;\">\n";
+  }
+
+  bool read(char* buffer, std::size_t capacity, std::size_t& size) override {
+    size = 0;
+    while (size < capacity && (offset_ < piece_.size() || next_piece())) {
+      std::size_t count = std::min(capacity - size, piece_.size() - offset_);
+      piece_.copy(buffer + size, count, offset_);
+      offset_ += count;
+      size += count;
+    }
+    return true;
+  }
+
+ private:
+  // Replaces piece_ with the next post, or with the end of the page after the last one.
+  // False once the page is done.
+  bool next_piece() {
+    offset_ = 0;
+    if (next_blog_ < blogs_.size()) {
+      Blog& blog = blogs_[next_blog_++];
+      piece_ = "<div>*****POSTID: " + std::to_string(blog.postid) +  "*****</div>";
+      piece_ += "<h1>\n" + blog.title + "</h1>\n";
+      piece_ += "<p>\n" + blog.body + "</p>\n";
+      piece_ += "<div>-------------------------------------------------------------------------------------</div>";
+      blog = Blog();
+      return true;
+    }
+    if (!ended_) {
+      piece_ = "</body>\n</html>\n";
+      ended_ = true;
+      return true;
+    }
+    piece_.clear();
+    return false;
+  }
+
+  std::vector<Blog> blogs_;
+  std::size_t next_blog_;
+  // The rendered text being handed out, and how much of it has been.
+  std::string piece_;
+  std::size_t offset_;
+  bool ended_;
+};
+
+}  // namespace
+
 blog_upload_request_handler* blog_upload_request_handler::Init(const std::string& location_path, const NginxConfig& config) {
   blog_upload_request_handler* burh = new blog_upload_request_handler();
   const std::string database_name = "postgres";
@@ -46,15 +202,19 @@ blog_upload_request_handler::~blog_upload_request_handler() {
 }
 
 Response blog_upload_request_handler::handle_request(const Request& request) {
+  return handle_request(RequestView(request));
+}
+
+// Goes by the decoded path, so a query string after the id is no part of it
+Response blog_upload_request_handler::handle_request(const RequestView& request) {
   BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: Blog Post Upload";
   BOOST_LOG_TRIVIAL(info) << "Sending back blog upload form.";
   Response response_;
-  std::string decoded_str = urldecode(request.body_);
-  form_to_value_ = parseRequestBody(decoded_str);
 
   if (request.method_ == Request::MethodEnum::GET) {
-    std::string remain_uri = request.uri_.substr(location_prefix_.size());
-    if ( (location_prefix_ + "/").find(request.uri_) != std::string::npos) {
+    std::string path(request.path_);
+    std::string remain_uri = path.substr(location_prefix_.size());
+    if ( (location_prefix_ + "/").find(path) != std::string::npos) {
       response_ = handle_get_all_blogs();
     }
     // If user enters unparsable id, return bad id error page to client
@@ -65,11 +225,22 @@ Response blog_upload_request_handler::handle_request(const Request& request) {
       response_ = handle_get_one_blog(stoi(remain_uri));
     }
   } else {
-    response_ = handle_post_blog(form_to_value_["submissiontitle"], form_to_value_["submissionbody"]);
+    form_stream form(this);
+    form.on_data(request.body_.data(), request.body_.size());
+    response_ = form.on_complete();
   }
   return response_;
 }
 
+// Posts take their form as it arrives rather than after the whole body is buffered
+std::unique_ptr<body_consumer> blog_upload_request_handler::start_body_stream(const RequestView& head) {
+  if (head.method_ == Request::MethodEnum::GET) {
+    return nullptr;
+  }
+  BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: Blog Post Upload";
+  return std::unique_ptr<body_consumer>(new form_stream(this));
+}
+
 // Check if all characters are digits
 bool blog_upload_request_handler::is_number(const std::string& enter_string) {
   if (enter_string.empty()) {
@@ -111,34 +282,19 @@ Response blog_upload_request_handler::handle_get_one_blog(int postid) {
 
   Response response;
   response.code_ = Response::ok;
-  response.body_ = html_body_get_response;
-  response.headers_["Content-Length"] = std::to_string(response.body_.size());
-  response.headers_["Content-Type"] = "text/html";
+  response.body_ = std::move(html_body_get_response);
+  response.headers_[header_id::content_length] = std::to_string(response.body_.size());
+  response.headers_[header_id::content_type] = "text/html";
   return response;
 }
 
+// The listing grows with every post, so it is streamed rather than built in one string
+// (see blog_list_producer); its length is not known up front.
 Response blog_upload_request_handler::handle_get_all_blogs() {
-  std::string html_body_get_response = "<!DOCTYPE html>\n\
-<html>\n\
-    <head>\n\
-        <meta charset='utf-8'>\n\
-        <title>All Blogs</title>\n\
-    </head>\n\
-    <body style=\"text-align:center;\">\n";
-  std::vector<Blog> blogs = bd_->get_all_blogs();
-  for (auto vectorit = blogs.begin(); vectorit != blogs.end(); ++vectorit) {
-    html_body_get_response += "<div>*****POSTID: " + std::to_string((*vectorit).postid) +  "*****</div>";
-    html_body_get_response += "<h1>\n" + (*vectorit).title + "</h1>\n";
-    html_body_get_response += "<p>\n" + (*vectorit).body + "</p>\n";
-    html_body_get_response += "<div>-------------------------------------------------------------------------------------</div>";
-  }
-  html_body_get_response += "</body>\n</html>\n";
-
   Response response;
   response.code_ = Response::ok;
-  response.body_ = html_body_get_response;
-  response.headers_["Content-Length"] = std::to_string(response.body_.size());
-  response.headers_["Content-Type"] = "text/html";
+  response.body_producer_ = std::make_shared<blog_list_producer>(bd_->get_all_blogs());
+  response.headers_[header_id::content_type] = "text/html";
   return response;
 }
 
@@ -148,13 +304,13 @@ Response blog_upload_request_handler::handle_post_blog(std::string title, std::s
 
   Response response;
   response.code_ = Response::moved_temporarily;
-  response.headers_["Content-Length"] = std::to_string(response.body_.size());
-  response.headers_["Content-Type"] = "text/html";
+  response.headers_[header_id::content_length] = std::to_string(response.body_.size());
+  response.headers_[header_id::content_type] = "text/html";
   // Redirected to new location
   if (location_prefix_[location_prefix_.size() - 1] == '/') {
-    response.headers_["Location"] = location_prefix_ + std::to_string(postid);
+    response.headers_[header_id::location] = location_prefix_ + std::to_string(postid);
   } else {
-    response.headers_["Location"] = std::string(location_prefix_) + "/" + std::to_string(postid);
+    response.headers_[header_id::location] = std::string(location_prefix_) + "/" + std::to_string(postid);
   }
   return response;
 }
@@ -171,57 +327,3 @@ unsigned char blog_upload_request_handler::from_hex(unsigned char ch) {
       ch = 0;
   return ch;
 }
-
-// http://dlib.net/dlib/server/server_http.cpp.html
-// Decode URL for the database
-std::string blog_upload_request_handler::urldecode (const std::string& str) {
-  using namespace std;
-  string result;
-  string::size_type i;
-  for (i = 0; i < str.size(); ++i) {
-      // Replaces +'s with spaces
-      if (str[i] == '+') {
-        result += ' ';
-      } else if (str[i] == '%' && str.size() > i+2) {  // Replace percent encoding to ascii characters
-        const unsigned char ch1 = from_hex(str[i+1]);
-        const unsigned char ch2 = from_hex(str[i+2]);
-        const unsigned char ch = (ch1 << 4) | ch2;
-        result += ch;
-        i += 2;
-      } else {
-        result += str[i];
-      }
-  }
-  return result;
-}
-
-// Parse the request body so that we can store in the database properly
-std::map<std::string, std::string> blog_upload_request_handler::parseRequestBody(std::string body) {
-  std::map <std::string, std::string> temp;
-  std::string key = "";
-  std::string value = "";
-  int counter = 0;
-  bool atkey = true;
-  while (counter < body.length()) {
-    if (body[counter] == '=') {
-      atkey = false;
-      counter++;
-      continue;
-    } else if (body[counter] == '&') {
-      atkey = true;
-      temp[key] = value;
-      counter++;
-      key = "";
-      value = "";
-      continue;
-    }
-    if (atkey) {
-      key += body.at(counter);
-    } else {
-      value += body.at(counter);
-    }
-    counter++;
-  }
-  temp[key] = value;
-  return temp;
-}
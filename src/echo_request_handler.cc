@@ -36,56 +36,56 @@ echo_request_handler* echo_request_handler::Init(const std::string& location_pat
     return erh;
 }
 
-/*  std::string echo_request_handler::build_request_string(const Request& request)
+/*  std::string echo_request_handler::build_request_string(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - string that formats the request body.
 Description: 
-    - Echo request is reformatted to be returned as a response body. */
-std::string echo_request_handler::build_request_string(const Request& request) {
-    std::string request_string;
-    if (request.method_ == Request::MethodEnum::GET) {
-        request_string += "GET ";
-    } else if (request.method_ == Request::MethodEnum::POST) {
-        request_string += "POST ";
-    } else if (request.method_ == Request::MethodEnum::DELETE) {
-        request_string += "DELETE ";
+    - Echo request is reformatted to be returned as a response body, with the headers
+    in the order the client sent them. */
+std::string echo_request_handler::build_request_string(const RequestView& request) {
+    std::size_t size = request.method_name_.size() + request.uri_.size() +
+        request.version_.size() + request.body_.size() + 6;
+    for (const header_view& h : request.headers_) {
+        size += h.name.size() + h.value.size() + 4;
     }
-    request_string += request.uri_;
-    request_string += " ";
-    request_string += request.version_;
-    request_string += "\r\n";
+    std::string request_string;
+    request_string.reserve(size);
+    request_string.append(request.method_name_).append(" ");
+    request_string.append(request.uri_).append(" ");
+    request_string.append(request.version_).append("\r\n");
 
-    for (std::map<std::string,std::string>::const_iterator it=request.headers_.begin(); it!=request.headers_.end(); ++it) {
-        std::string new_headerline = it->first + ": " + it->second + "\r\n";
-        request_string += new_headerline;
+    for (const header_view& h : request.headers_) {
+        request_string.append(h.name).append(": ").append(h.value).append("\r\n");
     }
     request_string += "\r\n";
 
-    request_string += request.body_;
+    request_string.append(request.body_);
     return request_string;
 }
 
-/*  Response echo_request_handler::handle_request(const request& request)
+Response echo_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response echo_request_handler::handle_request(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - Response object (see response.h)
 Description: 
     - Response object is generated and returned, using the request message as the response body. */
-Response echo_request_handler::handle_request(const Request& request) {
+Response echo_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: echo" ;
     // BOOST_LOG_TRIVIAL(info) << "Currently serving echo requests on path: " << request.uri_;
     Response response;
 
-    std::string full_request_str = build_request_string(request);
-
     // Fill out the Response to be sent to the client.
     response.code_ = Response::ok;
-    response.body_ = full_request_str;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/plain";
+    response.body_ = build_request_string(request);
+    response.headers_[header_id::content_length] = std::to_string(response.body_.size());
+    response.headers_[header_id::content_type] = "text/plain";
 
     return response;
 }
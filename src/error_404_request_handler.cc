@@ -35,24 +35,28 @@ error_404_request_handler* error_404_request_handler::Init(const std::string& lo
     return new error_404_request_handler();
 }
 
-/*  Response error_404_request_handler::handle_request(const request& request)
+Response error_404_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response error_404_request_handler::handle_request(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - Response object (see response.h)
 Description: 
     - Response object is generated and returned, with generic stock response 
     in body and corresponding response code. */
-Response error_404_request_handler::handle_request(const Request& request) {
+Response error_404_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: 404" ;
     BOOST_LOG_TRIVIAL(info) << "Request not found: 404 error.";
     Response response;
 
     // Fill out the Response to be sent to the client.
     response.code_ = Response::not_found;
-    response.body_ = stock_responses::not_found;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/html";
+    response.shared_body_ = ResponseHelperLibrary::stock_body(Response::not_found);
+    response.headers_[header_id::content_length] = std::to_string(response.shared_body_->size());
+    response.headers_[header_id::content_type] = "text/html";
 
     return response;
 }
@@ -0,0 +1,121 @@
+/* header_cache.cc
+Description:
+    Per-thread cache of the Server and Date response headers, refreshed once a second,
+    and the Connection lines the serializer adds.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <cstring>
+#include <time.h>
+
+#include "header_cache.h"
+
+namespace {
+
+const char server[] = "Server: mrjk-web-server\r\n";
+const char date_name[] = "Date: ";
+const char close_line[] = "Connection: close\r\n";
+const char keep_alive_line[] = "Connection: keep-alive\r\n";
+
+const std::size_t server_size = sizeof(server) - 1;
+const std::size_t date_line_size = sizeof(date_name) - 1 + header_cache::date_size + 2;
+
+struct thread_block {
+    // Second the Date line was formatted for, -1 before the first response.
+    std::time_t second = -1;
+    char bytes[server_size + date_line_size];
+};
+
+thread_local thread_block block;
+
+// A clock read that costs no more than a memory load, accurate to a few milliseconds.
+std::time_t coarse_now() {
+    timespec now;
+#ifdef CLOCK_REALTIME_COARSE
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+#else
+    clock_gettime(CLOCK_REALTIME, &now);
+#endif
+    return now.tv_sec;
+}
+
+void put_two_digits(char* out, int value) {
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+}
+
+}  // namespace
+
+/* std::string_view header_cache::common()
+Parameter(s):
+    - N/A
+Returns:
+    - The Server and Date lines, back to back.
+Description:
+    - Formats the Date line again when the second has changed since the thread last
+    asked; otherwise returns the bytes as they are. */
+std::string_view header_cache::common() {
+    std::time_t now = coarse_now();
+    if (now != block.second) {
+        if (block.second == -1) {
+            std::memcpy(block.bytes, server, server_size);
+            std::memcpy(block.bytes + server_size, date_name, sizeof(date_name) - 1);
+            std::memcpy(block.bytes + sizeof(block.bytes) - 2, "\r\n", 2);
+        }
+        format_date(now, block.bytes + server_size + sizeof(date_name) - 1);
+        block.second = now;
+    }
+    return std::string_view(block.bytes, sizeof(block.bytes));
+}
+
+std::string_view header_cache::server_line() {
+    return std::string_view(server, server_size);
+}
+
+std::string_view header_cache::connection_close() {
+    return std::string_view(close_line, sizeof(close_line) - 1);
+}
+
+std::string_view header_cache::connection_keep_alive() {
+    return std::string_view(keep_alive_line, sizeof(keep_alive_line) - 1);
+}
+
+/* void header_cache::format_date(std::time_t time, char* out)
+Parameter(s):
+    - time: seconds since the epoch.
+    - out: where the date goes.
+Returns:
+    - N/A
+Description:
+    - Spelled out by hand rather than with strftime, whose day and month names follow
+    the locale. */
+void header_cache::format_date(std::time_t time, char* out) {
+    static const char days[] = "SunMonTueWedThuFriSat";
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    std::tm utc;
+    gmtime_r(&time, &utc);
+    std::memcpy(out, days + 3 * utc.tm_wday, 3);
+    std::memcpy(out + 3, ", ", 2);
+    put_two_digits(out + 5, utc.tm_mday);
+    out[7] = ' ';
+    std::memcpy(out + 8, months + 3 * utc.tm_mon, 3);
+    out[11] = ' ';
+    int year = utc.tm_year + 1900;
+    put_two_digits(out + 12, year / 100);
+    put_two_digits(out + 14, year % 100);
+    out[16] = ' ';
+    put_two_digits(out + 17, utc.tm_hour);
+    out[19] = ':';
+    put_two_digits(out + 20, utc.tm_min);
+    out[22] = ':';
+    put_two_digits(out + 23, utc.tm_sec);
+    std::memcpy(out + 25, " GMT", 4);
+}
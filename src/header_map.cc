@@ -0,0 +1,333 @@
+/* header_map.cc
+Description:
+    Header container of Request and Response, and the well-known header ids.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <strings.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "header_map.h"
+
+namespace {
+
+static_assert(http_tokens::headers.size() == static_cast<std::size_t>(header_id::count),
+              "a name for every header_id");
+
+// The hash of the id's name, which the table has already computed.
+constexpr std::uint32_t known_hash(header_id id) {
+    return http_tokens::headers.hash_of(static_cast<std::size_t>(id));
+}
+
+header_id lookup_header_id(std::string_view name, std::uint32_t hash) {
+    int index = http_tokens::headers.find(name, hash);
+    return index < 0 ? header_id::other : static_cast<header_id>(index);
+}
+
+bool names_equal(std::string_view lhs, std::string_view rhs) {
+    return lhs.size() == rhs.size() && strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+}  // namespace
+
+std::string_view header_name(header_id id) {
+    return http_tokens::headers[static_cast<std::size_t>(id)];
+}
+
+/* header_id lookup_header_id(std::string_view name)
+Parameter(s):
+    - name: header name, in any case.
+Returns:
+    - Its id, or header_id::other.
+Description:
+    - One probe of the perfect hash table in http_tokens. */
+header_id lookup_header_id(std::string_view name) {
+    return lookup_header_id(name, header_name_hash(name));
+}
+
+header_map::header_map() : size_(0), on_heap_(false) {
+    first_.fill(0);
+}
+
+header_map::header_map(std::initializer_list<std::pair<std::string_view, std::string_view>> headers)
+    : header_map() {
+    for (const auto& header : headers) {
+        add(header.first, header.second);
+    }
+}
+
+header_map::header_map(const header_map& other) : header_map() {
+    *this = other;
+}
+
+header_map::header_map(header_map&& other) noexcept : header_map() {
+    *this = std::move(other);
+}
+
+/* header_map& header_map::operator=(const header_map& other)
+Description:
+    - Copies only the headers in use, not the whole inline array. */
+header_map& header_map::operator=(const header_map& other) {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    if (other.on_heap_) {
+        heap_ = other.heap_;
+        on_heap_ = true;
+    } else {
+        std::copy(other.inline_.begin(), other.inline_.begin() + other.size_, inline_.begin());
+        size_ = other.size_;
+    }
+    first_ = other.first_;
+    return *this;
+}
+
+header_map& header_map::operator=(header_map&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    if (other.on_heap_) {
+        heap_.swap(other.heap_);
+        on_heap_ = true;
+    } else {
+        std::move(other.inline_.begin(), other.inline_.begin() + other.size_, inline_.begin());
+        size_ = other.size_;
+    }
+    first_ = other.first_;
+    other.clear();
+    return *this;
+}
+
+/* void header_map::clear()
+Description:
+    - Empties the strings in use so their buffers can be reused, and keeps the
+    heap vector's capacity. */
+void header_map::clear() {
+    for (std::size_t i = 0; i < size_; ++i) {
+        inline_[i].name.clear();
+        inline_[i].value.clear();
+    }
+    size_ = 0;
+    heap_.clear();
+    on_heap_ = false;
+    first_.fill(0);
+}
+
+std::string& header_map::operator[](std::string_view name) {
+    std::uint32_t hash = header_name_hash(name);
+    header_id id = lookup_header_id(name, hash);
+    if (id != header_id::other) {
+        std::size_t position = first_[index(id)];
+        if (position != 0) {
+            return data()[position - 1].value;
+        }
+        return append(name, id, hash).value;
+    }
+    std::size_t position = find_position(name, hash);
+    if (position != size()) {
+        return data()[position].value;
+    }
+    return append(name, id, hash).value;
+}
+
+std::string& header_map::operator[](header_id id) {
+    std::size_t position = first_[index(id)];
+    if (position != 0) {
+        return data()[position - 1].value;
+    }
+    return append(header_name(id), id, known_hash(id)).value;
+}
+
+header_map::iterator header_map::find(std::string_view name) {
+    return const_cast<iterator>(static_cast<const header_map&>(*this).find(name));
+}
+
+header_map::const_iterator header_map::find(std::string_view name) const {
+    std::uint32_t hash = header_name_hash(name);
+    header_id id = lookup_header_id(name, hash);
+    if (id != header_id::other) {
+        return find(id);
+    }
+    return begin() + find_position(name, hash);
+}
+
+header_map::iterator header_map::find(header_id id) {
+    std::size_t position = first_[index(id)];
+    return position == 0 ? end() : begin() + position - 1;
+}
+
+header_map::const_iterator header_map::find(header_id id) const {
+    std::size_t position = first_[index(id)];
+    return position == 0 ? end() : begin() + position - 1;
+}
+
+const std::string& header_map::at(std::string_view name) const {
+    const_iterator it = find(name);
+    if (it == end()) {
+        throw std::out_of_range("header_map::at");
+    }
+    return it->value;
+}
+
+std::string_view header_map::get(header_id id) const {
+    const_iterator it = find(id);
+    return it == end() ? std::string_view() : std::string_view(it->value);
+}
+
+std::size_t header_map::count(std::string_view name) const {
+    std::uint32_t hash = header_name_hash(name);
+    std::size_t n = 0;
+    for (const header_entry& entry : *this) {
+        if (entry.hash == hash && names_equal(entry.name, name)) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+void header_map::add(std::string_view name, std::string_view value) {
+    std::uint32_t hash = header_name_hash(name);
+    append(name, lookup_header_id(name, hash), hash).value.assign(value.data(), value.size());
+}
+
+/* std::size_t header_map::erase(std::string_view name)
+Parameter(s):
+    - name: header name, in any case.
+Returns:
+    - How many headers were removed.
+Description:
+    - Later headers move up to close the gaps, keeping their order. */
+std::size_t header_map::erase(std::string_view name) {
+    std::uint32_t hash = header_name_hash(name);
+    header_entry* entries = data();
+    std::size_t kept = 0;
+    std::size_t total = size();
+    for (std::size_t i = 0; i < total; ++i) {
+        if (entries[i].hash == hash && names_equal(entries[i].name, name)) {
+            continue;
+        }
+        if (kept != i) {
+            std::swap(entries[kept], entries[i]);
+        }
+        ++kept;
+    }
+    if (kept == total) {
+        return 0;
+    }
+    if (on_heap_) {
+        heap_.resize(kept);
+    } else {
+        for (std::size_t i = kept; i < total; ++i) {
+            inline_[i].name.clear();
+            inline_[i].value.clear();
+        }
+        size_ = kept;
+    }
+    reindex();
+    return total - kept;
+}
+
+std::size_t header_map::find_position(std::string_view name, std::uint32_t hash) const {
+    const header_entry* entries = data();
+    std::size_t total = size();
+    for (std::size_t i = 0; i < total; ++i) {
+        if (entries[i].hash == hash && names_equal(entries[i].name, name)) {
+            return i;
+        }
+    }
+    return total;
+}
+
+/* header_entry& header_map::append(std::string_view name, header_id id, std::uint32_t hash)
+Parameter(s):
+    - name, id, hash: the new header's name, its id and its hash.
+Returns:
+    - The new header, with an empty value.
+Description:
+    - Moves every header to the heap when the inline array is full. */
+header_entry& header_map::append(std::string_view name, header_id id, std::uint32_t hash) {
+    header_entry* entry;
+    if (!on_heap_ && size_ == inline_capacity) {
+        heap_.reserve(2 * inline_capacity);
+        for (std::size_t i = 0; i < size_; ++i) {
+            heap_.push_back(std::move(inline_[i]));
+            inline_[i].name.clear();
+            inline_[i].value.clear();
+        }
+        size_ = 0;
+        on_heap_ = true;
+    }
+    if (on_heap_) {
+        heap_.emplace_back();
+        entry = &heap_.back();
+    } else {
+        entry = &inline_[size_++];
+    }
+    entry->name.assign(name.data(), name.size());
+    entry->value.clear();
+    entry->id = id;
+    entry->hash = hash;
+    std::size_t position = size();
+    if (id != header_id::other && first_[index(id)] == 0 &&
+        position <= std::numeric_limits<std::uint16_t>::max()) {
+        first_[index(id)] = static_cast<std::uint16_t>(position);
+    }
+    return *entry;
+}
+
+void header_map::reindex() {
+    first_.fill(0);
+    std::size_t position = 0;
+    for (const header_entry& entry : *this) {
+        ++position;
+        if (entry.id != header_id::other && first_[index(entry.id)] == 0 &&
+            position <= std::numeric_limits<std::uint16_t>::max()) {
+            first_[index(entry.id)] = static_cast<std::uint16_t>(position);
+        }
+    }
+}
+
+/* bool operator==(const header_map& lhs, const header_map& rhs)
+Parameter(s):
+    - lhs, rhs: headers to compare.
+Returns:
+    - bool which is true if they hold the same headers.
+Description:
+    - The n-th header called some name in lhs must have the same value as the n-th
+    header called that name in rhs. */
+bool operator==(const header_map& lhs, const header_map& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (header_map::const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+        std::size_t occurrence = 0;
+        for (header_map::const_iterator before = lhs.begin(); before != it; ++before) {
+            if (before->hash == it->hash && names_equal(before->name, it->name)) {
+                ++occurrence;
+            }
+        }
+        header_map::const_iterator match = rhs.begin();
+        for (; match != rhs.end(); ++match) {
+            if (match->hash == it->hash && names_equal(match->name, it->name) && occurrence-- == 0) {
+                break;
+            }
+        }
+        if (match == rhs.end() || match->value != it->value) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -13,6 +13,7 @@ Date Created:
 */
 
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <boost/log/trivial.hpp>
@@ -28,15 +29,20 @@ health_request_handler* health_request_handler::Init(const std::string& location
 }
 
 Response health_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+Response health_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: health" ;
     BOOST_LOG_TRIVIAL(info) << "Health Request ok: success.";
     Response response;
 
     // Fill out the Response to be sent to the client.
     response.code_ = Response::ok;
-    response.body_ = "OK";
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/plain";
+    static const std::shared_ptr<const std::string> ok = std::make_shared<const std::string>("OK");
+    response.shared_body_ = ok;
+    response.headers_[header_id::content_length] = std::to_string(ok->size());
+    response.headers_[header_id::content_type] = "text/plain";
 
     return response;
 }
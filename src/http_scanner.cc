@@ -0,0 +1,330 @@
+/* http_scanner.cc
+Description:
+    Vectorized scans for the runs of token, URI and header value characters in a
+    request head, and for the bytes the URI decoder stops at.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCANNER_X86 1
+#endif
+
+#include "http_scanner.h"
+
+namespace {
+
+// Bits of char_classes.
+enum {
+    token_char = 1,
+    uri_char = 2,
+    value_char = 4
+};
+
+struct class_table {
+    unsigned char classes[256];
+
+    class_table() {
+        const char* tspecials = "()<>@,;:\\\"/[]?={} \t";
+        for (int c = 0; c < 256; ++c) {
+            bool ctl = c <= 31 || c == 127;
+            unsigned char bits = 0;
+            if (c <= 127 && !ctl && std::strchr(tspecials, c) == nullptr) {
+                bits |= token_char;
+            }
+            if (!ctl && c != ' ') {
+                bits |= uri_char;
+            }
+            if (!ctl) {
+                bits |= value_char;
+            }
+            classes[c] = bits;
+        }
+    }
+};
+
+const class_table char_classes;
+
+inline const char* scalar_find(const char* begin, const char* end, unsigned char bit) {
+    while (begin != end && (char_classes.classes[static_cast<unsigned char>(*begin)] & bit)) {
+        ++begin;
+    }
+    return begin;
+}
+
+const char* scalar_token_end(const char* begin, const char* end) {
+    return scalar_find(begin, end, token_char);
+}
+
+const char* scalar_uri_end(const char* begin, const char* end) {
+    return scalar_find(begin, end, uri_char);
+}
+
+const char* scalar_value_end(const char* begin, const char* end) {
+    return scalar_find(begin, end, value_char);
+}
+
+const char* scalar_either(const char* begin, const char* end, char a, char b) {
+    while (begin != end && *begin != a && *begin != b) {
+        ++begin;
+    }
+    return begin;
+}
+
+#ifdef HTTP_SCANNER_X86
+
+/* Token characters are found with two shuffles: row_bits[low nibble] has bit h set
+   when the byte (h << 4 | low nibble) is a token character, and column_bits[h] is
+   1 << h for h < 8, so their AND is non-zero exactly for token characters. Bytes
+   above 127 have a high nibble of 8 or more and an empty column. */
+struct token_nibbles {
+    alignas(32) unsigned char row_bits[32];
+    alignas(32) unsigned char column_bits[32];
+
+    token_nibbles() {
+        std::memset(row_bits, 0, sizeof(row_bits));
+        std::memset(column_bits, 0, sizeof(column_bits));
+        for (int c = 0; c < 128; ++c) {
+            if (char_classes.classes[c] & token_char) {
+                row_bits[c & 0x0f] |= 1 << (c >> 4);
+                row_bits[16 + (c & 0x0f)] |= 1 << (c >> 4);
+            }
+        }
+        for (int h = 0; h < 8; ++h) {
+            column_bits[h] = column_bits[16 + h] = 1 << h;
+        }
+    }
+};
+
+const token_nibbles nibbles;
+
+__attribute__((target("sse4.2")))
+const char* sse42_token_end(const char* begin, const char* end) {
+    const __m128i rows = _mm_load_si128(reinterpret_cast<const __m128i*>(nibbles.row_bits));
+    const __m128i columns = _mm_load_si128(reinterpret_cast<const __m128i*>(nibbles.column_bits));
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+    while (end - begin >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i row = _mm_shuffle_epi8(rows, _mm_and_si128(bytes, low_nibble));
+        __m128i column = _mm_shuffle_epi8(columns,
+                                          _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble));
+        __m128i outside = _mm_cmpeq_epi8(_mm_and_si128(row, column), _mm_setzero_si128());
+        int mask = _mm_movemask_epi8(outside);
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return scalar_token_end(begin, end);
+}
+
+/* A byte is a CTL when it is below 0x20 unsigned (min(byte, 0x1f) == byte) or DEL.
+   URIs also stop at SP, so there the bound is 0x20. */
+__attribute__((target("sse4.2")))
+inline const char* sse42_find_ctl(const char* begin, const char* end, char last_stop,
+                                  const char* (*tail)(const char*, const char*)) {
+    const __m128i bound = _mm_set1_epi8(last_stop);
+    const __m128i del = _mm_set1_epi8(127);
+    while (end - begin >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(bytes, bound), bytes),
+                                    _mm_cmpeq_epi8(bytes, del));
+        int mask = _mm_movemask_epi8(stop);
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return tail(begin, end);
+}
+
+__attribute__((target("sse4.2")))
+const char* sse42_uri_end(const char* begin, const char* end) {
+    return sse42_find_ctl(begin, end, ' ', scalar_uri_end);
+}
+
+__attribute__((target("sse4.2")))
+const char* sse42_value_end(const char* begin, const char* end) {
+    return sse42_find_ctl(begin, end, 0x1f, scalar_value_end);
+}
+
+__attribute__((target("sse4.2")))
+const char* sse42_either(const char* begin, const char* end, char a, char b) {
+    const __m128i first = _mm_set1_epi8(a);
+    const __m128i second = _mm_set1_epi8(b);
+    while (end - begin >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(bytes, first), _mm_cmpeq_epi8(bytes, second));
+        int mask = _mm_movemask_epi8(match);
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 16;
+    }
+    return scalar_either(begin, end, a, b);
+}
+
+__attribute__((target("avx2")))
+const char* avx2_token_end(const char* begin, const char* end) {
+    const __m256i rows = _mm256_load_si256(reinterpret_cast<const __m256i*>(nibbles.row_bits));
+    const __m256i columns = _mm256_load_si256(reinterpret_cast<const __m256i*>(nibbles.column_bits));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    while (end - begin >= 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i row = _mm256_shuffle_epi8(rows, _mm256_and_si256(bytes, low_nibble));
+        __m256i column = _mm256_shuffle_epi8(columns,
+                                             _mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble));
+        __m256i outside = _mm256_cmpeq_epi8(_mm256_and_si256(row, column), _mm256_setzero_si256());
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(outside));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return sse42_token_end(begin, end);
+}
+
+__attribute__((target("avx2")))
+inline const char* avx2_find_ctl(const char* begin, const char* end, char last_stop,
+                                 const char* (*tail)(const char*, const char*)) {
+    const __m256i bound = _mm256_set1_epi8(last_stop);
+    const __m256i del = _mm256_set1_epi8(127);
+    while (end - begin >= 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(bytes, bound), bytes),
+                                       _mm256_cmpeq_epi8(bytes, del));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stop));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return tail(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2_uri_end(const char* begin, const char* end) {
+    return avx2_find_ctl(begin, end, ' ', sse42_uri_end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2_value_end(const char* begin, const char* end) {
+    return avx2_find_ctl(begin, end, 0x1f, sse42_value_end);
+}
+
+__attribute__((target("avx2")))
+const char* avx2_either(const char* begin, const char* end, char a, char b) {
+    const __m256i first = _mm256_set1_epi8(a);
+    const __m256i second = _mm256_set1_epi8(b);
+    while (end - begin >= 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i match = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, first),
+                                        _mm256_cmpeq_epi8(bytes, second));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(match));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+        begin += 32;
+    }
+    return sse42_either(begin, end, a, b);
+}
+
+bool cpu_supports(http_scanner::level implementation) {
+    __builtin_cpu_init();
+    switch (implementation) {
+    case http_scanner::avx2:
+        return __builtin_cpu_supports("avx2");
+    case http_scanner::sse42:
+        return __builtin_cpu_supports("sse4.2");
+    default:
+        return true;
+    }
+}
+
+#else  // !HTTP_SCANNER_X86
+
+bool cpu_supports(http_scanner::level implementation) {
+    return implementation == http_scanner::scalar;
+}
+
+#endif  // HTTP_SCANNER_X86
+
+typedef const char* (*scan_function)(const char*, const char*);
+typedef const char* (*either_function)(const char*, const char*, char, char);
+
+struct implementation_table {
+    http_scanner::level level;
+    scan_function token_end;
+    scan_function uri_end;
+    scan_function value_end;
+    either_function either;
+};
+
+const implementation_table implementations[] = {
+    { http_scanner::scalar, scalar_token_end, scalar_uri_end, scalar_value_end, scalar_either },
+#ifdef HTTP_SCANNER_X86
+    { http_scanner::sse42, sse42_token_end, sse42_uri_end, sse42_value_end, sse42_either },
+    { http_scanner::avx2, avx2_token_end, avx2_uri_end, avx2_value_end, avx2_either },
+#endif
+};
+
+const implementation_table* best_implementation() {
+    const implementation_table* best = &implementations[0];
+    for (const implementation_table& candidate : implementations) {
+        if (cpu_supports(candidate.level)) {
+            best = &candidate;
+        }
+    }
+    return best;
+}
+
+const implementation_table* current = best_implementation();
+
+}  // namespace
+
+const char* http_scanner::find_token_end(const char* begin, const char* end) {
+    return current->token_end(begin, end);
+}
+
+const char* http_scanner::find_uri_end(const char* begin, const char* end) {
+    return current->uri_end(begin, end);
+}
+
+const char* http_scanner::find_value_end(const char* begin, const char* end) {
+    return current->value_end(begin, end);
+}
+
+const char* http_scanner::find_either(const char* begin, const char* end, char a, char b) {
+    return current->either(begin, end, a, b);
+}
+
+http_scanner::level http_scanner::active() {
+    return current->level;
+}
+
+/* bool http_scanner::use(level implementation)
+Parameter(s):
+    - implementation: scan implementation to switch to.
+Returns:
+    - bool which is true if the CPU supports it and it is now in use.
+Description:
+    - Not thread safe; meant to be called before any parsing starts. */
+bool http_scanner::use(level implementation) {
+    for (const implementation_table& candidate : implementations) {
+        if (candidate.level == implementation && cpu_supports(implementation)) {
+            current = &candidate;
+            return true;
+        }
+    }
+    return false;
+}
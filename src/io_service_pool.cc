@@ -0,0 +1,155 @@
+/* io_service_pool.cc
+Description:
+    Runs the io_services that serve sessions, one thread (optionally pinned to a CPU)
+    per io_service in sharded mode or a pool of threads sharing one io_service.
+
+Copyright (c) 2003-2017 Christopher M. Kohlhoff (chris at kohlhoff dot com)
+
+Distributed under the Boost Software License, Version 1.0. (See accompanying
+file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+Library Source adapted from https://www.boost.org/doc/libs/1_65_1/doc/html/boost_asio/example/cpp03/http/server2/io_service_pool.cpp
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/log/trivial.hpp>
+
+#include "io_service_pool.h"
+
+/* io_service_pool Constructor
+Parameter(s):
+    - pool_size: number of io_services to create.
+    - threads_per_io_service: number of threads that run each io_service.
+    - pin_threads: whether each thread is pinned to its own CPU.
+Description:
+    - Creates the io_services. Threads are only started by run(). */
+io_service_pool::io_service_pool(std::size_t pool_size, std::size_t threads_per_io_service, bool pin_threads)
+    : threads_per_io_service_(threads_per_io_service), pin_threads_(pin_threads) {
+    if (pool_size == 0 || threads_per_io_service == 0) {
+        throw std::runtime_error("io_service_pool size is 0");
+    }
+
+    for (std::size_t i = 0; i < pool_size; ++i) {
+        std::shared_ptr<boost::asio::io_service> io_service(new boost::asio::io_service(
+            // A sharded io_service is only ever run by one thread, so asio can skip its locking.
+            threads_per_io_service == 1 ? 1 : BOOST_ASIO_CONCURRENCY_HINT_DEFAULT));
+        std::shared_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(*io_service));
+        io_services_.push_back(io_service);
+        work_.push_back(work);
+    }
+}
+
+/* void io_service_pool::run()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Starts every thread, pinning thread i to the i-th available CPU if requested,
+    and waits for them all to exit. */
+void io_service_pool::run() {
+    std::vector<std::shared_ptr<boost::thread> > threads;
+    std::size_t thread_index = 0;
+    for (std::size_t i = 0; i < io_services_.size(); ++i) {
+        for (std::size_t j = 0; j < threads_per_io_service_; ++j, ++thread_index) {
+            boost::asio::io_service* io_service = io_services_[i].get();
+            bool pin = pin_threads_;
+            std::shared_ptr<boost::thread> thread(new boost::thread([io_service, pin, thread_index]() {
+                if (pin) {
+                    pin_to_cpu(thread_index);
+                }
+                io_service->run();
+            }));
+            threads.push_back(thread);
+        }
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Started " << threads.size() << " io thread(s) over "
+        << io_services_.size() << " io_service(s)" << (pin_threads_ ? ", pinned to CPUs" : "");
+
+    // Wait for all threads in the pool to exit.
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+    }
+}
+
+/* Stops all io_services, which makes run() return once their handlers finish. */
+void io_service_pool::stop() {
+    for (std::size_t i = 0; i < io_services_.size(); ++i) {
+        io_services_[i]->stop();
+    }
+}
+
+std::size_t io_service_pool::size() const {
+    return io_services_.size();
+}
+
+boost::asio::io_service& io_service_pool::get_io_service(std::size_t index) {
+    return *io_services_.at(index);
+}
+
+/* std::size_t io_service_pool::available_cpus()
+Parameter(s):
+    - N/A
+Returns:
+    - Number of CPUs in this process's affinity mask (at least 1).
+Description:
+    - Unlike hardware_concurrency(), honours taskset and cgroup cpusets, so "auto" does not
+    start more threads than the CPUs we are actually allowed to run on. */
+std::size_t io_service_pool::available_cpus() {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 0) {
+        return CPU_COUNT(&cpus);
+    }
+    unsigned int hardware_threads = boost::thread::hardware_concurrency();
+    return hardware_threads > 0 ? hardware_threads : 1;
+}
+
+/* void io_service_pool::pin_to_cpu(std::size_t thread_index)
+Parameter(s):
+    - thread_index: index of the calling io thread.
+Returns:
+    - N/A
+Description:
+    - Pins the calling thread to the (thread_index mod n)-th CPU of the process affinity mask.
+    Failure is logged and the thread keeps running unpinned. */
+void io_service_pool::pin_to_cpu(std::size_t thread_index) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0) {
+        BOOST_LOG_TRIVIAL(error) << "Could not read CPU affinity, io thread " << thread_index << " is not pinned";
+        return;
+    }
+
+    std::size_t target = thread_index % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        if (target-- == 0) {
+            cpu_set_t pinned;
+            CPU_ZERO(&pinned);
+            CPU_SET(cpu, &pinned);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) != 0) {
+                BOOST_LOG_TRIVIAL(error) << "Could not pin io thread " << thread_index << " to CPU " << cpu;
+            } else {
+                BOOST_LOG_TRIVIAL(info) << "Pinned io thread " << thread_index << " to CPU " << cpu;
+            }
+            return;
+        }
+    }
+}
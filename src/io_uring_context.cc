@@ -0,0 +1,468 @@
+/* io_uring_context.cc
+Description:
+    Submission and completion rings of the optional io_uring transport, driven from an
+    io_service through a registered eventfd. Talks to the kernel through the raw system
+    calls, so it needs no library beyond the kernel headers.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include "io_uring_context.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/log/trivial.hpp>
+
+#ifdef WEBSERVER_HAS_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Read buffers come from this group, the only one a context registers.
+const std::uint16_t buffer_group = 0;
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                                      flags, nullptr, 0));
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+void throw_errno(const char* what) {
+    throw boost::system::system_error(errno, boost::system::system_category(), what);
+}
+
+}  // namespace
+
+/* bool io_uring_context::supported()
+Parameter(s):
+    - N/A
+Returns:
+    - true if a context can be created in this process.
+Description:
+    - Sets up a throwaway context once and remembers the answer. Multishot accept and
+    provided buffer rings arrived together (Linux 5.19), so registering the buffer ring
+    stands in for both. */
+bool io_uring_context::supported() {
+    static const bool result = [] {
+        try {
+            boost::asio::io_service io_service;
+            io_uring_context probe(io_service, false);
+            return true;
+        } catch (boost::system::system_error& e) {
+            BOOST_LOG_TRIVIAL(warning) << "io_uring is not available: " << e.what();
+            return false;
+        }
+    }();
+    return result;
+}
+
+bool io_uring_context::more_completions(unsigned flags) {
+    return flags & IORING_CQE_F_MORE;
+}
+
+/* io_uring_context Constructor
+Parameter(s):
+    - io_service: io_service whose reactor watches the completion eventfd, and that runs
+    the completion handlers.
+    - post_completions: whether completions are posted as separate handlers, so that
+    several threads sharing io_service can run them, or called straight from the reap.
+Description:
+    - Creates the ring, maps its queues, registers an eventfd for completions and a ring
+    of buffer_count provided buffers for reads. */
+io_uring_context::io_uring_context(boost::asio::io_service& io_service, bool post_completions)
+    : io_service_(io_service), post_completions_(post_completions), ring_fd_(-1),
+      event_fd_(io_service), event_count_(0), flush_pending_(false), to_submit_(0),
+      submit_calls_(0), sq_ring_(MAP_FAILED), sq_ring_size_(0), cq_ring_(MAP_FAILED),
+      sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)), sqes_size_(0),
+      buffer_ring_(static_cast<io_uring_buf*>(MAP_FAILED)), buffer_ring_size_(0),
+      buffer_tail_(0) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = 4 * queue_entries;
+    ring_fd_ = io_uring_setup(queue_entries, &params);
+    if (ring_fd_ < 0) {
+        throw_errno("io_uring_setup");
+    }
+    try {
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP)) {
+            errno = ENOSYS;
+            throw_errno("io_uring features");
+        }
+
+        // The submission and completion rings share one mapping.
+        sq_ring_size_ = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            throw_errno("mmap submission ring");
+        }
+        cq_ring_ = sq_ring_;
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            throw_errno("mmap submission entries");
+        }
+
+        char* sq = static_cast<char*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        sq_flags_ = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+        unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; ++i) {
+            sq_array[i] = i;
+        }
+        char* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        int event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (event_fd < 0) {
+            throw_errno("eventfd");
+        }
+        event_fd_.assign(event_fd);
+        if (io_uring_register(ring_fd_, IORING_REGISTER_EVENTFD, &event_fd, 1) < 0) {
+            throw_errno("io_uring_register eventfd");
+        }
+
+        buffer_ring_size_ = buffer_count * sizeof(io_uring_buf);
+        buffer_ring_ = static_cast<io_uring_buf*>(::mmap(nullptr, buffer_ring_size_,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buffer_ring_ == MAP_FAILED) {
+            throw_errno("mmap buffer ring");
+        }
+        io_uring_buf_reg buffer_registration;
+        std::memset(&buffer_registration, 0, sizeof(buffer_registration));
+        buffer_registration.ring_addr = reinterpret_cast<std::uintptr_t>(buffer_ring_);
+        buffer_registration.ring_entries = buffer_count;
+        buffer_registration.bgid = buffer_group;
+        if (io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &buffer_registration, 1) < 0) {
+            throw_errno("io_uring_register buffer ring");
+        }
+        buffers_.resize(buffer_count * buffer_size);
+        for (unsigned bid = 0; bid < buffer_count; ++bid) {
+            recycle_buffer(IORING_CQE_F_BUFFER | (bid << IORING_CQE_BUFFER_SHIFT));
+        }
+    } catch (...) {
+        release_ring();
+        throw;
+    }
+
+    wait_for_completions();
+}
+
+io_uring_context::~io_uring_context() {
+    release_ring();
+}
+
+void io_uring_context::release_ring() {
+    boost::system::error_code ignored_ec;
+    event_fd_.close(ignored_ec);
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+    if (buffer_ring_ != MAP_FAILED) {
+        ::munmap(buffer_ring_, buffer_ring_size_);
+        buffer_ring_ = static_cast<io_uring_buf*>(MAP_FAILED);
+    }
+    if (sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqes_size_);
+        sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+        ::munmap(sq_ring_, sq_ring_size_);
+        sq_ring_ = cq_ring_ = MAP_FAILED;
+    }
+}
+
+/* void io_uring_context::async_accept(int listen_fd, int flags, bool multishot, operation& op)
+Parameter(s):
+    - listen_fd: listening socket.
+    - flags: accept4 flags for the new sockets.
+    - multishot: keep accepting until cancelled or an error, instead of once.
+    - op: completes with the new socket's fd.
+Returns:
+    - N/A
+Description:
+    - The peer address is not asked for: with a multishot accept every completion would
+    share one address buffer. */
+void io_uring_context::async_accept(int listen_fd, int flags, bool multishot, operation& op) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_uring_sqe* sqe = get_sqe(1);
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->accept_flags = flags;
+    if (multishot) {
+        sqe->ioprio |= IORING_ACCEPT_MULTISHOT;
+    }
+    sqe->user_data = reinterpret_cast<std::uintptr_t>(&op);
+    schedule_flush();
+}
+
+/* void io_uring_context::async_recv(int fd, operation& op)
+Parameter(s):
+    - fd: connected socket.
+    - op: completes with the bytes received, 0 at EOF.
+Returns:
+    - N/A
+Description:
+    - The kernel picks a free provided buffer only once data has arrived, so a connection
+    waiting for its next request holds no buffer. */
+void io_uring_context::async_recv(int fd, operation& op) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_uring_sqe* sqe = get_sqe(1);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group;
+    sqe->user_data = reinterpret_cast<std::uintptr_t>(&op);
+    schedule_flush();
+}
+
+/* void io_uring_context::async_sendmsg(int fd, const msghdr* msg, bool shutdown_after,
+                                        operation& op)
+Parameter(s):
+    - fd: connected socket.
+    - msg: gathered buffers to send, which must stay alive until op completes.
+    - shutdown_after: send FIN once everything is sent.
+    - op: completes with the bytes sent.
+Returns:
+    - N/A
+Description:
+    - MSG_WAITALL makes the kernel retry a short send itself. The shutdown is linked behind
+    the send, so it runs only if the send sent everything and costs no extra submission. */
+void io_uring_context::async_sendmsg(int fd, const msghdr* msg, bool shutdown_after, operation& op) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_uring_sqe* sqe = get_sqe(shutdown_after ? 2 : 1);
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = reinterpret_cast<std::uintptr_t>(&op);
+    if (shutdown_after) {
+        sqe->flags |= IOSQE_IO_LINK;
+        io_uring_sqe* shutdown_sqe = get_sqe(1);
+        shutdown_sqe->opcode = IORING_OP_SHUTDOWN;
+        shutdown_sqe->fd = fd;
+        shutdown_sqe->len = SHUT_WR;
+        shutdown_sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        shutdown_sqe->user_data = 0;
+    }
+    schedule_flush();
+}
+
+void io_uring_context::async_cancel(operation& op) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_uring_sqe* sqe = get_sqe(1);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(&op);
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = 0;
+    schedule_flush();
+}
+
+const char* io_uring_context::buffer(unsigned flags) const {
+    return buffers_.data() + (flags >> IORING_CQE_BUFFER_SHIFT) * buffer_size;
+}
+
+/* void io_uring_context::recycle_buffer(unsigned flags)
+Parameter(s):
+    - flags: completion flags of the read.
+Returns:
+    - N/A
+Description:
+    - Appends the buffer to the provided buffer ring; the kernel sees it once the ring's
+    tail is published. The ring is indexed as a plain io_uring_buf array: in C++ the
+    kernel header's flexible array member in io_uring_buf_ring does not start at offset 0.
+    The tail lives in the resv field of the first entry, which is never written here. */
+void io_uring_context::recycle_buffer(unsigned flags) {
+    if (!(flags & IORING_CQE_F_BUFFER)) {
+        return;
+    }
+    std::uint16_t bid = static_cast<std::uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_uring_buf* entry = &buffer_ring_[buffer_tail_ & (buffer_count - 1)];
+    entry->addr = reinterpret_cast<std::uintptr_t>(buffers_.data() + bid * buffer_size);
+    entry->len = buffer_size;
+    entry->bid = bid;
+    ++buffer_tail_;
+    __atomic_store_n(&buffer_ring_[0].resv, buffer_tail_, __ATOMIC_RELEASE);
+}
+
+/* io_uring_sqe* io_uring_context::get_sqe(unsigned count)
+Parameter(s):
+    - count: entries the caller is about to queue back to back (linked entries must go in
+    the same submission).
+Returns:
+    - the next free submission entry, zeroed.
+Description:
+    - Called with mutex_ held. Submits what is queued first if fewer than count entries
+    are free. */
+io_uring_sqe* io_uring_context::get_sqe(unsigned count) {
+    unsigned tail = *sq_tail_;
+    while (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) + count > sq_entries_) {
+        submit_locked();
+    }
+    io_uring_sqe* sqe = &sqes_[tail & sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++to_submit_;
+    return sqe;
+}
+
+/* void io_uring_context::schedule_flush()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Called with mutex_ held. The first entry queued since the last submission posts a
+    flush, which runs after the handlers already queued on the io_service, so everything
+    they queue goes out with the same io_uring_enter. */
+void io_uring_context::schedule_flush() {
+    if (!flush_pending_) {
+        flush_pending_ = true;
+        io_service_.post(boost::bind(&io_uring_context::flush, this));
+    }
+}
+
+void io_uring_context::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_pending_ = false;
+    submit_locked();
+}
+
+void io_uring_context::submit_locked() {
+    while (to_submit_ > 0) {
+        int submitted = io_uring_enter(ring_fd_, to_submit_, 0, 0);
+        submit_calls_.fetch_add(1, std::memory_order_relaxed);
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EBUSY || errno == EAGAIN) {
+                // Completions are backed up; reaping them lets the submission through.
+                io_uring_enter(ring_fd_, 0, 0, IORING_ENTER_GETEVENTS);
+                continue;
+            }
+            BOOST_LOG_TRIVIAL(error) << "io_uring_enter failed: " << std::strerror(errno);
+            return;
+        }
+        to_submit_ -= submitted;
+    }
+}
+
+void io_uring_context::wait_for_completions() {
+    event_fd_.async_read_some(boost::asio::buffer(&event_count_, sizeof(event_count_)),
+                              boost::bind(&io_uring_context::handle_completions, this,
+                              boost::asio::placeholders::error));
+}
+
+void io_uring_context::handle_completions(const boost::system::error_code& error) {
+    if (error == boost::asio::error::operation_aborted) {
+        return;
+    }
+    reap();
+    wait_for_completions();
+}
+
+/* void io_uring_context::reap()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Runs the handler of every completion in the queue, including any that overflowed
+    into the kernel, then submits what those handlers queued right away rather than
+    waiting for the posted flush. Entries without an operation (linked shutdowns and
+    cancels) are dropped. Only one reap runs at a time, since there is only ever one
+    wait on the eventfd. */
+void io_uring_context::reap() {
+    for (;;) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (__atomic_load_n(sq_flags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+                io_uring_enter(ring_fd_, 0, 0, IORING_ENTER_GETEVENTS);
+                continue;
+            }
+            break;
+        }
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            operation* op = reinterpret_cast<operation*>(cqe.user_data);
+            int result = cqe.res;
+            unsigned flags = cqe.flags;
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            if (op == nullptr) {
+                continue;
+            }
+            if (post_completions_) {
+                io_service_.post(boost::bind(&io_uring_context::complete, op, result, flags));
+            } else {
+                complete(op, result, flags);
+            }
+        }
+    }
+    flush();
+}
+
+void io_uring_context::complete(operation* op, int result, unsigned flags) {
+    op->on_complete(result, flags);
+}
+
+#else  // !WEBSERVER_HAS_IO_URING
+
+bool io_uring_context::supported() {
+    return false;
+}
+
+bool io_uring_context::more_completions(unsigned) {
+    return false;
+}
+
+io_uring_context::io_uring_context(boost::asio::io_service& io_service, bool post_completions)
+    : io_service_(io_service), post_completions_(post_completions), ring_fd_(-1),
+      event_fd_(io_service) {
+    throw boost::system::system_error(boost::asio::error::operation_not_supported,
+                                      "webserver was built without io_uring");
+}
+
+io_uring_context::~io_uring_context() {}
+void io_uring_context::async_accept(int, int, bool, operation&) {}
+void io_uring_context::async_recv(int, operation&) {}
+void io_uring_context::async_sendmsg(int, const msghdr*, bool, operation&) {}
+void io_uring_context::async_cancel(operation&) {}
+const char* io_uring_context::buffer(unsigned) const { return nullptr; }
+void io_uring_context::recycle_buffer(unsigned) {}
+
+#endif  // WEBSERVER_HAS_IO_URING
@@ -0,0 +1,238 @@
+/* listener_handoff.cc
+Description:
+    Hands the listening sockets of a running webserver to the binary it upgrades to.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <boost/log/trivial.hpp>
+
+#include "listener_handoff.h"
+
+const char* const listener_handoff::listen_fds_env = "WEBSERVER_LISTEN_FDS";
+const char* const listener_handoff::ready_fd_env = "WEBSERVER_READY_FD";
+
+/* static int parse_fd(const std::string& value)
+Parameter(s):
+    - value: decimal fd number.
+Returns:
+    - the fd if value names an open descriptor, otherwise -1.
+Description:
+    - Marks the fd close-on-exec again so it does not leak into later children. */
+static int parse_fd(const std::string& value) {
+    char* end = nullptr;
+    long fd = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || fd < 0 || fd > INT32_MAX) {
+        return -1;
+    }
+    int flags = ::fcntl(static_cast<int>(fd), F_GETFD);
+    if (flags == -1) {
+        return -1;
+    }
+    ::fcntl(static_cast<int>(fd), F_SETFD, flags | FD_CLOEXEC);
+    return static_cast<int>(fd);
+}
+
+/* listener_handoff Constructor
+Description:
+    - Reads the fds a parent left in listen_fds_env and ready_fd_env, then clears both so
+    they are not mistaken for this process's own handoff later. Anything that is not an
+    open listening socket is ignored. */
+listener_handoff::listener_handoff() : ready_fd_(-1) {
+    const char* listen_fds = std::getenv(listen_fds_env);
+    if (listen_fds != nullptr) {
+        std::string value(listen_fds);
+        std::size_t start = 0;
+        while (start <= value.size()) {
+            std::size_t comma = std::min(value.find(',', start), value.size());
+            int fd = parse_fd(value.substr(start, comma - start));
+            int listening = 0;
+            socklen_t len = sizeof(listening);
+            if (fd >= 0 && ::getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &len) == 0 &&
+                listening) {
+                fds_.push_back(fd);
+            } else {
+                BOOST_LOG_TRIVIAL(warning) << "Ignoring inherited fd \""
+                    << value.substr(start, comma - start) << "\", it is not a listening socket";
+            }
+            start = comma + 1;
+        }
+        ::unsetenv(listen_fds_env);
+    }
+
+    const char* ready_fd = std::getenv(ready_fd_env);
+    if (ready_fd != nullptr) {
+        ready_fd_ = parse_fd(ready_fd);
+        ::unsetenv(ready_fd_env);
+    }
+}
+
+listener_handoff::~listener_handoff() {
+    close_untaken();
+    // The old process reads EOF without a byte as a failed upgrade.
+    if (ready_fd_ >= 0) {
+        ::close(ready_fd_);
+    }
+}
+
+/* bool listener_handoff::inherited() const
+Parameter(s):
+    - N/A
+Returns:
+    - true if this process was started with listening fds from an older one.
+Description:
+    - N/A */
+bool listener_handoff::inherited() const {
+    return !fds_.empty();
+}
+
+/* int listener_handoff::take(std::size_t index, int port)
+Parameter(s):
+    - index: which server of the old process the fd belonged to.
+    - port: port this process is configured to listen on.
+Returns:
+    - the listening fd, now owned by the caller, or -1 to open a new socket.
+Description:
+    - A socket bound to another port (the config changed) is left for notify_ready() to
+    close. */
+int listener_handoff::take(std::size_t index, int port) {
+    if (index >= fds_.size() || fds_[index] < 0) {
+        return -1;
+    }
+    sockaddr_in address;
+    socklen_t len = sizeof(address);
+    std::memset(&address, 0, sizeof(address));
+    if (::getsockname(fds_[index], reinterpret_cast<sockaddr*>(&address), &len) != 0 ||
+        address.sin_family != AF_INET || ntohs(address.sin_port) != port) {
+        BOOST_LOG_TRIVIAL(warning) << "Inherited fd " << fds_[index]
+            << " does not listen on port " << port << ", opening a new socket";
+        return -1;
+    }
+    int fd = fds_[index];
+    fds_[index] = -1;
+    return fd;
+}
+
+/* void listener_handoff::notify_ready()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Called once every server holds its acceptor. Connections already queued on a listening
+    socket closed here are reset, which only happens when this process runs fewer servers
+    than the old one. */
+void listener_handoff::notify_ready() {
+    close_untaken();
+    if (ready_fd_ >= 0) {
+        char ready = 1;
+        if (::write(ready_fd_, &ready, 1) != 1) {
+            BOOST_LOG_TRIVIAL(warning) << "Could not tell the old process to drain: "
+                << std::strerror(errno);
+        }
+        ::close(ready_fd_);
+        ready_fd_ = -1;
+    }
+}
+
+void listener_handoff::close_untaken() {
+    for (std::size_t i = 0; i < fds_.size(); ++i) {
+        if (fds_[i] >= 0) {
+            BOOST_LOG_TRIVIAL(warning) << "Closing unused inherited listening fd " << fds_[i];
+            ::close(fds_[i]);
+            fds_[i] = -1;
+        }
+    }
+}
+
+/* pid_t listener_handoff::spawn(char* const argv[], const std::vector<int>& listen_fds,
+                                 int* ready_fd)
+Parameter(s):
+    - argv: command line of the new process, argv[0] is looked up in PATH.
+    - listen_fds: listening sockets to hand over, in server order.
+    - ready_fd: receives the read end of the readiness pipe.
+Returns:
+    - pid of the new process, or -1 if it could not be started.
+Description:
+    - Everything the child needs is built before fork(), since a forked multithreaded
+    process may only make async-signal-safe calls before exec. The child keeps stdio, the
+    listening fds and the pipe and closes every other descriptor, so the old process's
+    connections are not held open by the new one. */
+pid_t listener_handoff::spawn(char* const argv[], const std::vector<int>& listen_fds,
+                              int* ready_fd) {
+    int ready_pipe[2];
+    if (::pipe2(ready_pipe, O_CLOEXEC) != 0) {
+        return -1;
+    }
+
+    std::string fds_value;
+    for (std::size_t i = 0; i < listen_fds.size(); ++i) {
+        fds_value += (i == 0 ? "" : ",") + std::to_string(listen_fds[i]);
+    }
+    std::string listen_prefix = std::string(listen_fds_env) + "=";
+    std::string ready_prefix = std::string(ready_fd_env) + "=";
+    std::vector<std::string> env_strings;
+    for (char** entry = environ; *entry != nullptr; ++entry) {
+        if (std::strncmp(*entry, listen_prefix.c_str(), listen_prefix.size()) != 0 &&
+            std::strncmp(*entry, ready_prefix.c_str(), ready_prefix.size()) != 0) {
+            env_strings.push_back(*entry);
+        }
+    }
+    env_strings.push_back(listen_prefix + fds_value);
+    env_strings.push_back(ready_prefix + std::to_string(ready_pipe[1]));
+    std::vector<char*> envp;
+    for (std::size_t i = 0; i < env_strings.size(); ++i) {
+        envp.push_back(&env_strings[i][0]);
+    }
+    envp.push_back(nullptr);
+
+    rlimit fd_limit;
+    int max_fd = ::getrlimit(RLIMIT_NOFILE, &fd_limit) == 0 && fd_limit.rlim_cur != RLIM_INFINITY ?
+        static_cast<int>(std::min<rlim_t>(fd_limit.rlim_cur, INT32_MAX)) : 65536;
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        for (int fd = STDERR_FILENO + 1; fd < max_fd; ++fd) {
+            bool keep = fd == ready_pipe[1];
+            for (std::size_t i = 0; i < listen_fds.size() && !keep; ++i) {
+                keep = fd == listen_fds[i];
+            }
+            if (keep) {
+                ::fcntl(fd, F_SETFD, 0);
+            } else {
+                ::close(fd);
+            }
+        }
+        ::execvpe(argv[0], argv, envp.data());
+        ::_exit(127);
+    }
+
+    ::close(ready_pipe[1]);
+    if (pid < 0) {
+        ::close(ready_pipe[0]);
+        return -1;
+    }
+    *ready_fd = ready_pipe[0];
+    return pid;
+}
@@ -22,7 +22,10 @@ Date Created:
 #include <boost/iostreams/copy.hpp>
 #include <libxml2/libxml/HTMLtree.h>
 #include <algorithm>
+#include <array>
+#include <cstdio>
 
+#include "http_tokens.h"
 #include "response_parser.h"
 #include "response_builder.h"
 #include "proxy_request_handler.h"
@@ -33,6 +36,68 @@ Date Created:
 using namespace boost::asio;
 using namespace boost::iostreams;
 
+/* Forwards a request body to the remote server as it arrives, so an upload of any size
+   passes through in constant memory. The connection to the remote server blocks like the
+   rest of this handler, and that is what pushes back on the client: the session reads no
+   more of the body until the remote server has taken what it was given. A chunked body
+   reaches us decoded, so it is chunked again on the way out, one chunk per piece. */
+class proxy_request_handler::upload_stream : public body_consumer {
+ public:
+    upload_stream(proxy_request_handler* handler, bool chunked)
+        : handler_(handler), socket_(io_service_), chunked_(chunked), failed_(false) {}
+
+    // Connect to the remote server and send it the request head.
+    void start(const std::string& head) {
+        boost::system::error_code ec;
+        ip::tcp::resolver resolver(io_service_);
+        ip::tcp::resolver::query query(handler_->server_url_,
+                                       std::to_string(handler_->server_port_num));
+        connect(socket_, resolver.resolve(query, ec), ec);
+        if (!ec) {
+            write(socket_, buffer(head.data(), head.size()), ec);
+        }
+        failed_ = static_cast<bool>(ec);
+    }
+
+    void on_data(const char* data, std::size_t size) override {
+        if (failed_) {
+            return;
+        }
+        boost::system::error_code ec;
+        if (chunked_) {
+            char size_line[24];
+            int length = snprintf(size_line, sizeof(size_line), "%zx\r\n", size);
+            std::array<const_buffer, 3> chunk = {
+                buffer(size_line, length), buffer(data, size), buffer("\r\n", 2) };
+            write(socket_, chunk, ec);
+        } else {
+            write(socket_, buffer(data, size), ec);
+        }
+        failed_ = static_cast<bool>(ec);
+    }
+
+    // A redirect is passed on to the client as is, since the body cannot be sent again.
+    Response on_complete() override {
+        if (chunked_ && !failed_) {
+            boost::system::error_code ec;
+            write(socket_, buffer("0\r\n\r\n", 5), ec);
+            failed_ = static_cast<bool>(ec);
+        }
+        Response response;
+        if (failed_ || !handler_->read_response(socket_, response)) {
+            return handler_->get_error_response();
+        }
+        return handler_->finish_response(response);
+    }
+
+ private:
+    proxy_request_handler* handler_;
+    io_service io_service_;
+    ip::tcp::socket socket_;
+    bool chunked_;
+    bool failed_;
+};
+
 /* proxy_request_handler* Init(const std::string& location_path, const NginxConfig& config)
 Parameter(s):
     - location_path: path provided in config file which corresponds to handler
@@ -74,22 +139,9 @@ Description:
     - Converts given request into a string */
 std::string proxy_request_handler::build_request_string(const Request& request) {
     std::string request_string;
-    if (request.method_ == Request::MethodEnum::GET) {
-        request_string += "GET ";
-    } else if (request.method_ == Request::MethodEnum::POST) {
-        request_string += "POST ";
-    } else if (request.method_ == Request::MethodEnum::DELETE) {
-        request_string += "DELETE ";
-    } else if (request.method_ == Request::MethodEnum::HEAD) {
-        request_string += "HEAD ";
-    } else if (request.method_ == Request::MethodEnum::PUT) {
-        request_string += "PUT ";
-    } else if (request.method_ == Request::MethodEnum::CONNECT) {
-        request_string += "CONNECT ";
-    } else if (request.method_ == Request::MethodEnum::OPTIONS) {
-        request_string += "OPTIONS ";
-    } else if (request.method_ == Request::MethodEnum::TRACE) {
-        request_string += "TRACE ";
+    if (static_cast<unsigned>(request.method_) <= Request::MethodEnum::TRACE) {
+        request_string += http_tokens::methods[request.method_];
+        request_string += " ";
     }
 
     request_string += request.uri_;
@@ -97,9 +149,8 @@ std::string proxy_request_handler::build_request_string(const Request& request)
     request_string += request.version_;
     request_string += "\r\n";
 
-    for (const auto& pair : request.headers_) {
-        std::string new_headerline = pair.first + ": " + pair.second + "\r\n";
-        request_string += new_headerline;
+    for (const header_entry& header : request.headers_) {
+        request_string += header.name + ": " + header.value + "\r\n";
     }
     request_string += "\r\n";
 
@@ -107,6 +158,41 @@ std::string proxy_request_handler::build_request_string(const Request& request)
     return request_string;
 }
 
+/* std::string build_request_head(const RequestView& head, const std::string& uri)
+Parameter(s):
+    - head: head of the request to forward
+    - uri: URI to send the forwarded request to
+Returns:
+    - The head of the forwarded request, up to and including the empty line.
+Description:
+    - Like build_request_string, but keeps the client's headers in the order they came
+    in and leaves the body to be sent after it. Expect is dropped, since the session
+    has already answered it and the body follows the head without waiting */
+std::string proxy_request_handler::build_request_head(const RequestView& head, const std::string& uri) {
+    std::string request_string;
+    request_string.append(head.method_name_.data(), head.method_name_.size());
+    request_string += " ";
+    request_string += uri;
+    request_string += " ";
+    request_string.append(head.version_.data(), head.version_.size());
+    request_string += "\r\n";
+
+    for (const header_view& header : head.headers_) {
+        header_id id = lookup_header_id(header.name);
+        if (id == header_id::host || id == header_id::accept_encoding || id == header_id::expect) {
+            continue;
+        }
+        request_string.append(header.name.data(), header.name.size());
+        request_string += ": ";
+        request_string.append(header.value.data(), header.value.size());
+        request_string += "\r\n";
+    }
+    request_string += "Host: " + server_url_ + ":" + std::to_string(server_port_num) + "\r\n";
+    request_string += "Accept-Encoding: gzip, identity\r\n";
+    request_string += "\r\n";
+    return request_string;
+}
+
 /* void handle_property(xmlNode *node, const char *property)
 Parameter(s):
     - node: xml node to process
@@ -231,18 +317,18 @@ Description:
     - Creates a response object with an HTML body such that the links
        correspond correctly to the proxy server instead of the remote server */
 Response proxy_request_handler::handle_html(Response& response) {
-    std::string htmlContent = response.body_;
+    std::string htmlContent = std::move(response.body_);
 
     // If The content encoding is gzip, decompress it
-    if (response.headers_.find("Content-Encoding") != response.headers_.end()) {
-        std::string contentEncoding = response.headers_["Content-Encoding"];
+    if (response.headers_.find(header_id::content_encoding) != response.headers_.end()) {
+        std::string contentEncoding = response.headers_[header_id::content_encoding];
         if (contentEncoding.find("gzip") != std::string::npos) {
             htmlContent = decompress_gzip(htmlContent);
         }
 
         // Mark the response as being no encoding since we arent going to
         //  recompress it
-        response.headers_["Content-Encoding"] = "identity";
+        response.headers_[header_id::content_encoding] = "identity";
     }
 
     // Parse the html document
@@ -264,12 +350,12 @@ Response proxy_request_handler::handle_html(Response& response) {
     xmlFree(xmlString);
     xmlFree(htmlDoc);
 
-    // Set the body
-    response.body_ = htmlContent;
     // Make sure the encoding is set correctly
-    response.headers_["Transfer-Encoding"] = "identity";
+    response.headers_[header_id::transfer_encoding] = "identity";
     // Set the content length to the length of the HTML document
-    response.headers_["Content-Length"] = std::to_string(htmlContent.length());
+    response.headers_[header_id::content_length] = std::to_string(htmlContent.length());
+    // Set the body
+    response.body_ = std::move(htmlContent);
     return response;
 }
 
@@ -281,9 +367,9 @@ Description:
 Response proxy_request_handler::get_error_response() {
     Response response;
     response.code_ = Response::bad_gateway;
-    response.body_ = stock_responses::bad_gateway;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/html";
+    response.shared_body_ = ResponseHelperLibrary::stock_body(Response::bad_gateway);
+    response.headers_[header_id::content_length] = std::to_string(response.shared_body_->size());
+    response.headers_[header_id::content_type] = "text/html";
 
     return response;
 }
@@ -313,12 +399,19 @@ Response proxy_request_handler::proxy_request(const Request& request, std::strin
     proxyRequest.version_ = request.version_;
     proxyRequest.body_ = request.body_;
     proxyRequest.headers_ = request.headers_;
+    // A chunked body has already been decoded, so send it with its length instead
+    if (proxyRequest.headers_.erase("Transfer-Encoding") > 0) {
+        proxyRequest.headers_[header_id::content_length] = std::to_string(request.body_.size());
+    }
+    // The client's expectation was answered by our session, and the body goes out with
+    // the head, so the upstream must not answer with a 100 Continue of its own.
+    proxyRequest.headers_.erase("Expect");
     // Set host url and port correctly
-    proxyRequest.headers_["Host"] = url + ":" + portString;
+    proxyRequest.headers_[header_id::host] = url + ":" + portString;
     // We can only handle respoonses with either gzip or no encoding
     //  We must set the HTTP Header to only accept information types our server
     //  can handle
-    proxyRequest.headers_["Accept-Encoding"] = "gzip, identity";
+    proxyRequest.headers_[header_id::accept_encoding] = "gzip, identity";
 
     streambuf responseStatusLineBuffer;
 
@@ -343,7 +436,7 @@ Response proxy_request_handler::proxy_request(const Request& request, std::strin
     // Check if response is a redirect
     if (response.code_ == Response::moved_temporarily
         || response.code_ == Response::moved_permanently) {
-        std::string redirectLocation = response.headers_["Location"];
+        std::string redirectLocation = response.headers_[header_id::location];
         int newPort = HTTP_DEFAULT_PORT;
 
         // Check if it is an absolute or relative path
@@ -384,9 +477,18 @@ Response proxy_request_handler::proxy_request(const Request& request, std::strin
         return proxy_request(request, uri, redirectLocation, newPort);
     }
 
-    // If the content type is HTML, modify the HTML to work as a proxy
-    //  effectively
-    std::string contentType = response.headers_["Content-Type"];
+    return finish_response(response);
+}
+
+/* Response finish_response(Response& response)
+Parameter(s):
+    - response: response from the remote server
+Returns:
+    - The response to send back to the client
+Description:
+    - If the content type is HTML, modifies the HTML to work as a proxy effectively */
+Response proxy_request_handler::finish_response(Response& response) {
+    std::string contentType = response.headers_[header_id::content_type];
     if (contentType.find("text/html") != std::string::npos) {
         response = handle_html(response);
     }
@@ -394,6 +496,23 @@ Response proxy_request_handler::proxy_request(const Request& request, std::strin
     return response;
 }
 
+/* std::string upstream_uri(std::string_view request_uri)
+Parameter(s):
+    - request_uri: URI the client asked for
+Returns:
+    - The URI to ask the remote server for
+Description:
+    - The new URI will be the URI given here, after the location path, + the server path */
+std::string proxy_request_handler::upstream_uri(std::string_view request_uri) {
+    std::string uri = server_location_path_;
+    uri.append(request_uri.substr(std::min(client_location_path_.length(), request_uri.size())));
+    // Make sure to have a URI if both uri and server_location_path_ are empty
+    if (uri.empty()) {
+        uri = "/";
+    }
+    return uri;
+}
+
 /*  Response proxy_request_handler::handle_request(const request& request)
 Parameter(s):
     - request: Request object (see request.h)
@@ -404,13 +523,24 @@ Description:
     and return the response. Also handles HTTP 302 Redirect. */
 Response proxy_request_handler::handle_request(const Request& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: proxy" ;
-    // Get the URI, the new URI will be the URI given here + the server path
-    std::string uri = request.uri_.substr(client_location_path_.length());
-    uri = server_location_path_ + uri;
-    // Make sure to have a URI if both uri and server_location_path_ are empty
-    if (uri.empty()) {
-        uri = "/";
-    }
+    return proxy_request(request, upstream_uri(request.uri_), server_url_, server_port_num);
+}
 
-    return proxy_request(request, uri, server_url_, server_port_num);
+/*  std::unique_ptr<body_consumer> proxy_request_handler::start_body_stream(const RequestView& head)
+Parameter(s):
+    - head: head of a request with a body (see request_view.h)
+Returns:
+    - Consumer that forwards the body (see request_handler.h)
+Description:
+    - Sends the head to the remote server right away and the body after it as it arrives,
+    instead of buffering the whole upload first. */
+std::unique_ptr<body_consumer> proxy_request_handler::start_body_stream(const RequestView& head) {
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: proxy" ;
+    std::string uri = upstream_uri(head.uri_);
+    BOOST_LOG_TRIVIAL(info) << "Streaming request body to URL " << server_url_
+        << " at port " << server_port_num << " with URI " << uri;
+    bool chunked = !head.header("Transfer-Encoding").empty();
+    std::unique_ptr<upload_stream> stream(new upload_stream(this, chunked));
+    stream->start(build_request_head(head, uri));
+    return std::move(stream);
 }
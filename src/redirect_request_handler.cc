@@ -29,16 +29,20 @@ redirect_request_handler* redirect_request_handler::Init(const std::string& loca
     return rrh;
 }
 
-/*  Response handle_request(const Request& request)
+Response redirect_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response handle_request(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - Response object (see response.h)
 Description:
     - Handler returns 302 redirects to server_url_ */
-Response redirect_request_handler::handle_request(const Request& request) {
+Response redirect_request_handler::handle_request(const RequestView& request) {
     Response response;
     response.code_ = Response::moved_temporarily;
-    response.headers_["Location"] = server_url_;
+    response.headers_[header_id::location] = server_url_;
     return response;
 }
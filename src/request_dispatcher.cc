@@ -124,69 +124,46 @@ void request_dispatcher::create_handler_mapping() {
     }
 }
 
-/* request_handler* request_dispatcher::get_handler(std::string uri)
+/* request_handler* request_dispatcher::get_handler(std::string_view request_path)
 Parameter(s):
-    - uri: URI given for a request handler in the config.
+    - request_path: decoded and normalized path of the client's request (RequestView::path_).
 Returns:
     - Base class pointer to corresponding handler type.
 Description:
-    - Returns base class pointer with handler respective to URI provided. */
-request_handler* request_dispatcher::get_handler(std::string uri) {
-    // Find the root directory and target file from the client's request uri
-    size_t space_index = 0;
-    while (true) {
-        space_index = uri.find("%20", space_index);
-        if (space_index == std::string::npos) {
-            break;
-        }
-        uri.replace(space_index, 3, " ");
-    }
+    - Returns base class pointer with handler respective to the path provided. The parser
+    has already decoded it, so it is matched as is. Locations are keyed by std::string,
+    so it goes through a per-thread buffer that keeps its capacity between requests
+    instead of a new string each time. */
+request_handler* request_dispatcher::get_handler(std::string_view request_path) {
+    static thread_local std::string path;
+    path.assign(request_path.data(), request_path.size());
 
-    std::string static_path = longest_prefix_match(uri);
+    request_handler* static_handler = longest_prefix_match(path);
 
     // Call the corresponding handler to handle the request
-    if (config_.echo_locations_.find(uri) != config_.echo_locations_.end()) {
-        return dispatcher[uri];
-    } else if (static_path != "") {
-        return dispatcher[static_path];
-    } else if (config_.status_locations_.find(uri) != config_.status_locations_.end()) {
-        return dispatcher[uri];
-    } else if (config_.redirect_locations_.find(uri) != config_.redirect_locations_.end()) {
-        return dispatcher[uri];
-    } else if (config_.health_locations_.find(uri) != config_.health_locations_.end()) {
-        return dispatcher[uri];
-    } else if (config_.upload_form_locations_.find(uri) != config_.upload_form_locations_.end()) {
-        return dispatcher[uri];
+    if (config_.echo_locations_.find(path) != config_.echo_locations_.end()) {
+        return get_location_handler(path);
+    } else if (static_handler != nullptr) {
+        return static_handler;
+    } else if (config_.status_locations_.find(path) != config_.status_locations_.end() ||
+               config_.redirect_locations_.find(path) != config_.redirect_locations_.end() ||
+               config_.health_locations_.find(path) != config_.health_locations_.end() ||
+               config_.upload_form_locations_.find(path) != config_.upload_form_locations_.end()) {
+        return get_location_handler(path);
     }
 
-    std::string uri_prefix;
-    bool found = false;
     for (const auto& pair : config_.proxy_locations_) {
-        uri_prefix = uri.substr(0, pair.first.length());
-        if (uri_prefix == pair.first) {
-            found = true;
-            break;
+        if (path.compare(0, pair.first.length(), pair.first) == 0) {
+            return get_location_handler(pair.first);
         }
     }
 
-    if (found) {
-        return dispatcher[uri_prefix];
-    }
-
-    std::string uri_prefix_2;
-    bool found_2 = false;
     for (const auto& pair : config_.blog_ips_) {
-        uri_prefix_2 = uri.substr(0, pair.first.length());
-        if (uri_prefix_2 == pair.first) {
-            found_2 = true;
-            break;
+        if (path.compare(0, pair.first.length(), pair.first) == 0) {
+            return get_location_handler(pair.first);
         }
     }
 
-    if (found_2) {
-        return dispatcher[uri_prefix_2];
-    }
-
     return error_handler_;
     // ******* TEMPLATE FOR DISPATCHING NEW HANDLERS ********
     // else if (your condition here) {
@@ -195,6 +172,18 @@ request_handler* request_dispatcher::get_handler(std::string uri) {
     // ******************************************************
 }
 
+/* request_handler* request_dispatcher::get_location_handler(const std::string& location) const
+Parameter(s):
+    - location: location path exactly as written in the config.
+Returns:
+    - Handler serving that location, or nullptr if there is none.
+Description:
+    - Looks up a location's handler without any URI matching. */
+request_handler* request_dispatcher::get_location_handler(const std::string& location) const {
+    auto itr = dispatcher.find(location);
+    return itr == dispatcher.end() ? nullptr : itr->second;
+}
+
 /* request_handler* request_dispatcher::get_handler(std::string uri)
 Parameter(s):
     - N/A
@@ -209,25 +198,26 @@ status_request_handler* request_dispatcher::get_status_handler() {
     return casted_ptr;
 }
 
-/* std::string request_dispatcher::longest_prefix_match(std::string uri)
+/* request_handler* request_dispatcher::longest_prefix_match(const std::string& uri) const
 Parameter(s):
     - uri: String that stores URI for static_request_handler.
 Returns:
-    - Trimmed URI string to use to retrieve the correct static handler.
+    - Handler of the longest static location that uri starts with (cut at a '/'), or
+    nullptr if there is none.
 Description:
-    - Helper function to retrieve the URI for static handler. */
-std::string request_dispatcher::longest_prefix_match(std::string uri) {
-    size_t slash_pos = 0;
-    std::string trimmed_uri = uri;
+    - Helper function to retrieve the handler for static requests. */
+request_handler* request_dispatcher::longest_prefix_match(const std::string& uri) const {
+    static thread_local std::string trimmed_uri;
+    trimmed_uri = uri;
     while (true) {
         if (config_.static_locations_.find(trimmed_uri) != config_.static_locations_.end()) {
-            return trimmed_uri;
+            return get_location_handler(trimmed_uri);
         }
-        slash_pos = trimmed_uri.find_last_of("/");
+        size_t slash_pos = trimmed_uri.find_last_of("/");
         if (slash_pos == std::string::npos) {
             break;
         }
-        trimmed_uri = trimmed_uri.substr(0, slash_pos);
+        trimmed_uri.resize(slash_pos);
     }
-    return "";
+    return nullptr;
 }
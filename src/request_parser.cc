@@ -22,37 +22,315 @@ Date Created:
 */
 
 #include <strings.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "header_map.h"
+#include "http_scanner.h"
 #include "request_builder.h"
 #include "request_parser.h"
+#include "uri_decoder.h"
 #include "iostream"
 
 /* Constructor */
 request_parser::request_parser()
-  : state_(method_start), contentsize_(0)
+  : state_(method_start), contentsize_(0), chunked_(false), chunk_remaining_(0),
+    pause_before_body_(false), max_body_size_(0), body_size_(0)
 {}
 
 void request_parser::reset() {
   state_ = method_start;
+  contentsize_ = 0;
+  chunked_ = false;
+  chunk_remaining_ = 0;
+  max_body_size_ = limits_.max_body_size;
+  body_size_ = 0;
 }
 
+/* bool request_parser::limit_body(std::size_t max_body_size)
+Parameter(s):
+    - max_body_size: most body bytes the current request may have, 0 for no limit.
+Returns:
+    - bool which is false if the body it declared so far is already over the limit.
+Description:
+    - Applies to the current request only; reset() goes back to the limit from
+    set_limits. */
+bool request_parser::limit_body(std::size_t max_body_size) {
+  max_body_size_ = max_body_size;
+  return !over_body_limit(0);
+}
+
+/* std::tuple<request_parser::result_type, const char*> request_parser::parse(request_builder& req,
+                                                                         const char* begin, const char* end)
+Parameter(s):
+    - req: Request builder object which stores values from the HTTP request.
+    - begin, end: bytes to parse.
+Returns:
+    - The result and how far the input was consumed.
+Description:
+    - Alternates between consume_run, which takes the whole run of characters the
+    current state accepts, and consume for the single byte that ended it. A request
+    that is still incomplete at the end of the input, or paused before its body, is
+    detached from it. The head limits are checked before each delimiter byte, so a head
+    over a limit is refused within the read that takes it over. */
+std::tuple<request_parser::result_type, const char*> request_parser::parse(request_builder& req,
+    const char* begin, const char* end) {
+  if (in_body() && over_body_limit(0)) {
+    return std::make_tuple(body_too_large, begin);
+  }
+  while (begin != end) {
+    begin = consume_run(req, begin, end);
+    if (!in_body()) {
+      result_type over = check_head_limits(req);
+      if (over != indeterminate) {
+        return std::make_tuple(over, begin);
+      }
+    }
+    if (begin == end) {
+      break;
+    }
+    result_type result = consume(req, begin++);
+    if (result == head_complete) {
+      req.detach();
+      return std::make_tuple(result, begin);
+    }
+    if (result != indeterminate) {
+      return std::make_tuple(result, begin);
+    }
+  }
+  req.detach();
+  return std::make_tuple(indeterminate, begin);
+}
+
+std::tuple<request_parser::result_type, char*> request_parser::parse(request_builder& req,
+    char* begin, char* end) {
+  result_type result;
+  const char* consumed;
+  std::tie(result, consumed) = parse(req, const_cast<const char*>(begin), end);
+  return std::make_tuple(result, begin + (consumed - begin));
+}
+
+/* std::tuple<request_parser::result_type, const char*> request_parser::parse_body(request_builder& req,
+    const char* begin, const char* end, std::string_view& data)
+Parameter(s):
+    - req: Request builder object of the request whose body this is.
+    - begin, end: bytes to parse.
+    - data: set to the body bytes found, if any.
+Returns:
+    - The result and how far the input was consumed.
+Description:
+    - Runs of body bytes are handed back instead of appended to req.body; the chunk
+    framing in between goes through consume_run and consume as it does for parse. The
+    bytes are still counted in req.message_size. A body over the limit from
+    limit_body is refused before any of it is taken. */
+std::tuple<request_parser::result_type, const char*> request_parser::parse_body(request_builder& req,
+    const char* begin, const char* end, std::string_view& data) {
+  data = std::string_view();
+  if (over_body_limit(0)) {
+    return std::make_tuple(body_too_large, begin);
+  }
+  while (begin != end) {
+    if (state_ == expecting_body) {
+      std::size_t n = std::min<std::size_t>(end - begin, contentsize_);
+      data = std::string_view(begin, n);
+      contentsize_ -= static_cast<int>(n);
+      req.message_size += n;
+      return std::make_tuple(contentsize_ == 0 ? good : indeterminate, begin + n);
+    }
+    if (state_ == chunk_data) {
+      std::size_t n = std::min<std::size_t>(end - begin, chunk_remaining_);
+      data = std::string_view(begin, n);
+      chunk_remaining_ -= n;
+      if (chunk_remaining_ == 0) {
+        state_ = chunk_data_cr;
+      }
+      req.message_size += n;
+      return std::make_tuple(indeterminate, begin + n);
+    }
+    begin = consume_run(req, begin, end);
+    if (begin == end) {
+      break;
+    }
+    result_type result = consume(req, begin++);
+    if (result != indeterminate) {
+      return std::make_tuple(result, begin);
+    }
+  }
+  return std::make_tuple(indeterminate, begin);
+}
+
+/* request_parser::result_type request_parser::check_head_limits(const request_builder& req) const
+Parameter(s):
+    - req: Request builder object of the request whose head is being read.
+Returns:
+    - uri_too_long or header_too_large if the head is over a limit, otherwise indeterminate.
+Description:
+    - The URI is checked first, so a long URI gets a 414 even when it also takes the
+    head over its limit. */
+request_parser::result_type request_parser::check_head_limits(const request_builder& req) const {
+  if (limits_.max_uri_size != 0 && req.uri.size() > limits_.max_uri_size) {
+    return uri_too_long;
+  }
+  if (limits_.max_header_size != 0 && req.message_size > limits_.max_header_size) {
+    return header_too_large;
+  }
+  if (limits_.max_header_count != 0 && req.headers.size() > limits_.max_header_count) {
+    return header_too_large;
+  }
+  return indeterminate;
+}
+
+/* const char* request_parser::consume_run(request_builder& req, const char* begin, const char* end)
+Parameter(s):
+    - req: Request builder object which stores values from the HTTP request.
+    - begin, end: bytes to parse.
+Returns:
+    - the first byte the run did not take, which consume then checks.
+Description:
+    - Only the states that sit inside a run move ahead; the rest return begin. A body
+    run stops one byte short of the Content-Length, so consume sees the last byte and
+    reports the request complete. */
+const char* request_parser::consume_run(request_builder& req, const char* begin, const char* end) {
+  const char* run_end = begin;
+  switch (state_) {
+  case method:
+    run_end = http_scanner::find_token_end(begin, end);
+    req.method.append(begin, run_end - begin);
+    break;
+  case uri:
+    run_end = http_scanner::find_uri_end(begin, end);
+    req.uri.append(begin, run_end - begin);
+    break;
+  case header_name:
+    run_end = http_scanner::find_token_end(begin, end);
+    req.headers.back().name.append(begin, run_end - begin);
+    break;
+  case header_value:
+    run_end = http_scanner::find_value_end(begin, end);
+    req.headers.back().value.append(begin, run_end - begin);
+    break;
+  case expecting_body:
+    if (contentsize_ > 1) {
+      run_end = begin + std::min<std::ptrdiff_t>(end - begin, contentsize_ - 1);
+      req.body.append(begin, run_end - begin);
+      contentsize_ -= static_cast<int>(run_end - begin);
+    }
+    break;
+  case chunk_data:
+    // The CRLF after the data is checked by consume, so the whole chunk can go here.
+    run_end = begin + std::min<std::size_t>(end - begin, chunk_remaining_);
+    req.body.append(begin, run_end - begin);
+    chunk_remaining_ -= run_end - begin;
+    if (chunk_remaining_ == 0) {
+      state_ = chunk_data_cr;
+    }
+    break;
+  case chunk_extension:
+  case trailer_line:
+    run_end = http_scanner::find_value_end(begin, end);
+    break;
+  default:
+    break;
+  }
+  req.message_size += run_end - begin;
+  return run_end;
+}
+
+/* bool request_parser::split_target(request_builder& req)
+Parameter(s):
+    - req: Request builder object whose URI has just been read.
+Returns:
+    - bool which is false if the path has a bad percent escape or one for NUL.
+Description:
+    - Fills in req.path and req.query once, so routing and handlers never scan the URI
+    again. The usual path, with no escapes or dot segments, is only a view of the URI's
+    bytes; one that needs decoding gets a string of its own. A URI already copied out
+    of the read buffer is copied again rather than referred to, so the builder never
+    points into itself. */
+bool request_parser::split_target(request_builder& req) {
+  std::string_view path;
+  std::string_view query;
+  uri_decoder::split(req.uri, path, query);
+  if (req.uri.owned()) {
+    req.query.own().assign(query.data(), query.size());
+  } else {
+    req.query.refer(query);
+  }
+  if (uri_decoder::needs_normalizing(path)) {
+    return uri_decoder::normalize_path(path, req.path.own());
+  }
+  if (req.uri.owned()) {
+    req.path.own().assign(path.data(), path.size());
+  } else {
+    req.path.refer(path);
+  }
+  return true;
+}
+
+static bool equals_ignore_case(std::string_view text, const char* word) {
+  return text.size() == strlen(word) && strncasecmp(text.data(), word, text.size()) == 0;
+}
+
+/* Whether a Transfer-Encoding value ends with the chunked coding, which must come last
+   when the request has a body we can find the end of. */
+static bool ends_with_chunked(std::string_view value) {
+  std::size_t last = value.find_last_not_of(" \t");
+  if (last == std::string_view::npos) {
+    return false;
+  }
+  value = value.substr(0, last + 1);
+  std::size_t comma = value.find_last_of(',');
+  if (comma != std::string_view::npos) {
+    value = value.substr(comma + 1);
+  }
+  std::size_t first = value.find_first_not_of(" \t");
+  return first != std::string_view::npos && equals_ignore_case(value.substr(first), "chunked");
+}
+
+/* Whether a comma separated list of tokens, such as a Connection value, holds token. */
+static bool has_token(std::string_view value, const char* token) {
+  while (!value.empty()) {
+    std::size_t comma = value.find(',');
+    std::string_view item = value.substr(0, comma);
+    std::size_t first = item.find_first_not_of(" \t");
+    if (first != std::string_view::npos) {
+      item = item.substr(first, item.find_last_not_of(" \t") + 1 - first);
+      if (equals_ignore_case(item, token)) {
+        return true;
+      }
+    }
+    if (comma == std::string_view::npos) {
+      break;
+    }
+    value = value.substr(comma + 1);
+  }
+  return false;
+}
+
+// Larger chunk sizes are refused rather than overflow.
+static const std::size_t max_chunk_size = std::size_t(-1);
+
 /* NOTE: Function is called in request_parser.h */
 /* std::string request_dispatcher::longest_prefix_match(std::string uri)
 Parameter(s):
     - req: Request builder object which stores values from the HTTP request.
-    - input: 
+    - next: the byte to parse, in the buffer the request's fields point into.
 Returns:
     - Result type which determines if the request is either good, bad, or indeterminate.
 Description: 
     - Parses received request to determine if it is syntactically valid. */
-request_parser::result_type request_parser::consume(request_builder& req, char input) {
-  req.fullmessage.push_back(input);
+request_parser::result_type request_parser::consume(request_builder& req, const char* next) {
+  char input = *next;
+  ++req.message_size;
   switch (state_) {
   case method_start:
     if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
       return bad;
     } else {
       state_ = method;
-      req.method.push_back(input);
+      req.method.append(next, 1);
       return indeterminate;
     }
   case method:
@@ -62,22 +340,23 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
       return bad;
     } else {
-      req.method.push_back(input);
+      req.method.append(next, 1);
       return indeterminate;
     }
   case uri:
     if (input == ' ') {
       state_ = http_version_h;
-      return indeterminate;
+      return split_target(req) ? indeterminate : bad;
     } else if (is_ctl(input)) {
       return bad;
     } else {
-      req.uri.push_back(input);
+      req.uri.append(next, 1);
       return indeterminate;
     }
   case http_version_h:
     if (input == 'H') {
       state_ = http_version_t_1;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -85,6 +364,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
   case http_version_t_1:
     if (input == 'T') {
       state_ = http_version_t_2;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -92,6 +372,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
   case http_version_t_2:
     if (input == 'T') {
       state_ = http_version_p;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -99,6 +380,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
   case http_version_p:
     if (input == 'P') {
       state_ = http_version_slash;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -108,6 +390,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
       req.http_version_major = 0;
       req.http_version_minor = 0;
       state_ = http_version_major_start;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -116,6 +399,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     if (is_digit(input)) {
       req.http_version_major = req.http_version_major * 10 + input - '0';
       state_ = http_version_major;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -123,9 +407,11 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
   case http_version_major:
     if (input == '.') {
       state_ = http_version_minor_start;
+      req.version.append(next, 1);
       return indeterminate;
     } else if (is_digit(input)) {
       req.http_version_major = req.http_version_major * 10 + input - '0';
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -134,6 +420,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     if (is_digit(input)) {
       req.http_version_minor = req.http_version_minor * 10 + input - '0';
       state_ = http_version_minor;
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
@@ -144,12 +431,17 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
       return indeterminate;
     } else if (is_digit(input)) {
       req.http_version_minor = req.http_version_minor * 10 + input - '0';
+      req.version.append(next, 1);
       return indeterminate;
     } else {
       return bad;
     }
   case expecting_newline_1:
     if (input == '\n') {
+      // HTTP/1.1 connections persist unless the client asks to close (RFC 7230 6.3);
+      // HTTP/1.0 ones only when it asks to keep them.
+      req.keep_alive = req.http_version_major > 1 ||
+                       (req.http_version_major == 1 && req.http_version_minor >= 1);
       state_ = header_line_start;
       return indeterminate;
     } else {
@@ -165,8 +457,8 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
       return bad;
     } else {
-      req.headers.push_back(header());
-      req.headers.back().name.push_back(input);
+      req.headers.push_back(header_field());
+      req.headers.back().name.append(next, 1);
       state_ = header_name;
       return indeterminate;
     }
@@ -180,7 +472,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
       return bad;
     } else {
       state_ = header_value;
-      req.headers.back().value.push_back(input);
+      req.headers.back().value.append(next, 1);
       return indeterminate;
     }
   case header_name:
@@ -190,7 +482,7 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     } else if (!is_char(input) || is_ctl(input) || is_tspecial(input)) {
       return bad;
     } else {
-      req.headers.back().name.push_back(input);
+      req.headers.back().name.append(next, 1);
       return indeterminate;
     }
   case space_before_header_value:
@@ -202,27 +494,47 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
     }
   case header_value:
     if (input == '\r') {
-      std::string current_header = req.headers.back().name;
-      if (strcasecmp(current_header.c_str(), "Content-Length") == 0) {
+      std::string_view current_header = req.headers.back().name;
+      std::string_view current_value = req.headers.back().value;
+      header_id id = lookup_header_id(current_header);
+      if (id == header_id::content_length) {
+        long long length;
         try {
-          req.bodysize = std::stoi(req.headers.back().value);
-          contentsize_ = std::stoi(req.headers.back().value);
-          req.body.reserve(req.bodysize);
+          length = std::stoll(std::string(current_value));
         } catch (std::exception e) {
           return bad;
         }
+        if (length < 0) {
+          return bad;
+        } else if (length > INT_MAX) {
+          // Too big to hold, whatever the limit.
+          return body_too_large;
+        }
+        req.bodysize = static_cast<int>(length);
+        contentsize_ = req.bodysize;
       }
 
-      if ( (strcasecmp(current_header.c_str(), "Connection") == 0) &&\
-      (strcasecmp(req.headers.back().value.c_str(), "Keep-Alive") == 0) ) {
-      req.keep_alive = true;
+      if (id == header_id::transfer_encoding) {
+        // Any other coding would leave us unable to tell where the body ends.
+        if (!ends_with_chunked(current_value)) {
+          return bad;
+        }
+        chunked_ = true;
+      }
+
+      if (id == header_id::connection) {
+        if (has_token(current_value, "close")) {
+          req.keep_alive = false;
+        } else if (has_token(current_value, "Keep-Alive")) {
+          req.keep_alive = true;
+        }
       }
       state_ = expecting_newline_2;
       return indeterminate;
     } else if (is_ctl(input)) {
       return bad;
     } else {
-      req.headers.back().value.push_back(input);
+      req.headers.back().value.append(next, 1);
       return indeterminate;
     }
   case expecting_newline_2:
@@ -233,20 +545,114 @@ request_parser::result_type request_parser::consume(request_builder& req, char i
       return bad;
     }
   case expecting_newline_3:
+    if (chunked_) {
+      // A Content-Length next to it could be read differently by a proxy in front.
+      if (input != '\n' || contentsize_ != 0) {
+        return bad;
+      }
+      state_ = chunk_size_start;
+      return pause_before_body_ ? head_complete : indeterminate;
+    }
     if (contentsize_ == 0) {
       return (input == '\n') ? good : bad;
     } else {
       state_ = expecting_body;
-      return indeterminate;
+      body_size_ = contentsize_;
+      if (pause_before_body_) {
+        // The caller may still change the limit with limit_body.
+        return head_complete;
+      }
+      return over_body_limit(0) ? body_too_large : indeterminate;
     }
   case expecting_body:
     --contentsize_;
-    req.body.push_back(input);
+    req.body.append(next, 1);
     if (contentsize_ == 0) {
       return good;
     } else {
       return indeterminate;
     }
+  case chunk_size_start:
+    if (hex_value(input) < 0) {
+      return bad;
+    }
+    chunk_remaining_ = hex_value(input);
+    state_ = chunk_size;
+    return indeterminate;
+  case chunk_size:
+    if (hex_value(input) >= 0) {
+      if (chunk_remaining_ > max_chunk_size >> 4) {
+        return bad;
+      }
+      chunk_remaining_ = chunk_remaining_ * 16 + hex_value(input);
+      return indeterminate;
+    } else if (input == ';' || input == ' ' || input == '\t') {
+      state_ = chunk_extension;
+      return indeterminate;
+    } else if (input == '\r') {
+      state_ = chunk_size_newline;
+      return indeterminate;
+    } else {
+      return bad;
+    }
+  case chunk_extension:
+    if (input == '\r') {
+      state_ = chunk_size_newline;
+      return indeterminate;
+    } else if (input == '\t') {
+      return indeterminate;
+    } else {
+      return bad;
+    }
+  case chunk_size_newline:
+    if (input != '\n') {
+      return bad;
+    }
+    if (over_body_limit(chunk_remaining_)) {
+      return body_too_large;
+    }
+    body_size_ += chunk_remaining_;
+    state_ = chunk_remaining_ == 0 ? trailer_line_start : chunk_data;
+    return indeterminate;
+  case chunk_data_cr:
+    if (input != '\r') {
+      return bad;
+    }
+    state_ = chunk_data_newline;
+    return indeterminate;
+  case chunk_data_newline:
+    if (input != '\n') {
+      return bad;
+    }
+    state_ = chunk_size_start;
+    return indeterminate;
+  case trailer_line_start:
+    if (input == '\r') {
+      state_ = final_newline;
+      return indeterminate;
+    } else if (is_ctl(input) || input == ' ') {
+      return bad;
+    } else {
+      state_ = trailer_line;
+      return indeterminate;
+    }
+  case trailer_line:
+    if (input == '\r') {
+      state_ = trailer_newline;
+      return indeterminate;
+    } else if (input == '\t') {
+      return indeterminate;
+    } else {
+      return bad;
+    }
+  case trailer_newline:
+    if (input != '\n') {
+      return bad;
+    }
+    state_ = trailer_line_start;
+    return indeterminate;
+  case final_newline:
+    return (input == '\n') ? good : bad;
 
   default:
     return bad;
@@ -278,3 +684,14 @@ bool request_parser::is_tspecial(int c) {
 bool request_parser::is_digit(int c) {
   return c >= '0' && c <= '9';
 }
+
+int request_parser::hex_value(int c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
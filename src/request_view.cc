@@ -0,0 +1,65 @@
+/* request_view.cc
+Description:
+    Non-owning view of a parsed HTTP request, and its conversion to an owning Request.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <strings.h>
+
+#include <string>
+
+#include "http_tokens.h"
+#include "request_view.h"
+
+static_assert(http_tokens::methods.size() == Request::TRACE + 1, "a name for every method");
+
+RequestView::RequestView(const Request& request)
+    : method_(request.method_),
+      method_name_(static_cast<unsigned>(request.method_) <= Request::TRACE ?
+                   http_tokens::methods[request.method_] : ""),
+      uri_(request.uri_), version_(request.version_), body_(request.body_) {
+    std::string_view query;
+    uri_decoder::split(uri_, path_, query);
+    query_ = query_view(query);
+    if (uri_decoder::needs_normalizing(path_)) {
+        auto decoded = std::make_shared<std::string>();
+        if (uri_decoder::normalize_path(path_, *decoded)) {
+            path_ = *decoded;
+            decoded_path_ = std::move(decoded);
+        }
+    }
+    headers_.reserve(request.headers_.size());
+    for (const header_entry& h : request.headers_) {
+        headers_.push_back(header_view{h.name, h.value});
+    }
+}
+
+std::string_view RequestView::header(std::string_view name) const {
+    for (const header_view& h : headers_) {
+        if (h.name.size() == name.size() &&
+            strncasecmp(h.name.data(), name.data(), name.size()) == 0) {
+            return h.value;
+        }
+    }
+    return std::string_view();
+}
+
+Request RequestView::to_request() const {
+    Request request;
+    request.method_ = method_;
+    request.uri_.assign(uri_.data(), uri_.size());
+    request.version_.assign(version_.data(), version_.size());
+    for (const header_view& h : headers_) {
+        request.headers_.add(h.name, h.value);
+    }
+    request.body_.assign(body_.data(), body_.size());
+    return request;
+}
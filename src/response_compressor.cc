@@ -0,0 +1,463 @@
+/* response_compressor.cc
+Description:
+    gzip and deflate compression of response bodies, negotiated with Accept-Encoding,
+    with per-thread pools of zlib streams and a back-off for busy io threads.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <strings.h>
+#include <time.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <boost/log/trivial.hpp>
+
+#include "buffer_pool.h"
+#include "response_compressor.h"
+#include "server_metrics.h"
+
+namespace {
+
+// A zlib stream set up for one encoding, kept between responses.
+struct deflater {
+    z_stream stream;
+    response_compressor::encoding coding;
+    int level;
+};
+
+enum { max_free_deflaters = 4 };
+
+// Free deflaters of the thread, one list for gzip and one for deflate. A deflater
+// released on another thread than the one it came from joins that thread's list.
+struct deflater_pool {
+    std::vector<deflater*> free[2];
+
+    ~deflater_pool() {
+        for (std::vector<deflater*>& list : free) {
+            for (deflater* d : list) {
+                deflateEnd(&d->stream);
+                delete d;
+            }
+        }
+    }
+};
+
+thread_local deflater_pool pool;
+
+std::vector<deflater*>& free_list(response_compressor::encoding coding) {
+    return pool.free[coding == response_compressor::gzip ? 0 : 1];
+}
+
+void release_deflater(deflater* d) {
+    std::vector<deflater*>& list = free_list(d->coding);
+    if (deflateReset(&d->stream) == Z_OK && list.size() < max_free_deflaters) {
+        list.push_back(d);
+        return;
+    }
+    deflateEnd(&d->stream);
+    delete d;
+}
+
+struct deflater_releaser {
+    void operator()(deflater* d) const { release_deflater(d); }
+};
+
+typedef std::unique_ptr<deflater, deflater_releaser> deflater_lease;
+
+/* deflater_lease acquire_deflater(response_compressor::encoding coding, int level)
+Parameter(s):
+    - coding: gzip or deflate.
+    - level: zlib compression level.
+Returns:
+    - A reset deflater at that level, or null if zlib could not set one up.
+Description:
+    - Takes one from the thread's free list if it has one, changing its level if it was
+    last used at another; setting up a new stream costs far more. */
+deflater_lease acquire_deflater(response_compressor::encoding coding, int level) {
+    std::vector<deflater*>& list = free_list(coding);
+    if (!list.empty()) {
+        deflater* d = list.back();
+        list.pop_back();
+        if (d->level != level && deflateParams(&d->stream, level, Z_DEFAULT_STRATEGY) == Z_OK) {
+            d->level = level;
+        }
+        return deflater_lease(d);
+    }
+
+    deflater* d = new deflater();
+    std::memset(&d->stream, 0, sizeof(d->stream));
+    d->coding = coding;
+    d->level = level;
+    // 16 more window bits asks zlib for the gzip wrapper instead of the zlib one.
+    int window_bits = coding == response_compressor::gzip ? 15 + 16 : 15;
+    if (deflateInit2(&d->stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        delete d;
+        return deflater_lease();
+    }
+    return deflater_lease(d);
+}
+
+// Compresses a body as the session writes it, reading from the handler's producer or
+// from a body the handler built whole, which it shares rather than copies.
+class compressing_body_producer : public body_producer {
+ public:
+    compressing_body_producer(deflater_lease deflater, std::shared_ptr<body_producer> source)
+        : deflater_(std::move(deflater)), source_(std::move(source)), source_done_(false), finished_(false) {}
+
+    compressing_body_producer(deflater_lease deflater, std::shared_ptr<const std::string> body)
+        : deflater_(std::move(deflater)), body_(std::move(body)), source_done_(true), finished_(false) {
+        // zlib does not write through next_in.
+        deflater_->stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body_->data()));
+        deflater_->stream.avail_in = body_->size();
+    }
+
+    /* Deflates into buffer until it has something to hand out, reading more of the
+    source whenever zlib has taken all it was given. */
+    bool read(char* buffer, std::size_t capacity, std::size_t& size) {
+        z_stream& stream = deflater_->stream;
+        while (!finished_) {
+            if (stream.avail_in == 0 && !source_done_) {
+                input_.consume(input_.size());
+                input_.reserve(buffer_pool::class_capacity(buffer_pool::num_size_classes / 2));
+                std::size_t read = 0;
+                if (!source_->read(input_.tail(), input_.tail_capacity(), read)) {
+                    return false;
+                }
+                stream.next_in = reinterpret_cast<Bytef*>(input_.tail());
+                stream.avail_in = read;
+                source_done_ = read == 0;
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = capacity;
+            int result = deflate(&stream, source_done_ ? Z_FINISH : Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                finished_ = true;
+            } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                BOOST_LOG_TRIVIAL(error) << "Compressing response body failed: " << result;
+                return false;
+            }
+            size = capacity - stream.avail_out;
+            if (size > 0) {
+                return true;
+            }
+        }
+        size = 0;
+        return true;
+    }
+
+ private:
+    deflater_lease deflater_;
+    std::shared_ptr<body_producer> source_;
+    std::shared_ptr<const std::string> body_;
+    // What was last read from source_, borrowed from the thread's buffer_pool.
+    pooled_buffer input_;
+    bool source_done_;
+    bool finished_;
+};
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool equals_ignoring_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// A qvalue ("1", "0.5", "0.001") in thousandths, or -1 if it is not one.
+int parse_qvalue(std::string_view text) {
+    if (text.empty() || (text[0] != '0' && text[0] != '1')) {
+        return -1;
+    }
+    int value = (text[0] - '0') * 1000;
+    if (text.size() == 1) {
+        return value;
+    }
+    if (text[1] != '.' || text.size() > 5) {
+        return -1;
+    }
+    int scale = 100;
+    for (std::size_t i = 2; i < text.size(); ++i, scale /= 10) {
+        if (text[i] < '0' || text[i] > '9') {
+            return -1;
+        }
+        value += (text[i] - '0') * scale;
+    }
+    return value > 1000 ? -1 : value;
+}
+
+// Adds Accept-Encoding to the response's Vary header unless it is there already.
+void add_vary(header_map& headers) {
+    std::string& vary = headers[header_id::vary];
+    if (vary.empty()) {
+        vary = "Accept-Encoding";
+    } else if (vary != "*" && strcasestr(vary.c_str(), "accept-encoding") == nullptr) {
+        vary += ", Accept-Encoding";
+    }
+}
+
+}  // namespace
+
+/* response_compressor Constructor
+Parameter(s):
+    - config: parsed representation of configuration file (see config_parser.h)
+    - dispatcher: resolves the locations with their own settings to their handlers.
+Description:
+    - Keys the location settings by handler, which is what the session has for each
+    response. */
+response_compressor::response_compressor(const NginxConfig& config, request_dispatcher& dispatcher)
+    : compression_(config.compression) {
+    for (const auto& location : config.location_compression_) {
+        const request_handler* handler = dispatcher.get_location_handler(location.first);
+        if (handler == nullptr) {
+            BOOST_LOG_TRIVIAL(error) << "No handler for compression location " << location.first;
+            continue;
+        }
+        location_compression_[handler] = location.second;
+    }
+}
+
+const NginxConfig::Compression& response_compressor::settings(const request_handler* handler) const {
+    auto itr = location_compression_.find(handler);
+    return itr == location_compression_.end() ? compression_ : itr->second;
+}
+
+/* void response_compressor::compress(const RequestView& request, const request_handler* handler,
+                                      Response& response) const
+Parameter(s):
+    - request: the request the response answers.
+    - handler: the handler that produced the response.
+    - response: the response, changed in place.
+Returns:
+    - N/A
+Description:
+    - A body up to buffered_limit is replaced with its compressed bytes, unless they
+    come out no smaller. A larger one, or a body_producer_, is wrapped in a producer
+    that compresses it piece by piece; its length is then unknown, so it goes chunked
+    (see session::frame_body). */
+void response_compressor::compress(const RequestView& request, const request_handler* handler,
+                                   Response& response) const {
+    const NginxConfig::Compression& settings = this->settings(handler);
+    if (!settings.enabled || response.code_ < 200 || response.code_ == Response::no_content ||
+        response.code_ == Response::not_modified ||
+        response.headers_.find(header_id::content_encoding) != response.headers_.end()) {
+        return;
+    }
+    long long size = response.body_producer_ ? response.body_producer_->size() :
+                     static_cast<long long>(response.body().size());
+    if ((size >= 0 && static_cast<unsigned long long>(size) < settings.min_length) ||
+        !compressible_type(settings.types, response.headers_.get(header_id::content_type))) {
+        return;
+    }
+    // Caches must not hand this response to a client that accepts another encoding.
+    add_vary(response.headers_);
+    encoding coding = negotiate(request.header("Accept-Encoding"));
+    if (coding == identity) {
+        return;
+    }
+
+    server_metrics& metrics = server_metrics::get();
+    int level = level_for_load(settings.level, busy_percent());
+    if (level == 0) {
+        metrics.compression_skipped_busy.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (level < settings.level) {
+        metrics.compression_backoffs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!response.body_producer_ && response.body().size() <= buffered_limit) {
+        std::string compressed;
+        if (!compress_whole(coding, level, response.body(), compressed) ||
+            compressed.size() >= response.body().size()) {
+            return;
+        }
+        response.body_.swap(compressed);
+        response.shared_body_.reset();
+        response.headers_[header_id::content_length] = std::to_string(response.body_.size());
+    } else {
+        deflater_lease deflater = acquire_deflater(coding, level);
+        if (!deflater) {
+            return;
+        }
+        if (response.body_producer_) {
+            response.body_producer_ = std::make_shared<compressing_body_producer>(
+                std::move(deflater), std::move(response.body_producer_));
+        } else {
+            std::shared_ptr<const std::string> body = response.shared_body_ ? std::move(response.shared_body_) :
+                std::make_shared<const std::string>(std::move(response.body_));
+            response.body_producer_ = std::make_shared<compressing_body_producer>(std::move(deflater),
+                                                                                  std::move(body));
+            response.body_.clear();
+            response.shared_body_.reset();
+        }
+        response.headers_.erase(header_name(header_id::content_length));
+    }
+    response.headers_[header_id::content_encoding] = coding == gzip ? "gzip" : "deflate";
+    metrics.responses_compressed.fetch_add(1, std::memory_order_relaxed);
+}
+
+/* response_compressor::encoding response_compressor::negotiate(std::string_view accept_encoding)
+Parameter(s):
+    - accept_encoding: value of the request's Accept-Encoding header, empty if it has none.
+Returns:
+    - The encoding the client prefers most, gzip on a tie.
+Description:
+    - Reads each "coding;q=value" of the list (RFC 7231 5.3.4). x-gzip is gzip, and an
+    unreadable qvalue makes its coding count as not named. */
+response_compressor::encoding response_compressor::negotiate(std::string_view accept_encoding) {
+    // Thousandths, -1 while the coding is not named.
+    int gzip_q = -1;
+    int deflate_q = -1;
+    int any_q = -1;
+    while (!accept_encoding.empty()) {
+        std::size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        std::size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        int q = 1000;
+        while (semicolon != std::string_view::npos) {
+            item = item.substr(semicolon + 1);
+            semicolon = item.find(';');
+            std::string_view param = trim(item.substr(0, semicolon));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = parse_qvalue(param.substr(2));
+            }
+        }
+        if (q < 0) {
+            continue;
+        }
+        if (equals_ignoring_case(coding, "gzip") || equals_ignoring_case(coding, "x-gzip")) {
+            gzip_q = q;
+        } else if (equals_ignoring_case(coding, "deflate")) {
+            deflate_q = q;
+        } else if (coding == "*") {
+            any_q = q;
+        }
+    }
+    if (gzip_q < 0) {
+        gzip_q = any_q;
+    }
+    if (deflate_q < 0) {
+        deflate_q = any_q;
+    }
+    if (gzip_q > 0 && gzip_q >= deflate_q) {
+        return gzip;
+    }
+    return deflate_q > 0 ? deflate : identity;
+}
+
+int response_compressor::level_for_load(int configured_level, int busy_percent) {
+    if (busy_percent >= off_busy_percent) {
+        return 0;
+    }
+    if (busy_percent >= backoff_busy_percent) {
+        return 1;
+    }
+    return configured_level;
+}
+
+/* bool response_compressor::compress_whole(encoding coding, int level, std::string_view data,
+                                            std::string& compressed)
+Parameter(s):
+    - coding: gzip or deflate.
+    - level: zlib compression level.
+    - data: bytes to compress.
+    - compressed: replaced with the compressed bytes.
+Returns:
+    - bool which is false if zlib failed.
+Description:
+    - Sizes the output for the worst case first, so zlib finishes in one call. */
+bool response_compressor::compress_whole(encoding coding, int level, std::string_view data,
+                                         std::string& compressed) {
+    deflater_lease deflater = acquire_deflater(coding, level);
+    if (!deflater) {
+        return false;
+    }
+    z_stream& stream = deflater->stream;
+    compressed.resize(deflateBound(&stream, data.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = compressed.size();
+    if (::deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return false;
+    }
+    compressed.resize(stream.total_out);
+    return true;
+}
+
+std::shared_ptr<body_producer> response_compressor::compressing_producer(encoding coding, int level,
+                                                                         std::shared_ptr<body_producer> source) {
+    deflater_lease deflater = acquire_deflater(coding, level);
+    if (!deflater) {
+        return nullptr;
+    }
+    return std::make_shared<compressing_body_producer>(std::move(deflater), std::move(source));
+}
+
+bool response_compressor::compressible_type(const std::vector<std::string>& types, std::string_view content_type) {
+    std::string_view mime = trim(content_type.substr(0, content_type.find(';')));
+    for (const std::string& type : types) {
+        if (type == "*" || equals_ignoring_case(type, mime)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* int response_compressor::busy_percent()
+Parameter(s):
+    - N/A
+Returns:
+    - How much of the last sample period the calling thread spent on the CPU, in percent.
+Description:
+    - An io thread that is waiting for its sockets uses no CPU, so the share of wall
+    time it did use is how close it is to saturated. The coarse clock is about as cheap
+    as a memory load; the thread's CPU clock is only read once a sample period. */
+int response_compressor::busy_percent() {
+    struct load_sample {
+        long long wall_ns = -1;
+        long long cpu_ns = 0;
+        int percent = 0;
+    };
+    static thread_local load_sample sample;
+
+    timespec now;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+    long long wall_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+    if (sample.wall_ns >= 0 && wall_ns - sample.wall_ns < sample_ms * 1000000LL) {
+        return sample.percent;
+    }
+    timespec cpu;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    long long cpu_ns = cpu.tv_sec * 1000000000LL + cpu.tv_nsec;
+    if (sample.wall_ns >= 0) {
+        long long percent = (cpu_ns - sample.cpu_ns) * 100 / (wall_ns - sample.wall_ns);
+        sample.percent = percent > 100 ? 100 : static_cast<int>(percent);
+    }
+    sample.wall_ns = wall_ns;
+    sample.cpu_ns = cpu_ns;
+    return sample.percent;
+}
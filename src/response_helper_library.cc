@@ -11,13 +11,18 @@ Date Created:
     May 12th, 2020
 */
 
+#include <cstring>
+#include <memory>
 #include <string>
+#include "header_cache.h"
+#include "http_tokens.h"
 #include "response_helper_library.h"
 
 namespace misc_strings {
 
 const char name_value_separator[] = { ':', ' ' };
 const char crlf[] = { '\r', '\n' };
+const char http_1_0[] = { 'H', 'T', 'T', 'P', '/', '1', '.', '0' };
 
 }  // namespace misc_strings
 
@@ -25,48 +30,209 @@ const char crlf[] = { '\r', '\n' };
 Parameter(s):
     - status: Enum value that indicates status of response (see response.h)
 Returns:
-    - Buffer which contains string that corresponds to status of response (see response_helper_library.h)
+    - Buffer which contains the HTTP/1.1 status line of the response (see http_tokens.h)
 Description:
-    - Puts status string for generated response in buffer format to send. */
+    - Puts status string for generated response in buffer format to send. A code
+    outside 100-599 is sent as a 500. */
 boost::asio::const_buffer ResponseHelperLibrary::to_buffer(Response::StatusCode status) {
-    switch (status) {
-    case Response::ok:
-      return boost::asio::buffer(status_strings::ok);
-    case Response::bad_request:
-      return boost::asio::buffer(status_strings::bad_request);
-    case Response::not_found:
-      return boost::asio::buffer(status_strings::not_found);
-    case Response::moved_temporarily:
-      return boost::asio::buffer(status_strings::moved_temporarily);
-    default:
-      return boost::asio::buffer(status_strings::bad_request);
+    std::string_view line = http_tokens::any_status_line(status);
+    if (line.empty()) {
+      line = http_tokens::status_line(Response::internal_server_error);
+    }
+    return boost::asio::buffer(line.data(), line.size());
+}
+
+namespace {
+
+// The cached header lines spliced into a response's head, see header_cache.
+struct spliced_headers {
+    // Before the response's own headers: Server and Date, as one block when both go in
+    std::string_view first;
+    std::string_view second;
+    // After them
+    std::string_view connection;
+
+    std::size_t size() const { return first.size() + second.size() + connection.size(); }
+};
+
+/* Server and Date go into every response without its own (a proxied response keeps the
+   upstream's). Connection says close on the last response before the connection closes,
+   and keep-alive to an HTTP/1.0 client, which would otherwise assume close. */
+spliced_headers spliced(const Response& response) {
+    spliced_headers lines;
+    bool own_server = response.headers_.find(header_id::server) != response.headers_.end();
+    bool own_date = response.headers_.find(header_id::date) != response.headers_.end();
+    std::string_view common = header_cache::common();
+    if (!own_server && !own_date) {
+      lines.first = common;
+    } else {
+      std::size_t server_size = header_cache::server_line().size();
+      if (!own_server) {
+        lines.first = common.substr(0, server_size);
+      }
+      if (!own_date) {
+        lines.second = common.substr(server_size);
+      }
+    }
+    if (response.headers_.find(header_id::connection) == response.headers_.end()) {
+      if (response.close_connection_) {
+        lines.connection = header_cache::connection_close();
+      } else if (response.http_version_minor_ == 0) {
+        lines.connection = header_cache::connection_keep_alive();
+      }
+    }
+    return lines;
+}
+
+}  // namespace
+
+std::size_t ResponseHelperLibrary::head_size(const Response& response) {
+    std::size_t size = boost::asio::buffer_size(to_buffer(response.code_)) + spliced(response).size();
+    for (const header_entry& header : response.headers_) {
+      size += header.name.size() + sizeof(misc_strings::name_value_separator) +
+              header.value.size() + sizeof(misc_strings::crlf);
     }
+    return size + sizeof(misc_strings::crlf);
 }
 
-/* std::vector<boost::asio::const_buffer> ResponseHelperLibrary::to_buffers(Response& response)
+static char* append(char* out, const void* data, std::size_t size) {
+    if (size != 0) {
+      std::memcpy(out, data, size);
+    }
+    return out + size;
+}
+
+/* char* ResponseHelperLibrary::write_head(const Response& response, char* out)
 Parameter(s):
     - response: Response generated from a request handler.
+    - out: where the head goes, with room for head_size(response) bytes.
+Returns:
+    - The byte after the blank line that ends the head.
+Description:
+    - The status line is copied from the table for HTTP/1.1, with its version digit
+    changed for a response to an HTTP/1.0 request. The Server, Date and Connection
+    lines are copied from header_cache. */
+char* ResponseHelperLibrary::write_head(const Response& response, char* out) {
+    boost::asio::const_buffer line = to_buffer(response.code_);
+    spliced_headers lines = spliced(response);
+    char* version_digit = out + http_tokens::status_minor_version_offset;
+    out = append(out, line.data(), line.size());
+    if (response.http_version_minor_ == 0) {
+      *version_digit = '0';
+    }
+    out = append(out, lines.first.data(), lines.first.size());
+    out = append(out, lines.second.data(), lines.second.size());
+    for (const header_entry& header : response.headers_) {
+      out = append(out, header.name.data(), header.name.size());
+      out = append(out, misc_strings::name_value_separator, sizeof(misc_strings::name_value_separator));
+      out = append(out, header.value.data(), header.value.size());
+      out = append(out, misc_strings::crlf, sizeof(misc_strings::crlf));
+    }
+    out = append(out, lines.connection.data(), lines.connection.size());
+    return append(out, misc_strings::crlf, sizeof(misc_strings::crlf));
+}
+
+/* void ResponseHelperLibrary::to_buffers(const std::vector<Response>& responses, pooled_buffer& heads,
+                                          std::vector<boost::asio::const_buffer>& buffers)
+Parameter(s):
+    - responses: responses to pipelined requests, in request order.
+    - heads: buffer the heads are written into.
+    - buffers: where the buffers to send are appended.
 Returns:
-    - Vector of buffers which store header names, values, formatting characters, and response body.
+    - N/A
 Description:
-    - Formats response information into a buffer format that can be sent. */
-std::vector<boost::asio::const_buffer> ResponseHelperLibrary::to_buffers(Response& response) {
-    std::vector<boost::asio::const_buffer> buffers;
-    buffers.push_back(to_buffer(response.code_));
-
-    std::map<std::string, std::string>::iterator it;
-    for ( it = response.headers_.begin(); it != response.headers_.end(); it++) {
-      buffers.push_back(boost::asio::buffer(it->first));
-      buffers.push_back(boost::asio::buffer(misc_strings::name_value_separator));
-      buffers.push_back(boost::asio::buffer(it->second));
-      buffers.push_back(boost::asio::buffer(misc_strings::crlf));
-    }
-    buffers.push_back(boost::asio::buffer(misc_strings::crlf));
-    buffers.push_back(boost::asio::buffer(response.body_));
-    return buffers;
+    - A response is two buffers, its head and its body, instead of four per header.
+    Heads of responses without a body sit back to back, so they share a buffer with
+    the next head. The heads are sized first so the block is borrowed once; a head
+    too big for the largest pooled block is gathered from the response's own strings.
+    That head goes without a Date, whose cached bytes change under a pending write. */
+void ResponseHelperLibrary::to_buffers(const std::vector<Response>& responses, pooled_buffer& heads,
+                                       std::vector<boost::asio::const_buffer>& buffers) {
+    to_buffers(responses.data(), responses.size(), heads, buffers);
 }
 
-/* Returns a stock response for 400 and 404 request types.
+void ResponseHelperLibrary::to_buffers(const Response* responses, std::size_t count, pooled_buffer& heads,
+                                       std::vector<boost::asio::const_buffer>& buffers) {
+    heads.consume(heads.size());
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      total += head_size(responses[i]);
+    }
+    heads.reserve(total);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      const Response& response = responses[i];
+      std::size_t size = head_size(response);
+      if (size <= heads.tail_capacity()) {
+        char* begin = heads.tail();
+        heads.commit(write_head(response, begin) - begin);
+        if (!buffers.empty() &&
+            static_cast<const char*>(buffers.back().data()) + buffers.back().size() == begin) {
+          buffers.back() = boost::asio::buffer(buffers.back().data(), buffers.back().size() + size);
+        } else {
+          buffers.push_back(boost::asio::buffer(begin, size));
+        }
+      } else {
+        boost::asio::const_buffer line = to_buffer(response.code_);
+        if (response.http_version_minor_ == 0) {
+          buffers.push_back(boost::asio::buffer(misc_strings::http_1_0));
+          line += sizeof(misc_strings::http_1_0);
+        }
+        buffers.push_back(line);
+        spliced_headers lines = spliced(response);
+        if (!lines.first.empty()) {
+          std::string_view server = header_cache::server_line();
+          buffers.push_back(boost::asio::buffer(server.data(), server.size()));
+        }
+        for (const header_entry& header : response.headers_) {
+          buffers.push_back(boost::asio::buffer(header.name));
+          buffers.push_back(boost::asio::buffer(misc_strings::name_value_separator));
+          buffers.push_back(boost::asio::buffer(header.value));
+          buffers.push_back(boost::asio::buffer(misc_strings::crlf));
+        }
+        if (!lines.connection.empty()) {
+          buffers.push_back(boost::asio::buffer(lines.connection.data(), lines.connection.size()));
+        }
+        buffers.push_back(boost::asio::buffer(misc_strings::crlf));
+      }
+      std::string_view body = response.body();
+      if (!body.empty() && !response.body_producer_) {
+        buffers.push_back(boost::asio::buffer(body.data(), body.size()));
+      }
+    }
+}
+
+/* boost::asio::const_buffer ResponseHelperLibrary::frame_chunk(char* data, std::size_t size)
+Parameter(s):
+    - data: the chunk's data, with chunk_head_room bytes free before it and
+    chunk_tail_room after it.
+    - size: bytes of data, more than 0.
+Returns:
+    - The framed chunk, which starts somewhere in the room before data.
+Description:
+    - The size line is written backwards from data, so the data is framed where the
+    producer put it instead of being copied behind its size. */
+boost::asio::const_buffer ResponseHelperLibrary::frame_chunk(char* data, std::size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    char* begin = data - 2;
+    begin[0] = '\r';
+    begin[1] = '\n';
+    std::size_t left = size;
+    do {
+      *--begin = digits[left & 0xf];
+      left >>= 4;
+    } while (left != 0);
+    data[size] = '\r';
+    data[size + 1] = '\n';
+    return boost::asio::buffer(begin, data + size + 2 - begin);
+}
+
+boost::asio::const_buffer ResponseHelperLibrary::last_chunk() {
+    static const char last[] = "0\r\n\r\n";
+    return boost::asio::buffer(last, sizeof(last) - 1);
+}
+
+/* Returns a stock response for 400, 404, 413, 414, 431, 502 and 503 request types.
 (See response_helper_library for all stock response strings) */
 std::string ResponseHelperLibrary::to_string(Response::StatusCode status) {
   switch (status) {
@@ -76,19 +242,62 @@ std::string ResponseHelperLibrary::to_string(Response::StatusCode status) {
     case Response::not_found: {
       return stock_responses::not_found;
     }
+    case Response::payload_too_large: {
+      return stock_responses::payload_too_large;
+    }
+    case Response::uri_too_long: {
+      return stock_responses::uri_too_long;
+    }
+    case Response::request_header_fields_too_large: {
+      return stock_responses::request_header_fields_too_large;
+    }
+    case Response::bad_gateway: {
+      return stock_responses::bad_gateway;
+    }
+    case Response::service_unavailable: {
+      return stock_responses::service_unavailable;
+    }
     default:
       return stock_responses::bad_request;
   }
 }
 
+/* std::shared_ptr<const std::string> ResponseHelperLibrary::stock_body(Response::StatusCode status)
+Parameter(s):
+    - status: status of the response.
+Returns:
+    - The body to_string gives for status, shared.
+Description:
+    - The pages are made the first time any is asked for, and never change after, so
+    every thread's responses may point at the same ones. */
+std::shared_ptr<const std::string> ResponseHelperLibrary::stock_body(Response::StatusCode status) {
+  static const Response::StatusCode stocked[] = {
+    Response::bad_request, Response::not_found, Response::payload_too_large, Response::uri_too_long,
+    Response::request_header_fields_too_large, Response::bad_gateway, Response::service_unavailable
+  };
+  static const std::vector<std::shared_ptr<const std::string>> bodies = [] {
+    std::vector<std::shared_ptr<const std::string>> made;
+    for (Response::StatusCode stock : stocked) {
+      made.push_back(std::make_shared<const std::string>(to_string(stock)));
+    }
+    return made;
+  }();
+  for (std::size_t i = 0; i < bodies.size(); ++i) {
+    if (stocked[i] == status) {
+      return bodies[i];
+    }
+  }
+  return bodies[0];
+}
+
 /* Returns a stock response for valid requests.
 (See response_helper_library for all stock response strings) */
 Response ResponseHelperLibrary::stock_response(Response::StatusCode status) {
   Response response;
 
   response.code_ = status;
-  response.body_ = to_string(status);
-  response.headers_["Content-Length"] = std::to_string(response.body_.size());
-  response.headers_["Content-Type"] = "text/html";
+  response.shared_body_ = stock_body(status);
+  response.headers_[header_id::content_length] = std::to_string(response.shared_body_->size());
+  response.headers_[header_id::content_type] = "text/html";
   return response;
 }
@@ -16,12 +16,20 @@ Date Created:
     April 8th, 2020
 */
 
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
 
 #include "server.h"
+#include "server_metrics.h"
 #include "session.h"
 
 #include <boost/log/core.hpp>
@@ -39,36 +47,326 @@ namespace attrs = boost::log::attributes;
 
 using boost::asio::ip::tcp;
 
-server::server(boost::asio::io_service& io_service, int port_number, request_dispatcher* request_dispatcher) :
-                                io_service_(io_service), request_dispatcher_(request_dispatcher), acceptor_(io_service,
-                                tcp::endpoint(tcp::v4(), port_number)) {
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port_option;
+
+/* server Constructor
+Parameter(s):
+    - io_service: io_service that runs this server's acceptor and every session it accepts.
+    - config: parsed config. Supplies the port, reuseport, the listen and accept settings and
+    the session timeouts, and must outlive the server.
+    - request_dispatcher: dispatcher shared by all sessions.
+    - admission_control: connection and request limits shared by all servers.
+    - response_compressor: response compression shared by all sessions.
+    - listen_fd: listening socket inherited from the process this one upgraded, or -1.
+Description:
+    - Opens, binds and listens on the acceptor, or adopts listen_fd, then starts
+    accept_concurrency accepts. With reuseport on, SO_REUSEPORT lets one server per
+    io_service bind the same port so the kernel spreads new connections across them. An
+    adopted socket keeps the connections already queued on it, so a hot upgrade refuses
+    none. */
+server::server(boost::asio::io_service& io_service, const NginxConfig& config,
+               request_dispatcher* request_dispatcher, admission_control* admission_control,
+               const response_compressor* response_compressor, int listen_fd) :
+                                io_service_(io_service), acceptor_(io_service), config_(config),
+                                request_dispatcher_(request_dispatcher), admission_control_(admission_control),
+                                timing_wheel_(io_service), uring_(create_uring(io_service, config)),
+                                session_pool_(io_service, request_dispatcher, admission_control, response_compressor,
+                                              &timing_wheel_, &config, uring_.get()) {
+        if (listen_fd >= 0) {
+                acceptor_.assign(tcp::v4(), listen_fd);
+                BOOST_LOG_TRIVIAL(info) << "Accepting on inherited listening fd " << listen_fd;
+        } else {
+                tcp::endpoint endpoint(tcp::v4(), config.port_number);
+                acceptor_.open(endpoint.protocol());
+                acceptor_.set_option(tcp::acceptor::reuse_address(true));
+                if (config.reuse_port) {
+                        acceptor_.set_option(reuse_port_option(true));
+                }
+                acceptor_.bind(endpoint);
+                acceptor_.listen(config.listen_backlog > 0 ?
+                                 config.listen_backlog : tcp::acceptor::max_listen_connections);
+        }
+        // The accept loop calls accept4 until the queue is empty, so it must not block.
+        acceptor_.non_blocking(true);
 
         BOOST_LOG_TRIVIAL(info) << "ProcessID of server is: " << getpid();
 
-        start_accept();
+        timing_wheel_.start();
+        // With io_uring a single multishot accept replaces the readiness waits.
+        std::size_t accept_concurrency = uring_ ? 1 : std::max(config.accept_concurrency, 1);
+        accept_op_.on_complete = boost::bind(&server::handle_uring_accept, this, _1, _2);
+        // handle_drain() holds one more so the acceptor outlives its cancel().
+        accept_slots_ = accept_concurrency + 1;
+        for (std::size_t slot = 0; slot < accept_concurrency; ++slot) {
+                accept_backoff_timers_.emplace_back(new boost::asio::steady_timer(io_service));
+        }
+        for (std::size_t slot = 0; slot < accept_concurrency; ++slot) {
+                start_accept(slot);
+        }
+}
+
+/* io_uring_context* server::create_uring(boost::asio::io_service& io_service, const NginxConfig& config)
+Parameter(s):
+    - io_service: io_service the server runs on.
+    - config: parsed config, supplies io_backend and reuseport.
+Returns:
+    - a new io_uring_context, or nullptr to use the asio reactor.
+Description:
+    - Falls back to the reactor, with a warning, when io_uring was asked for but cannot be
+    set up. Outside sharded mode several threads share the io_service, so completions are
+    posted for any of them to run. */
+io_uring_context* server::create_uring(boost::asio::io_service& io_service, const NginxConfig& config) {
+        if (config.io_backend != NginxConfig::IO_BACKEND_IO_URING) {
+                return nullptr;
+        }
+        try {
+                return new io_uring_context(io_service, !config.reuse_port);
+        } catch (boost::system::system_error& e) {
+                BOOST_LOG_TRIVIAL(warning) << "io_uring unavailable, using epoll: " << e.what();
+                return nullptr;
+        }
+}
+
+/* int server::native_listen_handle()
+Parameter(s):
+    - N/A
+Returns:
+    - fd of the listening socket, to hand to an upgraded process.
+Description:
+    - Only meaningful before drain() closes the acceptor. */
+int server::native_listen_handle() {
+    return acceptor_.native_handle();
+}
+
+/* void server::start_accept(std::size_t slot)
+Parameter(s):
+    - slot: which of the outstanding accepts this is.
+Returns:
+    - N/A
+Description:
+    - Waits for the acceptor to become readable. Waiting on readiness instead of posting an
+    async_accept lets handle_accept take the whole queue with accept4 in one go. Several
+    slots may be drained by different threads at once when they share the io_service; they
+    only read the acceptor, and the kernel hands each connection to exactly one accept4.
+    With io_uring, one multishot accept takes every connection instead; under a
+    max_connections limit each accept is single-shot and claims its connection slot first,
+    so connections over the limit stay queued in the kernel as they do with epoll. */
+void server::start_accept(std::size_t slot) {
+    if (uring_) {
+        bool multishot = config_.max_connections == 0;
+        if (!multishot && !admission_control_->try_open_connection()) {
+            if (admission_control_->draining()) {
+                stop_accept_slot();
+            } else {
+                server_metrics::get().accept_pauses.fetch_add(1, std::memory_order_relaxed);
+                pause_accept(slot, accept_pause_ms);
+            }
+            return;
+        }
+        uring_->async_accept(acceptor_.native_handle(), config_.accept_flags, multishot, accept_op_);
+        return;
+    }
+    acceptor_.async_wait(tcp::acceptor::wait_read,
+                         boost::bind(&server::handle_accept, this, slot,
+                         boost::asio::placeholders::error));
+}
+
+/* void server::handle_accept(std::size_t slot, const boost::system::error_code& error)
+Parameter(s):
+    - slot: which of the outstanding accepts woke up.
+    - error: error from waiting on the acceptor.
+Returns:
+    - N/A
+Description:
+    - Accepts connections until the queue is empty or accept_batch_limit is reached, starts
+    a pooled session on each, and then waits again. When max_connections are open the slot
+    pauses for accept_pause_ms, and when accept4 runs out of descriptors or memory it backs
+    off for accept_backoff_ms, instead of spinning. */
+void server::handle_accept(std::size_t slot, const boost::system::error_code& error) {
+    if (admission_control_->draining()) {
+        stop_accept_slot();
+        return;
+    }
+    if (error) {
+        if (error != boost::asio::error::operation_aborted) {
+            BOOST_LOG_TRIVIAL(error) << "Error waiting for connections: " << error.message();
+            start_accept(slot);
+        }
+        return;
+    }
+
+    std::size_t accepted = 0;
+    while (accepted < accept_batch_limit) {
+        // Leave connections queued in the kernel rather than go over max_connections.
+        if (!admission_control_->try_open_connection()) {
+            server_metrics::get().record_accept_batch(accepted, false);
+            if (admission_control_->draining()) {
+                stop_accept_slot();
+            } else {
+                server_metrics::get().accept_pauses.fetch_add(1, std::memory_order_relaxed);
+                pause_accept(slot, accept_pause_ms);
+            }
+            return;
+        }
+
+        tcp::endpoint remote_endpoint;
+        socklen_t address_length = remote_endpoint.capacity();
+        int socket_fd = ::accept4(acceptor_.native_handle(), remote_endpoint.data(),
+                                  &address_length, config_.accept_flags);
+        if (socket_fd < 0) {
+            admission_control_->close_connection();
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                server_metrics::get().accept_errors.fetch_add(1, std::memory_order_relaxed);
+                BOOST_LOG_TRIVIAL(error) << "Error accepting session: " << strerror(errno);
+                server_metrics::get().record_accept_batch(accepted, false);
+                pause_accept(slot, accept_backoff_ms);
+                return;
+            }
+            break;
+        }
+        remote_endpoint.resize(address_length);
+        ++accepted;
+        start_session(socket_fd, remote_endpoint);
+    }
+    server_metrics::get().record_accept_batch(accepted, accepted == accept_batch_limit);
+    start_accept(slot);
 }
 
-//  Accepts new session created.
-void server::start_accept() {
-    session* new_session = new session(io_service_, request_dispatcher_);
-    acceptor_.async_accept(new_session->socket(),
-                                                boost::bind(&server::handle_accept,
-                                                this, new_session,
-                                                boost::asio::placeholders::error));
+/* void server::handle_uring_accept(int result, unsigned flags)
+Parameter(s):
+    - result: fd of the accepted connection, or a negative errno.
+    - flags: completion flags, telling whether a multishot accept is still armed.
+Returns:
+    - N/A
+Description:
+    - Starts a session on the connection and, once the accept is no longer armed, accepts
+    again, backs off after an error, or retires when draining. A multishot accept only runs
+    without a connection limit and counts the connection now; one it takes after a drain
+    started is still served, like a connection already taken with accept4. */
+void server::handle_uring_accept(int result, unsigned flags) {
+    bool multishot = config_.max_connections == 0;
+    bool transient_error = result == -ECANCELED || result == -ECONNABORTED || result == -EINTR ||
+        result == -EAGAIN;
+    if (result >= 0) {
+        if (multishot) {
+            admission_control_->open_connection();
+        }
+        server_metrics::get().record_accept_batch(1, false);
+        tcp::endpoint remote_endpoint;
+        socklen_t address_length = remote_endpoint.capacity();
+        if (::getpeername(result, remote_endpoint.data(), &address_length) == 0) {
+            remote_endpoint.resize(address_length);
+        }
+        start_session(result, remote_endpoint);
+    } else {
+        if (!multishot) {
+            admission_control_->close_connection();
+        }
+        if (!transient_error) {
+            server_metrics::get().accept_errors.fetch_add(1, std::memory_order_relaxed);
+            BOOST_LOG_TRIVIAL(error) << "Error accepting session: " << strerror(-result);
+        }
+    }
+
+    if (io_uring_context::more_completions(flags)) {
+        if (admission_control_->draining()) {
+            uring_->async_cancel(accept_op_);
+        }
+        return;
+    }
+    if (admission_control_->draining()) {
+        stop_accept_slot();
+    } else if (result < 0 && !transient_error) {
+        pause_accept(0, accept_backoff_ms);
+    } else {
+        start_accept(0);
+    }
 }
 
-//  Creates new session for the user.
-void server::handle_accept(session* new_session, const boost::system::error_code& error) {
-        if (!error)	{
-                boost::system::error_code ec;
-                boost::asio::ip::tcp::endpoint endpoint = new_session->socket().remote_endpoint(ec);
-                BOOST_LOG_TRIVIAL(info) << "Successfully started new session.";
-                BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Client_IP: " << endpoint;
+void server::pause_accept(std::size_t slot, int pause_ms) {
+    accept_backoff_timers_[slot]->expires_after(std::chrono::milliseconds(pause_ms));
+    accept_backoff_timers_[slot]->async_wait(boost::bind(&server::handle_accept_backoff,
+        this, slot, boost::asio::placeholders::error));
+}
 
-        new_session->start();
+void server::handle_accept_backoff(std::size_t slot, const boost::system::error_code& error) {
+    if (error) {
+        return;
+    }
+    if (admission_control_->draining()) {
+        stop_accept_slot();
     } else {
-                BOOST_LOG_TRIVIAL(error) << "Error accepting session.";
-        delete new_session;
+        start_accept(slot);
+    }
+}
+
+/* void server::stop_accept_slot()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Retires one outstanding accept for good. The last one closes the listening socket,
+    so no accept handler can be using it any more, and the kernel then refuses new
+    connections instead of queueing them for a server that will never take them. */
+void server::stop_accept_slot() {
+    if (accept_slots_.fetch_sub(1) == 1) {
+        boost::system::error_code ignored_ec;
+        acceptor_.close(ignored_ec);
+        BOOST_LOG_TRIVIAL(info) << "Stopped accepting connections.";
     }
-    start_accept();
+}
+
+/* void server::drain()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Starts a graceful shutdown of this server once admission_control is draining, from
+    any thread. The outstanding accepts wake up and retire, and every session that is idle
+    between requests is told to close. Sessions busy with a request finish it, answer with
+    "Connection: close" and then close too. */
+void server::drain() {
+    io_service_.post(boost::bind(&server::handle_drain, this));
+}
+
+void server::handle_drain() {
+    boost::system::error_code ignored_ec;
+    acceptor_.cancel(ignored_ec);
+    if (uring_) {
+        uring_->async_cancel(accept_op_);
+    }
+    stop_accept_slot();
+    std::size_t idle_sessions = timing_wheel_.expire_idle();
+    BOOST_LOG_TRIVIAL(info) << "Draining, closing " << idle_sessions << " idle sessions.";
+}
+
+/* void server::start_session(int socket_fd, const tcp::endpoint& remote_endpoint)
+Parameter(s):
+    - socket_fd: descriptor of the accepted connection.
+    - remote_endpoint: client address filled in by accept4.
+Returns:
+    - N/A
+Description:
+    - Hands the connection to a session from the pool and starts it. The session gives
+    the connection slot back when it closes. */
+void server::start_session(int socket_fd, const tcp::endpoint& remote_endpoint) {
+    session* new_session = session_pool_.acquire();
+    boost::system::error_code ec;
+    new_session->socket().assign(tcp::v4(), socket_fd, ec);
+    if (ec) {
+        BOOST_LOG_TRIVIAL(error) << "Error starting session: " << ec.message();
+        ::close(socket_fd);
+        admission_control_->close_connection();
+        session_pool_.release(new_session);
+        return;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Successfully started new session.";
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Client_IP: " << remote_endpoint;
+    new_session->start();
 }
@@ -16,16 +16,26 @@ Date Created:
     April 8th, 2020
 */
 
+#include <cerrno>
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <boost/bind.hpp>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <signal.h>
 #include <stdio.h>
+#include <sys/wait.h>
 
+#include "admission_control.h"
+#include "response_compressor.h"
+#include "listener_handoff.h"
 #include "server.h"
+#include "server_metrics.h"
 #include "session.h"
 #include "config_parser.h"
+#include "io_service_pool.h"
 
 #include <boost/log/core.hpp>
 #include <boost/log/trivial.hpp>
@@ -35,9 +45,6 @@ Date Created:
 #include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
-#include <boost/thread/thread.hpp>
-
-const int THREAD_POOL_SIZE = 4;
 
 using boost::asio::ip::tcp;
 
@@ -78,24 +85,138 @@ void logging_init() {
     logging::trivial::severity >= logging::trivial::info);
 }
 
-void handle_sigterm(int sig) {
-  BOOST_LOG_TRIVIAL(info) << "Program terminated with SIGTERM";
-  exit(1);
-}
+/* Handles the process signals. The first SIGTERM or SIGINT drains every server and
+waits for the open connections to close, stopping the io_services once they have or
+once drain_timeout has passed. A second signal stops them right away. SIGUSR2 starts
+a hot upgrade: the binary is exec'd again with the listening sockets handed over, and
+this process drains once the new one reports it holds them. */
+class signal_controller {
+ public:
+  signal_controller(boost::asio::io_service& io_service, io_service_pool& pool,
+                    std::vector<std::unique_ptr<server> >& servers,
+                    admission_control& admission, int drain_timeout_ms, char* argv[])
+      : signals_(io_service, SIGINT, SIGTERM), drain_timer_(io_service),
+        upgrade_ready_(io_service), upgrade_pid_(-1), pool_(pool), servers_(servers),
+        admission_(admission), drain_timeout_(drain_timeout_ms), argv_(argv) {
+    signals_.add(SIGUSR2);
+    wait_for_signal();
+  }
 
-void handle_sigint(int sig) {
-  BOOST_LOG_TRIVIAL(info) << "Program terminated with SIGINT";
-  exit(1);
-}
+ private:
+  void wait_for_signal() {
+    signals_.async_wait(boost::bind(&signal_controller::handle_signal, this,
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::signal_number));
+  }
+
+  void handle_signal(const boost::system::error_code& error, int signal_number) {
+    if (error) {
+      return;
+    }
+    if (signal_number == SIGUSR2) {
+      start_upgrade();
+      wait_for_signal();
+      return;
+    }
+    const char* signal_name = signal_number == SIGTERM ? "SIGTERM" : "SIGINT";
+    if (admission_.draining()) {
+      BOOST_LOG_TRIVIAL(info) << "Program terminated with " << signal_name << " while draining";
+      pool_.stop();
+      return;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Received " << signal_name << ", draining connections for up to "
+      << drain_timeout_.count() << "ms";
+    begin_drain();
+    wait_for_signal();
+  }
+
+  void begin_drain() {
+    admission_.begin_drain();
+    for (std::size_t i = 0; i < servers_.size(); ++i) {
+      servers_[i]->drain();
+    }
+    drain_deadline_ = std::chrono::steady_clock::now() + drain_timeout_;
+    check_drained(boost::system::error_code());
+  }
+
+  void check_drained(const boost::system::error_code& error) {
+    if (error) {
+      return;
+    }
+    int open_connections = server_metrics::get().active_connections.load();
+    if (open_connections == 0) {
+      BOOST_LOG_TRIVIAL(info) << "Program terminated after draining all connections";
+      pool_.stop();
+    } else if (std::chrono::steady_clock::now() >= drain_deadline_) {
+      BOOST_LOG_TRIVIAL(info) << "Program terminated at drain deadline with "
+        << open_connections << " connection(s) still open";
+      pool_.stop();
+    } else {
+      drain_timer_.expires_after(std::chrono::milliseconds(drain_poll_ms));
+      drain_timer_.async_wait(boost::bind(&signal_controller::check_drained, this,
+                              boost::asio::placeholders::error));
+    }
+  }
+
+  void start_upgrade() {
+    if (admission_.draining() || upgrade_pid_ > 0) {
+      BOOST_LOG_TRIVIAL(warning) << "Ignoring SIGUSR2, already draining or upgrading";
+      return;
+    }
+    std::vector<int> listen_fds;
+    for (std::size_t i = 0; i < servers_.size(); ++i) {
+      listen_fds.push_back(servers_[i]->native_listen_handle());
+    }
+    int ready_fd = -1;
+    upgrade_pid_ = listener_handoff::spawn(argv_, listen_fds, &ready_fd);
+    if (upgrade_pid_ < 0) {
+      BOOST_LOG_TRIVIAL(error) << "Could not start upgraded process: " << std::strerror(errno);
+      return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Received SIGUSR2, started upgraded process " << upgrade_pid_;
+    upgrade_ready_.assign(ready_fd);
+    upgrade_ready_.async_read_some(boost::asio::buffer(&upgrade_byte_, 1),
+                                   boost::bind(&signal_controller::handle_upgrade_ready, this,
+                                   boost::asio::placeholders::error,
+                                   boost::asio::placeholders::bytes_transferred));
+  }
+
+  void handle_upgrade_ready(const boost::system::error_code& error, std::size_t bytes_transferred) {
+    boost::system::error_code ignored_ec;
+    upgrade_ready_.close(ignored_ec);
+    if (!error && bytes_transferred == 1) {
+      BOOST_LOG_TRIVIAL(info) << "Upgraded process " << upgrade_pid_
+        << " is accepting, draining connections for up to " << drain_timeout_.count() << "ms";
+      begin_drain();
+      return;
+    }
+    // The new process exited before taking over; keep serving and allow another try.
+    BOOST_LOG_TRIVIAL(error) << "Upgraded process " << upgrade_pid_
+      << " exited before accepting, upgrade cancelled";
+    ::waitpid(upgrade_pid_, nullptr, WNOHANG);
+    upgrade_pid_ = -1;
+  }
+
+  enum { drain_poll_ms = 50 };
+
+  boost::asio::signal_set signals_;
+  boost::asio::steady_timer drain_timer_;
+  boost::asio::posix::stream_descriptor upgrade_ready_;
+  char upgrade_byte_;
+  pid_t upgrade_pid_;
+  io_service_pool& pool_;
+  std::vector<std::unique_ptr<server> >& servers_;
+  admission_control& admission_;
+  std::chrono::milliseconds drain_timeout_;
+  std::chrono::steady_clock::time_point drain_deadline_;
+  char** argv_;
+};
 
 int main(int argc, char* argv[]) {
   logging_init();
   logging::add_common_attributes();   // LineID, TimeStamp, ProcessID, ThreadID
 
-
-  signal(SIGTERM, handle_sigterm);
-  signal(SIGINT, handle_sigint);
-
   try {
     if (argc != 2) {
       BOOST_LOG_TRIVIAL(error) << "Usage: async_tcp_echo_server \
@@ -107,30 +228,41 @@ int main(int argc, char* argv[]) {
     NginxConfig config;
     config_parser.Parse(argv[1], &config);
 
-    boost::asio::io_service io_service;
-
     if (config.port_number < 0) {
       BOOST_LOG_TRIVIAL(error) << "Could not find valid port number in config";
       return 1;
     }
 
+    listener_handoff handoff;
     request_dispatcher rd(config);
+    admission_control admission(config, rd);
+    response_compressor compressor(config, rd);
 
-    server s(io_service, config.port_number, &rd);
-    BOOST_LOG_TRIVIAL(info) << "Successfully started web server \
-using port number "<< config.port_number;
+    std::size_t worker_threads = config.worker_threads > 0 ?
+      config.worker_threads : io_service_pool::available_cpus();
+    bool pin_threads = config.worker_cpu_affinity == NginxConfig::CPU_AFFINITY_ON ||
+      (config.worker_cpu_affinity == NginxConfig::CPU_AFFINITY_AUTO && config.reuse_port);
+
+    // Sharded (reuseport) mode: one io_service, thread and SO_REUSEPORT acceptor per core,
+    // so a session stays on the core that accepted it. Otherwise all threads share one.
+    io_service_pool pool(config.reuse_port ? worker_threads : 1,
+                         config.reuse_port ? 1 : worker_threads, pin_threads);
 
-    // Create a pool of threads to run all of the io_services.
-    std::vector<boost::shared_ptr<boost::thread> > threads;
-    for (std::size_t i = 0; i < THREAD_POOL_SIZE; ++i) {
-      boost::shared_ptr<boost::thread> thread(new boost::thread(
-            boost::bind(&boost::asio::io_service::run, &io_service)));
-      threads.push_back(thread);
+    // After a hot upgrade the servers take over the old process's listening sockets.
+    std::vector<std::unique_ptr<server> > servers;
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+      servers.emplace_back(new server(pool.get_io_service(i), config, &rd, &admission, &compressor,
+                                      handoff.take(i, config.port_number)));
     }
+    // Signals are handled on the first io_service once the pool runs.
+    signal_controller signals(pool.get_io_service(0), pool, servers, admission,
+                              config.drain_timeout_ms, argv);
+    handoff.notify_ready();
+    BOOST_LOG_TRIVIAL(info) << "Successfully started web server \
+using port number "<< config.port_number;
 
-    // Wait for all threads in the pool to exit.
-    for (std::size_t i = 0; i < threads.size(); ++i)
-      threads[i]->join();
+    // Run the io_services, blocking until all threads in the pool exit.
+    pool.run();
   } catch (std::exception& e) {
     std::cerr << "Exception: " << e.what() << "\n";
   }
@@ -0,0 +1,63 @@
+/* server_metrics.cc
+Description:
+    Process wide counters reported by the status handler.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include "server_metrics.h"
+
+server_metrics& server_metrics::get() {
+    static server_metrics metrics;
+    return metrics;
+}
+
+/* void server_metrics::record_accept_batch(std::uint64_t batch_size, bool hit_limit)
+Parameter(s):
+    - batch_size: connections accepted in one wake-up of an accept loop.
+    - hit_limit: whether the loop stopped at its batch limit rather than an empty queue.
+Returns:
+    - N/A
+Description:
+    - Updates the accept counters. */
+void server_metrics::record_accept_batch(std::uint64_t batch_size, bool hit_limit) {
+    connections_accepted.fetch_add(batch_size, std::memory_order_relaxed);
+    accept_wakeups.fetch_add(1, std::memory_order_relaxed);
+    if (hit_limit) {
+        accept_batch_limit_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::uint64_t largest = largest_accept_batch.load(std::memory_order_relaxed);
+    while (batch_size > largest &&
+           !largest_accept_batch.compare_exchange_weak(largest, batch_size, std::memory_order_relaxed)) {
+    }
+}
+
+std::string server_metrics::report() const {
+    std::string report = "Accept queue:\r\n";
+    report += "Connections accepted: " + std::to_string(connections_accepted.load()) + "\r\n";
+    report += "Accept wake-ups: " + std::to_string(accept_wakeups.load()) + "\r\n";
+    report += "Wake-ups stopped at batch limit: " + std::to_string(accept_batch_limit_hits.load()) + "\r\n";
+    report += "Largest accept batch: " + std::to_string(largest_accept_batch.load()) + "\r\n";
+    report += "Accept errors: " + std::to_string(accept_errors.load()) + "\r\n";
+    report += "Admission control:\r\n";
+    report += "Active connections: " + std::to_string(active_connections.load()) + "\r\n";
+    report += "Requests in flight: " + std::to_string(requests_in_flight.load()) + "\r\n";
+    report += "Requests shed: " + std::to_string(requests_shed.load()) + "\r\n";
+    report += "Accept pauses: " + std::to_string(accept_pauses.load()) + "\r\n";
+    report += "Request limits:\r\n";
+    report += "URIs too long: " + std::to_string(uri_too_long.load()) + "\r\n";
+    report += "Headers too large: " + std::to_string(header_too_large.load()) + "\r\n";
+    report += "Bodies too large: " + std::to_string(body_too_large.load()) + "\r\n";
+    report += "Compression:\r\n";
+    report += "Responses compressed: " + std::to_string(responses_compressed.load()) + "\r\n";
+    report += "Compressed at a lower level: " + std::to_string(compression_backoffs.load()) + "\r\n";
+    report += "Not compressed while busy: " + std::to_string(compression_skipped_busy.load()) + "\r\n";
+    return report;
+}
@@ -16,7 +16,12 @@ Date Created:
     April 11th, 2020
 */
 
+#include <strings.h>
+
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <boost/bind.hpp>
@@ -32,117 +37,870 @@ Date Created:
 #include <boost/log/sources/record_ostream.hpp>
 
 #include "session.h"
+#include "server_metrics.h"
+#include "session_pool.h"
 
 using boost::asio::ip::tcp;
 
-session::session(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher) : socket_(io_service), request_dispatcher_(request_dispatcher) {}
+// Interim response telling a client that sent Expect: 100-continue to go on with its body.
+static const char continue_response[] = "HTTP/1.1 100 Continue\r\n\r\n";
+
+session::session(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher,
+    admission_control* admission_control, const response_compressor* response_compressor,
+    timing_wheel* timing_wheel, const NginxConfig* config, io_uring_context* uring,
+    session_pool* session_pool) : socket_(io_service),
+    read_size_(buffer_pool::class_capacity(0)), direct_reads_(0), written_responses_(0), streaming_(false),
+    chunked_(false), body_left_(0), close_after_write_(false), final_write_(false), send_continue_(false),
+    body_handler_(nullptr), uring_(uring),
+    timing_wheel_(timing_wheel),
+    served_request_(false), config_(config), request_dispatcher_(request_dispatcher),
+    admission_control_(admission_control), response_compressor_(response_compressor),
+    session_pool_(session_pool) {
+    timer_.on_expire = boost::bind(&session::handle_timeout, this);
+    read_op_.on_complete = boost::bind(&session::handle_uring_read, this, _1, _2);
+    write_op_.on_complete = boost::bind(&session::handle_uring_write, this, _1, _2);
+    request_parser_.pause_before_body(true);
+    request_parser::limits limits;
+    limits.max_uri_size = config_->client_max_uri_size;
+    limits.max_header_size = config_->client_max_header_size;
+    limits.max_header_count = config_->client_max_header_count;
+    limits.max_body_size = config_->client_max_body_size;
+    request_parser_.set_limits(limits);
+    request_parser_.reset();
+}
+
+session::~session() {
+    timing_wheel_->cancel(timer_);
+}
 
 tcp::socket& session::socket() {
     return socket_;
 }
 
 void session::start() {
-    // Asynchronously reads data FROM the stream socket TO the buffer
-    memset(data_, '\0', max_length+1);
-    socket_.async_read_some(boost::asio::buffer(data_, max_length),
-                            boost::bind(&session::handle_read, this,
-                            boost::asio::placeholders::error,
-                            boost::asio::placeholders::bytes_transferred));
-    // After the read operation completes,
-    // we call boosts::binds() -> Read() Function
+    // Reads are attempted directly once the socket is readable, see handle_readable.
+    boost::system::error_code ignored_ec;
+    socket_.non_blocking(true, ignored_ec);
+    do_read();
     /* session::handle_read and session::handle_write
         go back and forth calling each other!
     */
 }
 
-/* Read and parses requests recieved, and if success, provided response for handle_write to read. */
+/* void session::do_read(bool wait_readable)
+Parameter(s):
+    - wait_readable: wait on the asio reactor even when the session uses io_uring.
+Returns:
+    - N/A
+Description:
+    - Waits until the socket is readable without holding a read buffer, so an idle
+    keep-alive session does not pin any buffer memory. With io_uring the receive itself is
+    queued instead, and the kernel only takes a provided buffer once data arrives. An idle session that finds the
+    server draining stops reading instead, the same way server::drain() tells the idle
+    sessions it finds (see handle_timeout). Checking after the timer is armed means a
+    drain either sees the armed timer or is seen here. */
+void session::do_read(bool wait_readable) {
+    arm_read_timer();
+    if (timer_.idle && admission_control_->draining()) {
+        boost::system::error_code ignored_ec;
+        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_receive, ignored_ec);
+    }
+    if (uring_ != nullptr && !wait_readable) {
+        uring_->async_recv(socket_.native_handle(), read_op_);
+        return;
+    }
+    socket_.async_wait(tcp::socket::wait_read,
+                       boost::bind(&session::handle_readable, this,
+                       boost::asio::placeholders::error));
+}
+
+/* void session::handle_readable(const boost::system::error_code& error)
+Parameter(s):
+    - error: error from waiting on the socket.
+Returns:
+    - N/A
+Description:
+    - Borrows a buffer from the thread's pool and reads whatever is available. If nothing
+    was there after all, the buffer goes straight back and we wait again. */
+void session::handle_readable(const boost::system::error_code& error) {
+    timing_wheel_->cancel(timer_);
+    if (error) {
+        close();
+        return;
+    }
+
+    read_buffer_.reserve(read_size_);
+    boost::system::error_code read_error;
+    size_t bytes_transferred = socket_.read_some(
+        boost::asio::buffer(read_buffer_.tail(), read_buffer_.tail_capacity()), read_error);
+    if (read_error == boost::asio::error::would_block || read_error == boost::asio::error::try_again) {
+        read_buffer_.release();
+        do_read();
+        return;
+    }
+    handle_read(read_error, bytes_transferred);
+}
+
+/* void session::handle_read(const boost::system::error_code& error, size_t bytes_transferred)
+Parameter(s):
+    - error: error from reading the socket.
+    - bytes_transferred: number of bytes read into read_buffer_.
+Returns:
+    - N/A
+Description:
+    - Parses what was read, then writes the responses of every request completed by it with
+    one gathered write. A read that filled the buffer is followed by another one straight
+    away, at most max_direct_reads times; after that the session waits on the reactor
+    like any other, so a fast upload cannot keep the thread from its other connections. */
 void session::handle_read(const boost::system::error_code& error, size_t bytes_transferred) {
     if (!error) {
-        // Asynchronously writes to the socket_ everything in the buffer.
-        request_parser::result_type result;
-        std::tie(result, std::ignore) = request_parser_.parse(
-              request_builder_, data_, data_ + bytes_transferred);
+        read_buffer_.commit(bytes_transferred);
+        bool filled_buffer = read_buffer_.tail_capacity() == 0;
 
-        BOOST_LOG_TRIVIAL(info) << "Parsing request...";
-        if (result == request_parser::good) {
-            Request req = request_builder_.build_request();
-            response_ = request_dispatcher_->get_handler(req.uri_)->handle_request(req);
+        parse_requests(read_buffer_.data(), read_buffer_.data() + read_buffer_.size());
+        // Complete requests were handled inside parse_requests and a partial one has
+        // been copied out by the parser, so the buffer can be handed back now.
+        read_buffer_.release();
 
-            if (request_dispatcher_->status_handler_enabled){
-                BOOST_LOG_TRIVIAL(info) << "Status handler enabled, recording request.";
-                request_dispatcher_->get_status_handler()->record_received_request(req.uri_, response_.code_);
-            }
+        if (filled_buffer) {
+            // More is probably waiting, so read it into a bigger buffer.
+            read_size_ = buffer_pool::class_capacity(buffer_pool::size_class(read_size_ + 1));
+        }
+        if (!responses_.empty() || send_continue_) {
+            direct_reads_ = 0;
+            write_responses();
+        } else if (filled_buffer && direct_reads_ < max_direct_reads) {  // Keep on Reading
+            ++direct_reads_;
+            handle_readable(boost::system::error_code());
+        } else {
+            direct_reads_ = 0;
+            do_read();
+        }
+    } else {
+        close();
+    }
+}
 
-            BOOST_LOG_TRIVIAL(info) << "Parsed request successfully.";
-            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]RequestPath: " << req.uri_;
-            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]ResponseCode: " << response_.code_;
-            BOOST_LOG_TRIVIAL(info) << req.method_ << " " << req.uri_ << " "
-            << req.version_ << " " << response_.code_ << " "
-            << request_builder_.fullmessage.size();
+/* void session::handle_uring_read(int result, unsigned flags)
+Parameter(s):
+    - result: bytes received, 0 at EOF, or a negative errno.
+    - flags: completion flags naming the provided buffer the bytes landed in.
+Returns:
+    - N/A
+Description:
+    - io_uring counterpart of handle_readable and handle_read. The provided buffer goes
+    back to the ring as soon as it is parsed. When every provided buffer is taken the
+    read is retried through the reactor into a buffer_pool buffer instead. */
+void session::handle_uring_read(int result, unsigned flags) {
+    timing_wheel_->cancel(timer_);
+    if (result == -ENOBUFS) {
+        do_read(true);
+        return;
+    }
+    if (result <= 0) {
+        uring_->recycle_buffer(flags);
+        close();
+        return;
+    }
 
+    const char* data = uring_->buffer(flags);
+    parse_requests(data, data + result);
+    uring_->recycle_buffer(flags);
+    if (!responses_.empty() || send_continue_) {
+        write_responses();
+    } else {
+        do_read();
+    }
+}
 
+/* void session::parse_requests(const char* begin, const char* end)
+Parameter(s):
+    - begin, end: bytes just read.
+Returns:
+    - N/A
+Description:
+    - Parses every complete request in the bytes (clients may pipeline several back to
+    back) and queues their responses in order. A partial request at the end stays in the
+    parser until the next read. When the head of a request with a body is complete its
+    handler may take the body as it arrives (see start_body_stream); bytes of such a body
+    go straight to the handler. */
+void session::parse_requests(const char* begin, const char* end) {
+    while (begin != end && !close_after_write_) {
+        if (body_consumer_) {
+            begin = stream_body(begin, end);
+            continue;
+        }
 
-          if (request_builder_.keep_alive) {
-              request_parser_.reset();
-              request_builder_ = request_builder();
+        request_parser::result_type result;
+        BOOST_LOG_TRIVIAL(info) << "Parsing request...";
+        std::tie(result, begin) = request_parser_.parse(request_builder_, begin, end);
 
-              boost::asio::async_write(socket_, ResponseHelperLibrary::to_buffers(response_),
-                  boost::bind(&session::handle_write, this,
-                  boost::asio::placeholders::error));
-          } else {
-              boost::asio::async_write(socket_, ResponseHelperLibrary::to_buffers(response_),
-                  boost::bind(&session::shutdown, this,
-                  boost::asio::placeholders::error));
-          }
+        if (result == request_parser::head_complete) {
+            start_body_stream();
+        } else if (result == request_parser::good) {
+            queue_response(dispatch_request());
         } else if (result == request_parser::bad) {  // Return a bad request Response if request parser can't parse properly
-            response_ = ResponseHelperLibrary::stock_response(Response::bad_request);
-            BOOST_LOG_TRIVIAL(error) << "Request is bad. Invalid request,\
+            queue_bad_request();
+        } else if (result != request_parser::indeterminate) {
+            queue_rejection(result);
+        }
+    }
+}
+
+/* void session::start_body_stream()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Applies the body limit of the request's location first, refusing a body already
+    over it with a 413. Then offers the body to the handler. If the handler takes it, the
+    request holds its admission slot until the body is done; if it does not (or the
+    request is over the in-flight limit) the parser goes on to buffer the body, and the
+    request is dispatched as usual once it is complete. dispatch_request tries for a slot
+    again then, and only a request that still gets none is counted as shed.
+    - A client that sent Expect: 100-continue is waiting for word before it sends the
+    body. It gets the 413, or the 503 if the request is over the in-flight limit, as a
+    final answer instead of the body being read only to be refused; otherwise it is told
+    to continue. */
+void session::start_body_stream() {
+    RequestView head = request_builder_.view();
+    request_handler* handler = request_dispatcher_->get_handler(head.path_);
+    if (!request_parser_.limit_body(admission_control_->max_body_size(handler))) {
+        queue_rejection(request_parser::body_too_large);
+        return;
+    }
+    bool expect_continue = expects_continue(head);
+    if (!admission_control_->try_start_request(handler)) {
+        if (expect_continue) {
+            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: shed";
+            const Response& shed = admission_control_->shed_request();
+            record_request(head, shed);
+            push_response(shed);
+            close_after_write_ = true;
+        }
+        return;
+    }
+    send_continue_ = expect_continue;
+    body_consumer_ = handler->start_body_stream(head);
+    if (body_consumer_) {
+        body_handler_ = handler;
+    } else {
+        admission_control_->finish_request(handler);
+    }
+}
+
+/* bool session::expects_continue(const RequestView& head) const
+Parameter(s):
+    - head: head of the request whose body is next.
+Returns:
+    - bool which is true if the client waits for 100 Continue before sending the body.
+Description:
+    - HTTP/1.0 clients do not know 100 Continue, so they never get one. */
+bool session::expects_continue(const RequestView& head) const {
+    if (request_builder_.http_version_major < 1 ||
+        (request_builder_.http_version_major == 1 && request_builder_.http_version_minor == 0)) {
+        return false;
+    }
+    std::string_view expect = head.header("Expect");
+    return expect.size() == 12 && strncasecmp(expect.data(), "100-continue", 12) == 0;
+}
+
+/* const char* session::stream_body(const char* begin, const char* end)
+Parameter(s):
+    - begin, end: bytes read, starting with more of the streamed body.
+Returns:
+    - How far the body went, so the rest can be parsed as the next request.
+Description:
+    - Hands the next run of body bytes to the handler's consumer (a chunked body arrives
+    already decoded), and queues its response once the body is complete. A body with bad
+    chunk framing is abandoned and answered with a 400, one whose chunks go over the body
+    limit with a 413. */
+const char* session::stream_body(const char* begin, const char* end) {
+    request_parser::result_type result;
+    std::string_view data;
+    std::tie(result, begin) = request_parser_.parse_body(request_builder_, begin, end, data);
+    if (!data.empty()) {
+        body_consumer_->on_data(data.data(), data.size());
+    }
+    if (result == request_parser::good) {
+        Response response = body_consumer_->on_complete();
+        response_compressor_->compress(request_builder_.view(), body_handler_, response);
+        end_body_stream();
+        record_request(request_builder_.view(), response);
+        queue_response(std::move(response));
+    } else if (result == request_parser::bad) {
+        end_body_stream();
+        queue_bad_request();
+    } else if (result != request_parser::indeterminate) {
+        end_body_stream();
+        queue_rejection(result);
+    }
+    return begin;
+}
+
+/* void session::end_body_stream()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Lets go of the consumer of a streamed body and the admission slot its request
+    holds. Destroying a consumer before on_complete tells it the body was abandoned. */
+void session::end_body_stream() {
+    body_consumer_.reset();
+    admission_control_->finish_request(body_handler_);
+    body_handler_ = nullptr;
+}
+
+/* Response session::dispatch_request()
+Parameter(s):
+    - N/A
+Returns:
+    - Response from the handler mapped to the request's URI.
+Description:
+    - Hands the handler a view of the request parsed into request_builder_, which
+    still points into the bytes just read, and records it for the status handler. Over
+    an in-flight limit the handler is skipped and the prebuilt 503 is returned instead. */
+Response session::dispatch_request() {
+    RequestView req = request_builder_.view();
+    request_handler* handler = request_dispatcher_->get_handler(req.path_);
+    Response response;
+    if (admission_control_->try_start_request(handler)) {
+        response = handler->handle_request(req);
+        admission_control_->finish_request(handler);
+        response_compressor_->compress(req, handler, response);
+    } else {
+        BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: shed";
+        response = admission_control_->shed_request();
+    }
+    record_request(req, response);
+    return response;
+}
+
+/* void session::record_request(const RequestView& req, const Response& response)
+Parameter(s):
+    - req: the request that was handled.
+    - response: what its handler answered.
+Returns:
+    - N/A
+Description:
+    - Records the request for the status handler and logs it. */
+void session::record_request(const RequestView& req, const Response& response) {
+    if (request_dispatcher_->status_handler_enabled){
+        BOOST_LOG_TRIVIAL(info) << "Status handler enabled, recording request.";
+        request_dispatcher_->get_status_handler()->record_received_request(std::string(req.uri_), response.code_);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Parsed request successfully.";
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]RequestPath: " << req.uri_;
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]ResponseCode: " << response.code_;
+    BOOST_LOG_TRIVIAL(info) << req.method_ << " " << req.uri_ << " "
+    << req.version_ << " " << response.code_ << " "
+    << request_builder_.message_size;
+}
+
+/* void session::push_response(Response response)
+Parameter(s):
+    - response: response to the request in request_builder_.
+Returns:
+    - N/A
+Description:
+    - Queues the response with the HTTP version of the request it answers: HTTP/1.0 for
+    an HTTP/1.0 request, otherwise HTTP/1.1, including for a request rejected before
+    its version was read. */
+void session::push_response(Response response) {
+    response.http_version_minor_ =
+        request_builder_.http_version_major == 1 && request_builder_.http_version_minor == 0 ? 0 : 1;
+    responses_.push_back(std::move(response));
+}
+
+/* void session::queue_bad_request()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Queues a 400 for a request the parser could not make sense of. Nothing after it on
+    the connection can be trusted, so the connection closes once it is written. */
+void session::queue_bad_request() {
+    send_continue_ = false;
+    push_response(ResponseHelperLibrary::stock_response(Response::bad_request));
+    BOOST_LOG_TRIVIAL(error) << "Request is bad. Invalid request,\
  shutting down session.";
-            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: 400";
-            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]RequestPath: 400";
-            BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]ResponseCode: 400";
-            boost::asio::async_write(socket_, ResponseHelperLibrary::to_buffers(response_),
-                boost::bind(&session::shutdown, this,
-                boost::asio::placeholders::error));
-        } else {  // Keep on Reading
-            memset(data_, '\0', max_length+1);
-            socket_.async_read_some(boost::asio::buffer(data_, max_length),
-                boost::bind(&session::handle_read, this,
-                boost::asio::placeholders::error,
-                boost::asio::placeholders::bytes_transferred));
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: 400";
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]RequestPath: 400";
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]ResponseCode: 400";
+    close_after_write_ = true;
+}
+
+/* void session::queue_rejection(request_parser::result_type result)
+Parameter(s):
+    - result: the limit the parser found the request over.
+Returns:
+    - N/A
+Description:
+    - Queues a 414, 431 or 413 for a request over a size limit and counts it. The rest
+    of the request is never read: the connection closes once the response is written,
+    and whatever the client still sends is discarded while lingering. */
+void session::queue_rejection(request_parser::result_type result) {
+    server_metrics& metrics = server_metrics::get();
+    Response::StatusCode status;
+    if (result == request_parser::uri_too_long) {
+        status = Response::uri_too_long;
+        metrics.uri_too_long.fetch_add(1, std::memory_order_relaxed);
+    } else if (result == request_parser::header_too_large) {
+        status = Response::request_header_fields_too_large;
+        metrics.header_too_large.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        status = Response::payload_too_large;
+        metrics.body_too_large.fetch_add(1, std::memory_order_relaxed);
+    }
+    send_continue_ = false;
+    push_response(ResponseHelperLibrary::stock_response(status));
+    BOOST_LOG_TRIVIAL(error) << "Request over a size limit, shutting down session.";
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: " << status;
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]RequestPath: " << status;
+    BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]ResponseCode: " << status;
+    close_after_write_ = true;
+}
+
+/* void session::queue_response(Response response)
+Parameter(s):
+    - response: response to the request just completed.
+Returns:
+    - N/A
+Description:
+    - Queues the response behind those of earlier pipelined requests, decides whether the
+    connection stays open after it, and readies the parser for the next request. */
+void session::queue_response(Response response) {
+    // The body came along without waiting, so the final response is all it needs.
+    send_continue_ = false;
+    push_response(std::move(response));
+    read_size_ = buffer_pool::class_capacity(0);
+    served_request_ = true;
+    header_deadline_ = std::chrono::steady_clock::time_point();
+    // Without keep-alive the connection closes after this response, so any
+    // request pipelined behind it is dropped.
+    close_after_write_ = !request_builder_.keep_alive;
+    if (admission_control_->draining()) {
+        // Keep-alive clients are told not to send anything more on this connection by
+        // the Connection: close write_responses puts on the last response.
+        close_after_write_ = true;
+    }
+    if (responses_.back().body_producer_) {
+        frame_body(responses_.back());
+    }
+    request_parser_.reset();
+    request_builder_ = request_builder();
+}
+
+/* void session::frame_body(Response& response)
+Parameter(s):
+    - response: queued response with a body_producer_.
+Returns:
+    - N/A
+Description:
+    - Says in the head how the client finds the end of a produced body: its
+    Content-Length when the producer knows it, otherwise chunked encoding. An HTTP/1.0
+    client knows neither framing but the end of the connection, so the connection
+    closes after such a body. */
+void session::frame_body(Response& response) {
+    long long size = response.body_producer_->size();
+    if (size >= 0) {
+        response.headers_[header_id::content_length] = std::to_string(size);
+        return;
+    }
+    response.headers_.erase(header_name(header_id::content_length));
+    if (response.http_version_minor_ == 1) {
+        response.headers_[header_id::transfer_encoding] = "chunked";
+    } else {
+        close_after_write_ = true;
+    }
+}
+
+/* void session::write_responses()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Writes the queued responses, in request order, with a single gathered write of
+    their heads (serialized together into write_heads_) and bodies. A response with a
+    produced body ends the write, with the first piece of its body; the responses
+    behind it wait until the rest of the body is written (see handle_write). A pending
+    100 Continue belongs to the request after all of them, so it goes last.
+    - Nothing is read after a response the connection closes behind, so that one is
+    always last, and its head tells the client the connection is closing. */
+void session::write_responses() {
+    if (close_after_write_ && !responses_.empty()) {
+        responses_.back().close_connection_ = true;
+    }
+    written_responses_ = 0;
+    while (written_responses_ < responses_.size() && !streaming_) {
+        streaming_ = responses_[written_responses_++].body_producer_ != nullptr;
+    }
+    ResponseHelperLibrary::to_buffers(responses_.data(), written_responses_, write_heads_, write_buffers_);
+    if (streaming_) {
+        const Response& response = responses_[written_responses_ - 1];
+        body_left_ = response.body_producer_->size();
+        chunked_ = body_left_ < 0 && response.http_version_minor_ == 1;
+        next_body_piece();
+    }
+    if (send_continue_ && !streaming_ && written_responses_ == responses_.size()) {
+        write_buffers_.push_back(boost::asio::buffer(continue_response, sizeof(continue_response) - 1));
+        send_continue_ = false;
+    }
+    start_write();
+}
+
+/* void session::next_body_piece()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Asks the producer of the body being written for its next piece and adds it to
+    write_buffers_, framed as a chunk if the body is chunked. Only one piece is out at
+    a time and the next is asked for once it is written, which is what holds a
+    producer to the pace of the client. The body ends with the last of its
+    Content-Length, or with the last chunk once the producer has nothing more.
+    - A producer that fails, or ends before its Content-Length, leaves the body
+    unfinished. The connection closes after what has been written so the client sees
+    it cut short, and the responses pipelined behind it are dropped. */
+void session::next_body_piece() {
+    Response& response = responses_[written_responses_ - 1];
+    std::size_t size = 0;
+    bool good = true;
+    if (body_left_ != 0) {
+        body_buffer_.consume(body_buffer_.size());
+        body_buffer_.reserve(buffer_pool::class_capacity(buffer_pool::num_size_classes / 2));
+        char* data = body_buffer_.tail() + ResponseHelperLibrary::chunk_head_room;
+        std::size_t capacity = body_buffer_.tail_capacity() - ResponseHelperLibrary::chunk_head_room -
+                               ResponseHelperLibrary::chunk_tail_room;
+        if (body_left_ > 0 && static_cast<unsigned long long>(body_left_) < capacity) {
+            capacity = body_left_;
+        }
+        good = response.body_producer_->read(data, capacity, size);
+        if (good && size > 0) {
+            write_buffers_.push_back(chunked_ ? ResponseHelperLibrary::frame_chunk(data, size) :
+                                     boost::asio::buffer(data, size));
+            if (body_left_ < 0) {
+                return;
+            }
+            body_left_ -= size;
+        } else if (body_left_ > 0) {
+            good = false;
+        }
+    }
+    if (good && body_left_ > 0) {
+        return;
+    }
+
+    if (!good) {
+        BOOST_LOG_TRIVIAL(error) << "Response body ended before it was complete, closing connection.";
+        close_after_write_ = true;
+        responses_.resize(written_responses_);
+    } else if (chunked_) {
+        write_buffers_.push_back(ResponseHelperLibrary::last_chunk());
+    }
+    response.body_producer_.reset();
+    streaming_ = false;
+}
+
+/* void session::start_write()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Sends write_buffers_. The write after which the connection closes is followed by
+    the shutdown, any other by handle_write. */
+void session::start_write() {
+    final_write_ = close_after_write_ && !streaming_ && written_responses_ == responses_.size();
+
+    // The send timeout covers the whole gathered write.
+    timer_.idle = false;
+    timing_wheel_->schedule(timer_, std::chrono::milliseconds(config_->send_timeout_ms));
+    if (uring_ != nullptr) {
+        write_iov_.clear();
+        for (std::size_t i = 0; i < write_buffers_.size(); ++i) {
+            iovec iov = { const_cast<void*>(write_buffers_[i].data()), write_buffers_[i].size() };
+            write_iov_.push_back(iov);
         }
-        // After the write operation completes,
-        // we call boosts::binds() -> The Write Function
+        start_uring_write();
+    } else if (final_write_) {
+        boost::asio::async_write(socket_, write_buffers_,
+            boost::bind(&session::shutdown, this,
+            boost::asio::placeholders::error));
     } else {
-        delete this;
+        boost::asio::async_write(socket_, write_buffers_,
+            boost::bind(&session::handle_write, this,
+            boost::asio::placeholders::error));
     }
 }
 
-/* Writes data from handle_read to the buffer. */
-void session::handle_write(const boost::system::error_code& error) {
-    if (!error) {
-        // Asynchronously reads data FROM the stream socket TO the buffer
-        BOOST_LOG_TRIVIAL(trace) << "Writing from stream socket to buffer";
-        socket_.async_read_some(boost::asio::buffer(data_, max_length),
-            boost::bind(&session::handle_read, this,
-            boost::asio::placeholders::error,
-            boost::asio::placeholders::bytes_transferred));
-        // After the read operation completes,
-        // we call boosts::binds() -> Read() Function
+/* void session::start_uring_write()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Sends what is left of write_iov_, at most IOV_MAX buffers at a time. The shutdown
+    after the last response is linked behind the send that finishes it. */
+void session::start_uring_write() {
+    std::memset(&write_msg_, 0, sizeof(write_msg_));
+    write_msg_.msg_iov = write_iov_.data();
+    write_msg_.msg_iovlen = std::min<std::size_t>(write_iov_.size(), IOV_MAX);
+    bool last_send = write_msg_.msg_iovlen == write_iov_.size();
+    uring_->async_sendmsg(socket_.native_handle(), &write_msg_, final_write_ && last_send,
+                          write_op_);
+}
+
+/* void session::handle_uring_write(int result, unsigned flags)
+Parameter(s):
+    - result: bytes sent or a negative errno.
+    - flags: completion flags, unused.
+Returns:
+    - N/A
+Description:
+    - Sends the rest if the send came back short (more than IOV_MAX buffers, or it was
+    interrupted), then carries on like handle_write, or like shutdown when the linked
+    shutdown has already sent FIN. */
+void session::handle_uring_write(int result, unsigned flags) {
+    if (result > 0) {
+        std::size_t sent = result;
+        std::size_t done = 0;
+        while (done < write_iov_.size() && sent >= write_iov_[done].iov_len) {
+            sent -= write_iov_[done].iov_len;
+            ++done;
+        }
+        write_iov_.erase(write_iov_.begin(), write_iov_.begin() + done);
+        if (!write_iov_.empty()) {
+            write_iov_[0].iov_base = static_cast<char*>(write_iov_[0].iov_base) + sent;
+            write_iov_[0].iov_len -= sent;
+            start_uring_write();
+            return;
+        }
+    }
+
+    boost::system::error_code error;
+    if (result < 0) {
+        error.assign(-result, boost::system::system_category());
+    }
+    if (final_write_ && !error) {
+        timing_wheel_->cancel(timer_);
+        BOOST_LOG_TRIVIAL(info) << "Shutting down session.";
+        linger();
+    } else if (final_write_) {
+        shutdown(error);
     } else {
+        handle_write(error);
+    }
+}
+
+/* void session::handle_write(const boost::system::error_code& error)
+Parameter(s):
+    - error: error from the write.
+Returns:
+    - N/A
+Description:
+    - Goes on with the body being produced, if any, then with the responses queued
+    behind it. Once everything is written the buffers go back to the pool and the next
+    request is read. */
+void session::handle_write(const boost::system::error_code& error) {
+    timing_wheel_->cancel(timer_);
+    write_buffers_.clear();
+    if (error) {
         BOOST_LOG_TRIVIAL(error) << "Error in handle_write";
-        delete this;
+        close();
+        return;
+    }
+    if (streaming_) {
+        next_body_piece();
+        if (streaming_) {
+            start_write();
+            return;
+        }
+    }
+
+    responses_.erase(responses_.begin(), responses_.begin() + written_responses_);
+    written_responses_ = 0;
+    if (!responses_.empty() || send_continue_) {
+        write_responses();
+    } else if (!write_buffers_.empty()) {
+        // The end of the body just finished.
+        start_write();
+    } else if (close_after_write_) {
+        // A body that failed with nothing left to write.
+        shutdown(error);
+    } else {
+        // Wait for the next request on this keep-alive connection
+        write_heads_.release();
+        body_buffer_.release();
+        BOOST_LOG_TRIVIAL(trace) << "Writing from stream socket to buffer";
+        do_read();
     }
 }
 
+/* void session::shutdown(const boost::system::error_code& error)
+Parameter(s):
+    - error: error from writing the last response.
+Returns:
+    - N/A
+Description:
+    - Sends FIN after the last response, then lingers until the client closes its side.
+    Closing right away would reset the connection if the client had sent anything we did
+    not read (e.g. requests pipelined behind a non keep-alive one), and a reset can
+    destroy the response before the client reads it. */
 void session::shutdown(const boost::system::error_code& error) {
+    timing_wheel_->cancel(timer_);
     if (!error) {
         BOOST_LOG_TRIVIAL(info) << "Shutting down session.";
         boost::system::error_code ignored_ec;
-              socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both,
+        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_send,
             ignored_ec);
+        linger();
     } else {
         BOOST_LOG_TRIVIAL(error) << "Error in session shutdown." << error;
-        delete this;
+        close();
+    }
+}
+
+void session::linger() {
+    timer_.idle = false;
+    timing_wheel_->schedule(timer_, std::chrono::milliseconds(lingering_timeout_ms));
+    socket_.async_wait(tcp::socket::wait_read,
+                       boost::bind(&session::handle_linger, this,
+                       boost::asio::placeholders::error));
+}
+
+/* void session::handle_linger(const boost::system::error_code& error)
+Parameter(s):
+    - error: error from waiting on the socket.
+Returns:
+    - N/A
+Description:
+    - Discards whatever the client still sends and closes the session once it reaches
+    EOF, fails, or runs out of lingering time (see handle_timeout). */
+void session::handle_linger(const boost::system::error_code& error) {
+    timing_wheel_->cancel(timer_);
+    if (error) {
+        close();
+        return;
+    }
+
+    char discard[512];
+    boost::system::error_code read_error;
+    socket_.read_some(boost::asio::buffer(discard), read_error);
+    if (!read_error || read_error == boost::asio::error::would_block ||
+        read_error == boost::asio::error::try_again) {
+        linger();
+    } else {
+        close();
+    }
+}
+
+/* void session::close()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Ends the connection and hands the session back to its pool. Every path that finishes
+    a connection comes through here, and it must be the last thing a handler does: the
+    session may be reused on another thread as soon as it is released. */
+void session::close() {
+    timing_wheel_->cancel(timer_);
+    boost::system::error_code ignored_ec;
+    socket_.close(ignored_ec);
+    admission_control_->close_connection();
+    reset();
+    session_pool_->release(this);
+}
+
+/* void session::reset()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Clears all per-connection state so the session can serve a new connection. Vectors
+    keep their capacity across connections. A body still being streamed is abandoned,
+    which tells its handler by destroying the consumer. */
+void session::reset() {
+    if (body_consumer_) {
+        // The client went away partway through a streamed body.
+        end_body_stream();
+    }
+    read_buffer_.release();
+    read_size_ = buffer_pool::class_capacity(0);
+    direct_reads_ = 0;
+    request_builder_ = request_builder();
+    request_parser_.reset();
+    responses_.clear();
+    write_buffers_.clear();
+    write_heads_.release();
+    written_responses_ = 0;
+    streaming_ = false;
+    body_buffer_.release();
+    close_after_write_ = false;
+    final_write_ = false;
+    send_continue_ = false;
+    header_deadline_ = std::chrono::steady_clock::time_point();
+    served_request_ = false;
+}
+
+/* void session::arm_read_timer()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Arms the timer for the wait on the socket that is about to start, based on where
+    the session is: between requests it gets the keep-alive timeout (or the header timeout
+    on a fresh connection), partway through a request head whatever is left of the header
+    timeout, and while reading a body the full body timeout again after every read. Only
+    the wait between requests counts as idle for a drain. */
+void session::arm_read_timer() {
+    timer_.idle = !request_parser_.started();
+    std::chrono::milliseconds timeout(0);
+    if (request_parser_.in_body()) {
+        timeout = std::chrono::milliseconds(config_->client_body_timeout_ms);
+    } else if (request_parser_.started() || !served_request_) {
+        if (config_->client_header_timeout_ms > 0) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (header_deadline_ == std::chrono::steady_clock::time_point()) {
+                header_deadline_ = now + std::chrono::milliseconds(config_->client_header_timeout_ms);
+            }
+            timeout = std::max(std::chrono::milliseconds(1),
+                std::chrono::duration_cast<std::chrono::milliseconds>(header_deadline_ - now));
+        }
+    } else {
+        timeout = std::chrono::milliseconds(config_->keepalive_timeout_ms);
+    }
+    timing_wheel_->schedule(timer_, timeout);
+}
+
+/* void session::handle_timeout()
+Parameter(s):
+    - N/A
+Returns:
+    - N/A
+Description:
+    - Called by the timing wheel when the outstanding wait or write took too long. Shutting
+    the socket down makes that operation fail, and its handler then closes the session the
+    same way as when the client disconnects. The wheel stays locked while this runs, so a
+    handler starting on another thread waits in its cancel() until the shutdown is done.
+    timing_wheel::expire_idle() also lands here when the server drains. */
+void session::handle_timeout() {
+    boost::system::error_code ignored_ec;
+    if (timer_.idle && admission_control_->draining()) {
+        // Only stop reading: a request that already arrived still gets its response.
+        BOOST_LOG_TRIVIAL(info) << "Closing idle session for drain.";
+        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_receive, ignored_ec);
+        return;
     }
+    BOOST_LOG_TRIVIAL(info) << "Session timed out, closing connection.";
+    socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
 }
@@ -0,0 +1,81 @@
+/* session_pool.cc
+Description:
+    Recycles the sessions of an io_service through a bounded free list.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include "session_pool.h"
+#include "session.h"
+
+session_pool::session_pool(boost::asio::io_service& io_service, request_dispatcher* request_dispatcher,
+                           admission_control* admission_control, const response_compressor* response_compressor,
+                           timing_wheel* timing_wheel, const NginxConfig* config, io_uring_context* uring,
+                           std::size_t max_free)
+    : io_service_(io_service), request_dispatcher_(request_dispatcher), admission_control_(admission_control),
+      response_compressor_(response_compressor), timing_wheel_(timing_wheel),
+      config_(config), uring_(uring), max_free_(max_free), live_(0) {}
+
+session_pool::~session_pool() {
+    for (std::size_t i = 0; i < free_.size(); ++i) {
+        delete free_[i];
+    }
+}
+
+/* session* session_pool::acquire()
+Parameter(s):
+    - N/A
+Returns:
+    - session that is not in use, with a closed socket.
+Description:
+    - Pops the most recently released session (likely still in cache) or creates a new one
+    when the free list is empty. */
+session* session_pool::acquire() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        ++live_;
+        if (!free_.empty()) {
+            session* s = free_.back();
+            free_.pop_back();
+            return s;
+        }
+    }
+    return new session(io_service_, request_dispatcher_, admission_control_, response_compressor_, timing_wheel_,
+                       config_, uring_, this);
+}
+
+/* void session_pool::release(session* s)
+Parameter(s):
+    - s: session from acquire() that has been closed and reset.
+Returns:
+    - N/A
+Description:
+    - Keeps s for the next acquire(), or deletes it if max_free sessions are already free. */
+void session_pool::release(session* s) {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        --live_;
+        if (free_.size() < max_free_) {
+            free_.push_back(s);
+            return;
+        }
+    }
+    delete s;
+}
+
+std::size_t session_pool::live_count() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return live_;
+}
+
+std::size_t session_pool::free_count() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return free_.size();
+}
@@ -12,15 +12,186 @@ Date Created:
     April 11th, 2020
 */
 
-#include <fstream>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/algorithm/string.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/thread.hpp>
 
+#include "http_tokens.h"
 #include "static_request_handler.h"
+#include "response_compressor.h"
 #include "response_helper_library.h"
 
+namespace {
+
+// Reads a file as the session writes it, so a large file is never in memory whole.
+class file_body_producer : public body_producer {
+ public:
+    file_body_producer(int fd, long long size) : fd_(fd), size_(size) {}
+    ~file_body_producer() { ::close(fd_); }
+
+    long long size() const { return size_; }
+
+    bool read(char* buffer, std::size_t capacity, std::size_t& size) {
+        ssize_t result;
+        do {
+            result = ::read(fd_, buffer, capacity);
+        } while (result < 0 && errno == EINTR);
+        if (result < 0) {
+            BOOST_LOG_TRIVIAL(error) << "Could not read static file: " << std::strerror(errno);
+            return false;
+        }
+        size = result;
+        return true;
+    }
+
+ private:
+    int fd_;
+    long long size_;
+};
+
+/* Compresses file_name into file_name + ".gz" at level, stamped with the file's times.
+   The variant is written to a temporary file next to it and renamed into place, so a
+   request never sees half of one. */
+bool write_gzip_variant(const std::string& file_name, int level) {
+    int source_fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat source;
+    if (source_fd < 0 || ::fstat(source_fd, &source) != 0) {
+        if (source_fd >= 0) {
+            ::close(source_fd);
+        }
+        return false;
+    }
+    std::shared_ptr<body_producer> compressed = response_compressor::compressing_producer(
+        response_compressor::gzip, level, std::make_shared<file_body_producer>(source_fd, source.st_size));
+    std::string variant_name = file_name + ".gz";
+    std::string temp_name = variant_name + ".XXXXXX";
+    int temp_fd = compressed ? ::mkstemp(&temp_name[0]) : -1;
+    if (temp_fd < 0) {
+        BOOST_LOG_TRIVIAL(error) << "Could not make gzip variant of " << file_name;
+        return false;
+    }
+
+    bool written = true;
+    char piece[16 * 1024];
+    std::size_t size = 0;
+    while (written && (written = compressed->read(piece, sizeof(piece), size)) && size > 0) {
+        for (std::size_t done = 0; written && done < size;) {
+            ssize_t result = ::write(temp_fd, piece + done, size - done);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            written = result > 0;
+            done += written ? result : 0;
+        }
+    }
+    struct timespec times[2] = { source.st_atim, source.st_mtim };
+    written = written && ::fchmod(temp_fd, 0644) == 0 && ::futimens(temp_fd, times) == 0;
+    written = ::close(temp_fd) == 0 && written && std::rename(temp_name.c_str(), variant_name.c_str()) == 0;
+    if (!written) {
+        BOOST_LOG_TRIVIAL(error) << "Could not write gzip variant " << variant_name;
+        ::unlink(temp_name.c_str());
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Wrote gzip variant " << variant_name;
+    return true;
+}
+
+// Builds gzip variants on a thread of its own, so an io thread never waits for a file
+// to be compressed. Files are built one at a time, and each only once however many
+// requests ask for it while it is queued or being built. A file whose build failed,
+// say in a document root that is not writable, is not tried again until it changes.
+class variant_builder {
+ public:
+    static variant_builder& get() {
+        static variant_builder builder;
+        return builder;
+    }
+
+    ~variant_builder() {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_one();
+        if (thread_) {
+            thread_->join();
+        }
+    }
+
+    void build(const std::string& file_name, const struct timespec& mtime, int level) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto failed = failed_.find(file_name);
+        if (failed != failed_.end() && failed->second.tv_sec == mtime.tv_sec &&
+            failed->second.tv_nsec == mtime.tv_nsec) {
+            return;
+        }
+        if (stopping_ || !pending_.insert(file_name).second) {
+            return;
+        }
+        jobs_.push_back(job{file_name, mtime, level});
+        if (!thread_) {
+            thread_.reset(new boost::thread(&variant_builder::run, this));
+        }
+        ready_.notify_one();
+    }
+
+ private:
+    struct job {
+        std::string file_name;
+        struct timespec mtime;
+        int level;
+    };
+
+    variant_builder() : stopping_(false) {}
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            ready_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job next = jobs_.front();
+            jobs_.pop_front();
+            lock.unlock();
+            bool built = write_gzip_variant(next.file_name, next.level);
+            lock.lock();
+            pending_.erase(next.file_name);
+            if (built) {
+                failed_.erase(next.file_name);
+            } else {
+                failed_[next.file_name] = next.mtime;
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    // Files queued or being built.
+    std::deque<job> jobs_;
+    std::unordered_set<std::string> pending_;
+    // Files whose build failed, with the modification time they had then.
+    std::unordered_map<std::string, struct timespec> failed_;
+    std::unique_ptr<boost::thread> thread_;
+    bool stopping_;
+};
+
+}  // namespace
+
 /* static_request_handler* Init(const std::string& location_path, const NginxConfig& config)
 Parameter(s):
     - location_path: path provided in config file which corresponds to handler
@@ -33,23 +204,11 @@ static_request_handler* static_request_handler::Init(const std::string& location
     static_request_handler* srh = new static_request_handler();
     srh -> client_location_path_ = location_path;
     srh -> server_root_path_ = config.static_locations_.at(location_path);
+    auto compression = config.location_compression_.find(location_path);
+    srh -> compression_ = compression == config.location_compression_.end() ? config.compression : compression->second;
     return srh;
 }
 
-/* Mapping from file extension to mime type */
-std::unordered_map<std::string, std::string> mappings(
-{
-    { "gif", "image/gif" },
-    { "htm", "text/html" },
-    { "html", "text/html" },
-    { "jpg", "image/jpeg" },
-    { "jpeg", "image/jpeg" },
-    { "png", "image/png" },
-    { "zip", "application/zip" },
-    { "txt", "text/plain" },
-    { "pdf", "application/pdf" }
-});
-
 /*  void static_request_handler::default_bad_request(Response& response)
 Parameter(s):
     - response: Response object (see response.h)
@@ -60,9 +219,9 @@ Description:
     at file path by static handler. */
 void static_request_handler::default_bad_request(Response& response) {
     response.code_ = Response::not_found;
-    response.body_ = stock_responses::not_found;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/html";
+    response.shared_body_ = ResponseHelperLibrary::stock_body(Response::not_found);
+    response.headers_[header_id::content_length] = std::to_string(response.shared_body_->size());
+    response.headers_[header_id::content_type] = "text/html";
 }
 
 /*  std::string static_request_handler::get_mime_type(std::string file_name)
@@ -72,40 +231,38 @@ Returns:
     - Mime type that goes with the file name.
 Description: 
     - Looks at the file extension of file_name, returns string value
-    to be used for Content-Type */
+    to be used for Content-Type (see http_tokens::mime_type for the known ones) */
 std::string static_request_handler::get_mime_type(std::string file_name) {
     size_t last_dot_index = file_name.find_last_of(".");
     if (last_dot_index != std::string::npos) {
-        std::string file_extension = file_name.substr(last_dot_index + 1);
-        if (mappings.find(file_extension) != mappings.end()) {
-            return mappings[file_extension];
+        std::string_view mime_type =
+            http_tokens::mime_type(std::string_view(file_name).substr(last_dot_index + 1));
+        if (!mime_type.empty()) {
+            return std::string(mime_type);
         }
     }
     return "text/plain";
 }
 
-/*  Response static_request_handler::handle_request(const request& request)
+Response static_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response static_request_handler::handle_request(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - Response object (see response.h)
 Description: 
-    - Handler uses request URI to find mapping of client path to server path.
+    - Handler uses the request's decoded path to find mapping of client path to server path.
     Once path is found, file is opened and served back to client. */
-Response static_request_handler::handle_request(const Request& request) {
+Response static_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: static" ;
     // Find the root directory and target file from the client's request uri
     Response response;
 
-    std::string uri = request.uri_;
-    size_t space_index = 0;
-    while (true) {
-        space_index = uri.find("%20", space_index);
-        if (space_index == std::string::npos) {
-            break;
-        }
-        uri.replace(space_index, 3, " ");
-    }
+    // The parser has already decoded the path and removed its dot segments
+    std::string uri(request.path_);
 
     // The path that is unique to the client that we want to map to the server side path
     std::string client_uri_path = uri;
@@ -130,23 +287,70 @@ Response static_request_handler::handle_request(const Request& request) {
 
     //--------------------------------------------------------------------------
     // Fill out the Response to be sent to the client.
+    // The file is not read here but as the session writes it, see file_body_producer.
     std::string file_name = server_root_path_ + sub_uri_path;
-    std::ifstream send_file;
-    send_file.open(file_name.c_str());
-    if (!send_file.good()) {
+    int fd = ::open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat file_stat;
+    if (fd < 0 || ::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
         BOOST_LOG_TRIVIAL(error) << "Could not open file at path: " << file_name;
+        if (fd >= 0) {
+            ::close(fd);
+        }
         default_bad_request(response);
     } else {
-        std::vector<char> send_data;
-        char c = '\0';
-        while (send_file.get(c)) {
-            send_data.push_back(c);
+        std::string mime_type = get_mime_type(uri);
+        if (compression_.static_variants && file_stat.st_size >= static_cast<long long>(compression_.min_length) &&
+            response_compressor::compressible_type(compression_.types, mime_type)) {
+            response.headers_[header_id::vary] = "Accept-Encoding";
+            int variant = -1;
+            struct stat variant_stat;
+            if (response_compressor::negotiate(request.header("Accept-Encoding")) == response_compressor::gzip) {
+                variant = open_gzip_variant(file_name, file_stat, variant_stat);
+            }
+            if (variant >= 0) {
+                ::close(fd);
+                fd = variant;
+                file_stat = variant_stat;
+                response.headers_[header_id::content_encoding] = "gzip";
+            }
         }
-        std::string send_data_string(send_data.begin(), send_data.end());
         response.code_ = Response::ok;
-        response.body_ = send_data_string;
-        response.headers_["Content-Length"] = std::to_string(response.body_.size());
-        response.headers_["Content-Type"] = get_mime_type(uri);
+        response.body_producer_ = std::make_shared<file_body_producer>(fd, file_stat.st_size);
+        response.headers_[header_id::content_length] = std::to_string(file_stat.st_size);
+        response.headers_[header_id::content_type] = mime_type;
     }
     return response;
 }
+
+/*  int static_request_handler::open_gzip_variant(const std::string& file_name, const struct stat& source,
+                                                  struct stat& variant_stat)
+Parameter(s):
+    - file_name: path of the file requested.
+    - source: its stat.
+    - variant_stat: set to the variant's stat when one is returned.
+Returns:
+    - Descriptor of the file's gzip variant, or -1 if it has none that is current.
+Description:
+    - The variant is file_name + ".gz", and belongs to the file only while their
+    modification times are the same: one made here gets the file's, and so does one made
+    with "gzip -k". A missing or stale variant is handed to the background builder (see
+    variant_builder) and the file is sent as it is meanwhile, left to the compressor;
+    requests after the build get the variant. Files over max_variant_size are always
+    left to the compressor. */
+int static_request_handler::open_gzip_variant(const std::string& file_name, const struct stat& source,
+                                              struct stat& variant_stat) {
+    std::string variant_name = file_name + ".gz";
+    int fd = ::open(variant_name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0 && ::fstat(fd, &variant_stat) == 0 && S_ISREG(variant_stat.st_mode) &&
+        variant_stat.st_mtim.tv_sec == source.st_mtim.tv_sec &&
+        variant_stat.st_mtim.tv_nsec == source.st_mtim.tv_nsec) {
+        return fd;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    if (source.st_size <= max_variant_size) {
+        variant_builder::get().build(file_name, source.st_mtim, compression_.level);
+    }
+    return -1;
+}
@@ -13,12 +13,15 @@ Date Created:
 */
 
 #include <fstream>
+#include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <boost/log/trivial.hpp>
 
 #include "request.h"
 #include "response.h"
+#include "server_metrics.h"
 #include "status_request_handler.h"
 
 /*  status_request_handler Constructor
@@ -28,29 +31,32 @@ Date Created:
         - Initializes response body. Obtains information on list of what request handlers exist,
         and for what URL prefixes. */
 status_request_handler::status_request_handler(const NginxConfig& config) {
-    // Initializing list of handlers from config file.
-    std::unordered_set<std::string> echo_locations = config.echo_locations_;
-    std::unordered_map<std::string, std::string> static_locations = config.static_locations_;
-    std::unordered_map<std::string, std::pair<std::string, int>> proxy_locations = config.proxy_locations_;
+    // Initializing list of handlers from config file, sorted so the page reads the same
+    // whatever order the hash tables keep them in.
+    std::set<std::string> echo_locations(config.echo_locations_.begin(), config.echo_locations_.end());
+    std::map<std::string, std::string> static_locations(config.static_locations_.begin(),
+                                                        config.static_locations_.end());
+    std::map<std::string, std::pair<std::string, int>> proxy_locations(config.proxy_locations_.begin(),
+                                                                        config.proxy_locations_.end());
 
     std::string config_handlers = "";
     if (!(echo_locations).empty()) {
         config_handlers += "EchoHandler(s):\r\n";
-        for (std::unordered_set<std::string>::iterator itr = echo_locations.begin(); itr != echo_locations.end(); ++itr) {
+        for (std::set<std::string>::iterator itr = echo_locations.begin(); itr != echo_locations.end(); ++itr) {
             config_handlers += (*itr);
             config_handlers += "\r\n";
         }
     }
     if (!(static_locations).empty()) {
         config_handlers += "StaticHandler(s):\r\n";
-        for (std::unordered_map<std::string, std::string>::iterator itr = static_locations.begin(); itr != static_locations.end(); ++itr) {
+        for (std::map<std::string, std::string>::iterator itr = static_locations.begin(); itr != static_locations.end(); ++itr) {
             config_handlers += (itr->first);
             config_handlers += "\r\n";
         }
     }
     if (!(proxy_locations).empty()) {
         config_handlers += "ProxyHandler(s):\r\n";
-        for (std::unordered_map<std::string, std::pair<std::string, int>>::iterator itr = proxy_locations.begin(); itr != proxy_locations.end(); ++itr) {
+        for (std::map<std::string, std::pair<std::string, int>>::iterator itr = proxy_locations.begin(); itr != proxy_locations.end(); ++itr) {
             config_handlers += (itr->first);
             config_handlers += "\r\n";
         }
@@ -78,24 +84,30 @@ status_request_handler* status_request_handler::Init(const std::string& location
     return srh;
 }
 
-/*  Response status_request_handler::handle_request(const request& request)
+Response status_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response status_request_handler::handle_request(const RequestView& request)
     Parameter(s):
-        - request: Request object (see request.h)
+        - request: RequestView of the request (see request_view.h)
     Returns:
         - Response object (see response.h)
     Description:
-        - Response object is generated and returned, with status information stored in the response body. */
-Response status_request_handler::handle_request(const Request& request) {
+        - Response object is generated and returned, with status information stored in the response body.
+        The body ends with the server wide counters from server_metrics. */
+Response status_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: status" ;
     // BOOST_LOG_TRIVIAL(info) << "Currently serving status requests on path: " << request.uri_;
     Response response;
     std::string num_received_req = "Number of requests received: " + std::to_string(request_counter) + "\r\n";
-    std::string formatted_content = num_received_req + received_request_list + handler_list;
+    std::string formatted_content = num_received_req + received_request_list + handler_list +
+        server_metrics::get().report();
     // Fill out the Response to be sent to the client.
     response.code_ = Response::ok;
-    response.body_ = formatted_content;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/plain";
+    response.body_ = std::move(formatted_content);
+    response.headers_[header_id::content_length] = std::to_string(response.body_.size());
+    response.headers_[header_id::content_type] = "text/plain";
 
     return response;
 }
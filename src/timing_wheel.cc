@@ -0,0 +1,172 @@
+/* timing_wheel.cc
+Description:
+    Hashed timing wheel with O(1) arm and cancel, used for the header, body,
+    keep-alive and send timeouts of every session on an io_service.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <boost/bind.hpp>
+#include <boost/log/trivial.hpp>
+
+#include "timing_wheel.h"
+
+/* timing_wheel Constructor
+Parameter(s):
+    - io_service: io_service whose thread(s) run the ticks and the expiry callbacks.
+    - tick: resolution of the wheel. Timers fire up to one tick late.
+    - num_slots: number of slots. Timeouts up to tick * num_slots fire on the first visit.
+Description:
+    - Creates an empty wheel. Call start() to begin ticking. */
+timing_wheel::timing_wheel(boost::asio::io_service& io_service, std::chrono::milliseconds tick,
+                           std::size_t num_slots)
+    : tick_timer_(io_service), tick_(tick), slots_(num_slots), current_tick_(0), size_(0),
+      running_(false) {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        slots_[i].prev_ = &slots_[i];
+        slots_[i].next_ = &slots_[i];
+    }
+}
+
+timing_wheel::~timing_wheel() {
+    stop();
+}
+
+void timing_wheel::start() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    tick_timer_.expires_after(tick_);
+    tick_timer_.async_wait(boost::bind(&timing_wheel::handle_tick, this,
+                           boost::asio::placeholders::error));
+}
+
+void timing_wheel::stop() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    running_ = false;
+    boost::system::error_code ignored_ec;
+    tick_timer_.cancel(ignored_ec);
+}
+
+/* void timing_wheel::schedule(timer& t, std::chrono::milliseconds timeout)
+Parameter(s):
+    - t: timer to arm.
+    - timeout: time from now until the timer fires. Zero disarms it instead.
+Returns:
+    - N/A
+Description:
+    - Moves t into the slot of its new deadline, rounding up to a whole tick. */
+void timing_wheel::schedule(timer& t, std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (t.armed()) {
+        unlink(t);
+    }
+    if (timeout.count() <= 0) {
+        return;
+    }
+    std::uint64_t ticks = (timeout.count() + tick_.count() - 1) / tick_.count();
+    t.expiry_tick_ = current_tick_ + ticks;
+    link(t, t.expiry_tick_ % slots_.size());
+}
+
+void timing_wheel::cancel(timer& t) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (t.armed()) {
+        unlink(t);
+    }
+}
+
+/* std::size_t timing_wheel::expire_idle()
+Parameter(s):
+    - N/A
+Returns:
+    - std::size_t holding the number of timers fired.
+Description:
+    - Unlinks and fires every armed timer marked idle, with the same locking guarantees
+    as a normal expiry. Called from any thread. */
+std::size_t timing_wheel::expire_idle() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::size_t fired = 0;
+    for (std::size_t slot = 0; slot < slots_.size(); ++slot) {
+        timer& head = slots_[slot];
+        timer* t = head.next_;
+        while (t != &head) {
+            timer* next = t->next_;
+            if (t->idle) {
+                unlink(*t);
+                ++fired;
+                if (t->on_expire) {
+                    t->on_expire();
+                }
+            }
+            t = next;
+        }
+    }
+    return fired;
+}
+
+std::size_t timing_wheel::size() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return size_;
+}
+
+void timing_wheel::link(timer& t, std::size_t slot) {
+    timer& head = slots_[slot];
+    t.prev_ = head.prev_;
+    t.next_ = &head;
+    head.prev_->next_ = &t;
+    head.prev_ = &t;
+    ++size_;
+}
+
+void timing_wheel::unlink(timer& t) {
+    t.prev_->next_ = t.next_;
+    t.next_->prev_ = t.prev_;
+    t.prev_ = nullptr;
+    t.next_ = nullptr;
+    --size_;
+}
+
+/* void timing_wheel::handle_tick(const boost::system::error_code& error)
+Parameter(s):
+    - error: error from the tick timer, set when the wheel is stopped.
+Returns:
+    - N/A
+Description:
+    - Advances the wheel by one slot and fires the due timers in it. Callbacks run with
+    the wheel locked, so a timer being cancelled on another thread either fires entirely
+    before the cancel returns or not at all. Callbacks must not touch the wheel. */
+void timing_wheel::handle_tick(const boost::system::error_code& error) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (error || !running_) {
+        return;
+    }
+
+    ++current_tick_;
+    timer& head = slots_[current_tick_ % slots_.size()];
+    timer* t = head.next_;
+    while (t != &head) {
+        timer* next = t->next_;
+        if (t->expiry_tick_ <= current_tick_) {
+            unlink(*t);
+            if (t->on_expire) {
+                t->on_expire();
+            }
+        }
+        t = next;
+    }
+
+    // Schedule from the previous deadline rather than from now so the wheel does not drift.
+    tick_timer_.expires_at(tick_timer_.expiry() + tick_);
+    tick_timer_.async_wait(boost::bind(&timing_wheel::handle_tick, this,
+                           boost::asio::placeholders::error));
+}
@@ -32,7 +32,7 @@ upload_form_request_handler* upload_form_request_handler::Init(const std::string
     // NginxConfig is not used for the upload form.
     upload_form_request_handler* ufrh = new upload_form_request_handler();
     // TODO (kubilayagi): update styling if there's time later on
-    ufrh->form_html_ = "<!DOCTYPE html>\n\
+    ufrh->form_html_ = std::make_shared<const std::string>("<!DOCTYPE html>\n\
 <html>\n\
     <head>\n\
         <meta charset='utf-8'>\n\
@@ -53,28 +53,32 @@ upload_form_request_handler* upload_form_request_handler::Init(const std::string
         </div>\n\
         </form>\n\
     </body>\n\
-</html>\n";
+</html>\n");
     return ufrh;
 }
 
-/*  Response upload_form_request_handler::handle_request(const request& request)
+Response upload_form_request_handler::handle_request(const Request& request) {
+    return handle_request(RequestView(request));
+}
+
+/*  Response upload_form_request_handler::handle_request(const RequestView& request)
 Parameter(s):
-    - request: Request object (see request.h)
+    - request: RequestView of the request (see request_view.h)
 Returns:
     - Response object (see response.h)
 Description:
     - Response object is generated and returned using preformatted and populated html form
     for users. */
-Response upload_form_request_handler::handle_request(const Request& request) {
+Response upload_form_request_handler::handle_request(const RequestView& request) {
     BOOST_LOG_TRIVIAL(info) << "[ResponseMetrics]Request_Handler: upload_form" ;
     BOOST_LOG_TRIVIAL(info) << "Sending back blog upload form.";
     Response response;
 
     // Fill out the Response to be sent to the client.
     response.code_ = Response::ok;
-    response.body_ = form_html_;
-    response.headers_["Content-Length"] = std::to_string(response.body_.size());
-    response.headers_["Content-Type"] = "text/html";
+    response.shared_body_ = form_html_;
+    response.headers_[header_id::content_length] = std::to_string(form_html_->size());
+    response.headers_[header_id::content_type] = "text/html";
 
     return response;
 }
@@ -0,0 +1,231 @@
+/* uri_decoder.cc
+Description:
+    Splitting, percent-decoding and dot-segment removal of request targets, and the
+    lazily parsed query-parameter view.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+*/
+
+#include <cstring>
+
+#include "http_scanner.h"
+#include "uri_decoder.h"
+
+namespace {
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+namespace uri_decoder {
+
+void split(std::string_view target, std::string_view& path, std::string_view& query) {
+    std::size_t question = target.find('?');
+    if (question == std::string_view::npos) {
+        path = target;
+        query = std::string_view();
+    } else {
+        path = target.substr(0, question);
+        query = target.substr(question + 1);
+    }
+}
+
+/* bool needs_normalizing(std::string_view path)
+Parameter(s):
+    - path: path of a request target, before the query.
+Returns:
+    - bool which is true if the path has a '%' or a dot segment.
+Description:
+    - Jumps from '%' or '.' to the next with http_scanner, so a clean path costs one
+    vector scan. A '.' only matters at the start of a segment, which is all there is
+    to check at the dots of file extensions. */
+bool needs_normalizing(std::string_view path) {
+    const char* begin = path.data();
+    const char* end = begin + path.size();
+    const char* next = begin;
+    while ((next = http_scanner::find_either(next, end, '%', '.')) != end) {
+        if (*next == '%') {
+            return true;
+        }
+        if (next != begin && next[-1] == '/') {
+            const char* after = next + 1;
+            if (after != end && *after == '.') {
+                ++after;
+            }
+            if (after == end || *after == '/') {
+                return true;
+            }
+        }
+        ++next;
+    }
+    return false;
+}
+
+bool normalize_path(std::string_view path, std::string& normalized) {
+    if (!percent_decode(path, false, normalized) ||
+        std::memchr(normalized.data(), '\0', normalized.size()) != nullptr) {
+        return false;
+    }
+    remove_dot_segments(normalized);
+    return true;
+}
+
+/* bool percent_decode(std::string_view text, bool plus_is_space, std::string& decoded)
+Parameter(s):
+    - text: bytes to decode.
+    - plus_is_space: whether '+' stands for a space.
+    - decoded: replaced with the decoded bytes.
+Returns:
+    - bool which is false if an escape is not '%' and two hex digits.
+Description:
+    - Copies the runs between escapes whole, found with http_scanner, instead of
+    a byte at a time. */
+bool percent_decode(std::string_view text, bool plus_is_space, std::string& decoded) {
+    decoded.clear();
+    decoded.reserve(text.size());
+    const char* next = text.data();
+    const char* end = next + text.size();
+    char plus = plus_is_space ? '+' : '%';
+    while (next != end) {
+        const char* special = http_scanner::find_either(next, end, '%', plus);
+        decoded.append(next, special - next);
+        if (special == end) {
+            break;
+        }
+        if (*special == '+') {
+            decoded.push_back(' ');
+            next = special + 1;
+            continue;
+        }
+        if (end - special < 3) {
+            return false;
+        }
+        int high = hex_value(special[1]);
+        int low = hex_value(special[2]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        decoded.push_back(static_cast<char>(high << 4 | low));
+        next = special + 3;
+    }
+    return true;
+}
+
+/* void remove_dot_segments(std::string& path)
+Parameter(s):
+    - path: decoded path, changed in place.
+Returns:
+    - N/A
+Description:
+    - Copies each segment down over the ones removed before it. A "." is dropped and
+    a ".." drops the segment written before it too; either at the end leaves the
+    path ending in '/', as it names a directory. */
+void remove_dot_segments(std::string& path) {
+    if (path.empty() || path[0] != '/') {
+        return;
+    }
+    std::size_t size = path.size();
+    std::size_t read = 0;
+    std::size_t write = 0;
+    while (read < size) {
+        std::size_t next = path.find('/', read + 1);
+        if (next == std::string::npos) {
+            next = size;
+        }
+        std::string_view segment(path.data() + read + 1, next - read - 1);
+        if (segment == "." || segment == "..") {
+            if (segment == "..") {
+                while (write > 0 && path[--write] != '/') {
+                }
+            }
+            if (next == size) {
+                path[write++] = '/';
+            }
+        } else {
+            if (write != read) {
+                std::memmove(&path[write], path.data() + read, next - read);
+            }
+            write += next - read;
+        }
+        read = next;
+    }
+    path.resize(write);
+}
+
+}  // namespace uri_decoder
+
+void query_view::iterator::next() {
+    while (!rest_.empty()) {
+        std::size_t amp = rest_.find('&');
+        std::string_view pair = rest_.substr(0, amp);
+        rest_ = amp == std::string_view::npos ? std::string_view() : rest_.substr(amp + 1);
+        if (pair.empty()) {
+            continue;
+        }
+        std::size_t equals = pair.find('=');
+        if (equals == std::string_view::npos) {
+            current_ = param{pair, pair.substr(pair.size())};
+        } else {
+            current_ = param{pair.substr(0, equals), pair.substr(equals + 1)};
+        }
+        return;
+    }
+    done_ = true;
+}
+
+/* bool query_view::find(std::string_view name, param& found) const
+Parameter(s):
+    - name: decoded parameter name.
+    - found: set to the parameter, still encoded.
+Returns:
+    - bool which is true if there is a parameter called name.
+Description:
+    - Names are compared as received, and only decoded when they have an escape or
+    a '+'. */
+bool query_view::find(std::string_view name, param& found) const {
+    std::string decoded;
+    for (const param& p : *this) {
+        std::string_view candidate = p.name;
+        const char* special = http_scanner::find_either(p.name.data(), p.name.data() + p.name.size(),
+                                                        '%', '+');
+        if (special != p.name.data() + p.name.size()) {
+            if (!uri_decoder::percent_decode(p.name, true, decoded)) {
+                continue;
+            }
+            candidate = decoded;
+        }
+        if (candidate == name) {
+            found = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool query_view::get(std::string_view name, std::string& value) const {
+    param found;
+    return find(name, found) && uri_decoder::percent_decode(found.value, true, value);
+}
+
+bool query_view::has(std::string_view name) const {
+    param found;
+    return find(name, found);
+}
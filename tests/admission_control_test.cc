@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "admission_control.h"
+#include "config_parser.h"
+#include "request_dispatcher.h"
+#include "server_metrics.h"
+
+class AdmissionControlTest : public ::testing::Test {
+ protected:
+        void SetUp() override {
+            ASSERT_TRUE(parser_.Parse("admission_config", &config_));
+            dispatcher_.reset(new request_dispatcher(config_));
+            admission_.reset(new admission_control(config_, *dispatcher_));
+            echo_handler_ = dispatcher_->get_location_handler("/echo");
+            health_handler_ = dispatcher_->get_location_handler("/health");
+        }
+
+        NginxConfigParser parser_;
+        NginxConfig config_;
+        std::unique_ptr<request_dispatcher> dispatcher_;
+        std::unique_ptr<admission_control> admission_;
+        request_handler* echo_handler_;
+        request_handler* health_handler_;
+};
+
+TEST_F(AdmissionControlTest, ParsesLimits) {
+    EXPECT_EQ(config_.max_connections, 2);
+    EXPECT_EQ(config_.max_requests_in_flight, 3);
+    EXPECT_EQ(config_.location_max_requests_in_flight_["/echo"], 1);
+    EXPECT_EQ(config_.location_max_requests_in_flight_.count("/health"), 0);
+}
+
+TEST_F(AdmissionControlTest, ConnectionLimit) {
+    EXPECT_TRUE(admission_->try_open_connection());
+    EXPECT_TRUE(admission_->try_open_connection());
+    EXPECT_FALSE(admission_->try_open_connection());
+
+    admission_->close_connection();
+    EXPECT_TRUE(admission_->try_open_connection());
+    admission_->close_connection();
+    admission_->close_connection();
+}
+
+TEST_F(AdmissionControlTest, LocationLimitShedsRequest) {
+    std::uint64_t shed_before = server_metrics::get().requests_shed;
+    EXPECT_TRUE(admission_->try_start_request(echo_handler_));
+    EXPECT_FALSE(admission_->try_start_request(echo_handler_));
+    // Only a request answered with the 503 counts as shed, not every failed try.
+    EXPECT_EQ(server_metrics::get().requests_shed, shed_before);
+    EXPECT_EQ(admission_->shed_request().code_, Response::service_unavailable);
+    EXPECT_EQ(server_metrics::get().requests_shed, shed_before + 1);
+
+    // Another location is only bound by the global limit.
+    EXPECT_TRUE(admission_->try_start_request(health_handler_));
+    EXPECT_EQ(server_metrics::get().requests_in_flight, 2);
+
+    admission_->finish_request(echo_handler_);
+    EXPECT_TRUE(admission_->try_start_request(echo_handler_));
+    admission_->finish_request(echo_handler_);
+    admission_->finish_request(health_handler_);
+    EXPECT_EQ(server_metrics::get().requests_in_flight, 0);
+}
+
+TEST_F(AdmissionControlTest, GlobalLimitShedsRequest) {
+    EXPECT_TRUE(admission_->try_start_request(health_handler_));
+    EXPECT_TRUE(admission_->try_start_request(health_handler_));
+    EXPECT_TRUE(admission_->try_start_request(echo_handler_));
+    EXPECT_FALSE(admission_->try_start_request(health_handler_));
+    for (int i = 0; i < 2; i++) {
+        admission_->finish_request(health_handler_);
+    }
+    admission_->finish_request(echo_handler_);
+}
+
+TEST_F(AdmissionControlTest, ServiceUnavailableResponse) {
+    const Response& response = admission_->service_unavailable();
+    EXPECT_EQ(response.code_, Response::service_unavailable);
+    EXPECT_EQ(response.headers_.at("Retry-After"), "1");
+    EXPECT_EQ(response.headers_.at("Content-Length"), std::to_string(response.body().size()));
+}
+
+TEST_F(AdmissionControlTest, BodyLimits) {
+    EXPECT_EQ(config_.client_max_body_size, 2 * 1024 * 1024);
+    EXPECT_EQ(admission_->max_body_size(echo_handler_), 64 * 1024);
+    EXPECT_EQ(admission_->max_body_size(health_handler_), 2 * 1024 * 1024);
+}
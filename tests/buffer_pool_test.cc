@@ -0,0 +1,61 @@
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "buffer_pool.h"
+
+class BufferPoolTest : public ::testing::Test {
+ protected:
+        pooled_buffer buffer_;
+};
+
+TEST_F(BufferPoolTest, NoStorageUntilReserved) {
+    EXPECT_FALSE(buffer_.has_storage());
+    EXPECT_EQ(buffer_.capacity(), 0);
+
+    buffer_.reserve(100);
+    EXPECT_TRUE(buffer_.has_storage());
+    EXPECT_EQ(buffer_.capacity(), buffer_pool::class_capacity(0));
+    EXPECT_EQ(buffer_.size(), 0);
+}
+
+TEST_F(BufferPoolTest, ReleasedBlockIsReused) {
+    buffer_.reserve(100);
+    char* first_block = buffer_.data();
+    std::size_t free_before = buffer_pool::free_count(0);
+    buffer_.release();
+    EXPECT_FALSE(buffer_.has_storage());
+    EXPECT_EQ(buffer_pool::free_count(0), free_before + 1);
+
+    buffer_.reserve(100);
+    EXPECT_EQ(buffer_.data(), first_block);
+    EXPECT_EQ(buffer_pool::free_count(0), free_before);
+}
+
+TEST_F(BufferPoolTest, GrowKeepsFilledBytes) {
+    buffer_.reserve(10);
+    std::memcpy(buffer_.tail(), "GET / HTTP", 10);
+    buffer_.commit(10);
+
+    buffer_.reserve(buffer_pool::class_capacity(0));
+    EXPECT_EQ(buffer_.capacity(), buffer_pool::class_capacity(1));
+    EXPECT_EQ(buffer_.size(), 10);
+    EXPECT_EQ(std::string(buffer_.data(), buffer_.size()), "GET / HTTP");
+    EXPECT_GE(buffer_.tail_capacity(), buffer_pool::class_capacity(0));
+}
+
+TEST_F(BufferPoolTest, ConsumeMovesRemainderToFront) {
+    buffer_.reserve(20);
+    std::memcpy(buffer_.tail(), "first;second", 12);
+    buffer_.commit(12);
+
+    buffer_.consume(6);
+    EXPECT_EQ(std::string(buffer_.data(), buffer_.size()), "second");
+    buffer_.consume(6);
+    EXPECT_EQ(buffer_.size(), 0);
+}
+
+TEST_F(BufferPoolTest, SizeClassIsCappedAtLargest) {
+    EXPECT_EQ(buffer_pool::size_class(1), 0);
+    EXPECT_EQ(buffer_pool::size_class(buffer_pool::class_capacity(0) + 1), 1);
+    EXPECT_EQ(buffer_pool::size_class(1u << 30), buffer_pool::num_size_classes - 1);
+}
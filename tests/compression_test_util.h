@@ -0,0 +1,59 @@
+/* compression_test_util.h
+Helpers shared by the tests of compressed response bodies.
+*/
+
+#ifndef COMPRESSION_TEST_UTIL_H
+#define COMPRESSION_TEST_UTIL_H
+
+#include <zlib.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "response.h"
+
+namespace compression_test {
+
+// An HTML page of size bytes, repetitive enough to compress well.
+inline std::string html_page(std::size_t size) {
+    std::string page;
+    for (std::size_t i = 0; page.size() < size; ++i) {
+        page += "<p>paragraph " + std::to_string(i % 100) + "</p>\n";
+    }
+    page.resize(size);
+    return page;
+}
+
+// Everything a producer hands out, read in small pieces.
+inline std::string read_all(body_producer& producer) {
+    std::string body;
+    char piece[1000];
+    std::size_t size = 0;
+    while (producer.read(piece, sizeof(piece), size) && size > 0) {
+        body.append(piece, size);
+    }
+    return body;
+}
+
+// Inflate a zlib (window_bits 15) or gzip (15 + 16) stream of up to 1MB.
+inline std::string inflate_body(const std::string& compressed, int window_bits) {
+    z_stream stream = {};
+    EXPECT_EQ(inflateInit2(&stream, window_bits), Z_OK);
+    std::string body(1 << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = compressed.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&body[0]);
+    stream.avail_out = body.size();
+    EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+    body.resize(stream.total_out);
+    inflateEnd(&stream);
+    return body;
+}
+
+inline std::string gunzip(const std::string& compressed) {
+    return inflate_body(compressed, 15 + 16);
+}
+
+}  // namespace compression_test
+
+#endif  // COMPRESSION_TEST_UTIL_H
@@ -290,3 +290,116 @@ TEST_F(NginxConfigParserTest, BlogHandlerConfig) {
   EXPECT_EQ(test_username2, found_username2);
   EXPECT_EQ(test_password2, found_password2);
 }
+
+TEST_F(NginxConfigParserTest, WorkerThreadsConfig) {
+  bool parsed_correctly = parser.Parse("worker_threads_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.port_number, CORRECT_PORT);
+  EXPECT_EQ(out_config.worker_threads, 8);
+  EXPECT_EQ(out_config.worker_cpu_affinity, NginxConfig::CPU_AFFINITY_OFF);
+  EXPECT_TRUE(out_config.reuse_port);
+}
+
+TEST_F(NginxConfigParserTest, DefaultWorkerThreadsConfig) {
+  bool parsed_correctly = parser.Parse("example_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.worker_threads, 0);  // auto
+  EXPECT_EQ(out_config.worker_cpu_affinity, NginxConfig::CPU_AFFINITY_AUTO);
+  EXPECT_FALSE(out_config.reuse_port);
+}
+
+TEST_F(NginxConfigParserTest, TimeoutConfig) {
+  bool parsed_correctly = parser.Parse("timeout_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.client_header_timeout_ms, 10000);
+  EXPECT_EQ(out_config.client_body_timeout_ms, 30000);
+  EXPECT_EQ(out_config.keepalive_timeout_ms, 500);
+  EXPECT_EQ(out_config.send_timeout_ms, 120000);
+  EXPECT_EQ(out_config.drain_timeout_ms, 5000);
+}
+
+TEST_F(NginxConfigParserTest, ParseDuration) {
+  EXPECT_EQ(NginxConfigParser::ParseDuration("0"), 0);
+  EXPECT_EQ(NginxConfigParser::ParseDuration("75"), 75000);
+  EXPECT_EQ(NginxConfigParser::ParseDuration("250ms"), 250);
+  EXPECT_EQ(NginxConfigParser::ParseDuration("-1"), -1);
+  EXPECT_EQ(NginxConfigParser::ParseDuration("10h"), -1);
+  EXPECT_EQ(NginxConfigParser::ParseDuration("s"), -1);
+}
+
+TEST_F(NginxConfigParserTest, AcceptConfig) {
+  bool parsed_correctly = parser.Parse("accept_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.listen_backlog, 512);
+  EXPECT_EQ(out_config.accept_concurrency, 4);
+  EXPECT_EQ(out_config.accept_flags, SOCK_CLOEXEC);
+  EXPECT_EQ(out_config.io_backend, NginxConfig::IO_BACKEND_IO_URING);
+}
+
+TEST_F(NginxConfigParserTest, DefaultAcceptConfig) {
+  bool parsed_correctly = parser.Parse("example_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.listen_backlog, 0);  // SOMAXCONN
+  EXPECT_EQ(out_config.accept_concurrency, 1);
+  EXPECT_EQ(out_config.accept_flags, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  EXPECT_EQ(out_config.io_backend, NginxConfig::IO_BACKEND_EPOLL);
+}
+
+TEST_F(NginxConfigParserTest, RequestLimitsConfig) {
+  bool parsed_correctly = parser.Parse("limits_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.client_max_uri_size, 2048);
+  EXPECT_EQ(out_config.client_max_header_size, 16384);
+  EXPECT_EQ(out_config.client_max_header_count, 50);
+  EXPECT_EQ(out_config.client_max_body_size, 0);
+  EXPECT_EQ(out_config.location_client_max_body_size_["/upload"], 10 * 1024 * 1024);
+}
+
+TEST_F(NginxConfigParserTest, DefaultRequestLimitsConfig) {
+  bool parsed_correctly = parser.Parse("example_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_EQ(out_config.client_max_uri_size, 8192);
+  EXPECT_EQ(out_config.client_max_header_size, 65536);
+  EXPECT_EQ(out_config.client_max_header_count, 100);
+  EXPECT_EQ(out_config.client_max_body_size, 1024 * 1024);
+  EXPECT_TRUE(out_config.location_client_max_body_size_.empty());
+}
+
+TEST_F(NginxConfigParserTest, CompressionConfig) {
+  bool parsed_correctly = parser.Parse("compression_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_TRUE(out_config.compression.enabled);
+  std::vector<std::string> types = {"text/html", "text/css", "application/javascript"};
+  EXPECT_EQ(out_config.compression.types, types);
+  EXPECT_EQ(out_config.compression.min_length, 256);
+  EXPECT_EQ(out_config.compression.level, 6);
+
+  // A location starts from the server's settings, even ones after it in the file
+  ASSERT_EQ(out_config.location_compression_.size(), 2);
+  const NginxConfig::Compression& blog = out_config.location_compression_["/blog"];
+  EXPECT_TRUE(blog.enabled);
+  EXPECT_EQ(blog.types, types);
+  EXPECT_EQ(blog.min_length, 1024);
+  EXPECT_EQ(blog.level, 9);
+  EXPECT_FALSE(blog.static_variants);
+  EXPECT_FALSE(out_config.location_compression_["/static"].enabled);
+  EXPECT_TRUE(out_config.location_compression_["/static"].static_variants);
+}
+
+TEST_F(NginxConfigParserTest, CompressionIsOffByDefault) {
+  bool parsed_correctly = parser.Parse("example_config", &out_config);
+  EXPECT_TRUE(parsed_correctly);
+  EXPECT_FALSE(out_config.compression.enabled);
+  EXPECT_FALSE(out_config.compression.static_variants);
+  EXPECT_TRUE(out_config.location_compression_.empty());
+}
+
+TEST_F(NginxConfigParserTest, ParseSize) {
+  EXPECT_EQ(NginxConfigParser::ParseSize("0"), 0);
+  EXPECT_EQ(NginxConfigParser::ParseSize("512"), 512);
+  EXPECT_EQ(NginxConfigParser::ParseSize("8k"), 8192);
+  EXPECT_EQ(NginxConfigParser::ParseSize("1g"), 1024LL * 1024 * 1024);
+  EXPECT_EQ(NginxConfigParser::ParseSize("-1"), -1);
+  EXPECT_EQ(NginxConfigParser::ParseSize("1t"), -1);
+  EXPECT_EQ(NginxConfigParser::ParseSize("999999999999999999g"), -1);
+}
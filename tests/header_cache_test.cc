@@ -0,0 +1,31 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "header_cache.h"
+
+TEST(HeaderCacheTest, FormatDate) {
+    char date[header_cache::date_size];
+    header_cache::format_date(784111777, date);
+    EXPECT_EQ(std::string(date, sizeof(date)), "Sun, 06 Nov 1994 08:49:37 GMT");
+    header_cache::format_date(0, date);
+    EXPECT_EQ(std::string(date, sizeof(date)), "Thu, 01 Jan 1970 00:00:00 GMT");
+    header_cache::format_date(1792224000, date);
+    EXPECT_EQ(std::string(date, sizeof(date)), "Sat, 17 Oct 2026 08:00:00 GMT");
+}
+
+TEST(HeaderCacheTest, CommonBlock) {
+    std::string common(header_cache::common());
+    ASSERT_EQ(common.compare(0, header_cache::server_line().size(), header_cache::server_line()), 0);
+    std::string date_line = common.substr(header_cache::server_line().size());
+    EXPECT_EQ(date_line.size(), 6 + header_cache::date_size + 2);
+    EXPECT_EQ(date_line.compare(0, 6, "Date: "), 0);
+    EXPECT_EQ(date_line.compare(date_line.size() - 6, 6, " GMT\r\n"), 0);
+    // Same bytes within a second, and always the same size
+    EXPECT_EQ(header_cache::common().size(), common.size());
+}
+
+TEST(HeaderCacheTest, ConnectionLines) {
+    EXPECT_EQ(header_cache::connection_close(), "Connection: close\r\n");
+    EXPECT_EQ(header_cache::connection_keep_alive(), "Connection: keep-alive\r\n");
+    EXPECT_EQ(header_cache::server_line(), "Server: mrjk-web-server\r\n");
+}
@@ -0,0 +1,97 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "header_map.h"
+
+TEST(HeaderMapTest, LookupIgnoresCase) {
+    header_map headers;
+    headers["Content-Type"] = "text/html";
+    headers["X-Custom"] = "1";
+    EXPECT_EQ(headers["content-type"], "text/html");
+    EXPECT_EQ(headers[header_id::content_type], "text/html");
+    EXPECT_EQ(headers.get(header_id::content_type), "text/html");
+    EXPECT_EQ(headers.at("x-CUSTOM"), "1");
+    EXPECT_EQ(headers.find("x-other"), headers.end());
+    EXPECT_TRUE(headers.get(header_id::host).empty());
+    EXPECT_THROW(headers.at("Host"), std::out_of_range);
+    EXPECT_EQ(headers.size(), 2);
+}
+
+TEST(HeaderMapTest, UpstreamSpellingIsKept) {
+    header_map headers;
+    headers.add("content-length", "12");
+    EXPECT_EQ(headers[header_id::content_length], "12");
+    headers[header_id::content_length] = "13";
+    ASSERT_EQ(headers.size(), 1);
+    EXPECT_EQ(headers.begin()->name, "content-length");
+    EXPECT_EQ(headers.begin()->value, "13");
+}
+
+TEST(HeaderMapTest, DuplicatesKeptInOrder) {
+    header_map headers;
+    headers.add("Set-Cookie", "a=1");
+    headers.add("Host", "example.com");
+    headers.add("set-cookie", "b=2");
+    EXPECT_EQ(headers.count("SET-COOKIE"), 2);
+    EXPECT_EQ(headers["Set-Cookie"], "a=1");
+    ASSERT_EQ(headers.size(), 3);
+    EXPECT_EQ(headers.begin()[2].value, "b=2");
+
+    EXPECT_EQ(headers.erase("Set-Cookie"), 2);
+    ASSERT_EQ(headers.size(), 1);
+    EXPECT_EQ(headers[header_id::host], "example.com");
+}
+
+TEST(HeaderMapTest, EraseKeepsWellKnownIndex) {
+    header_map headers = { {"Accept", "*/*"}, {"Host", "a"}, {"Location", "/b"} };
+    EXPECT_EQ(headers.erase("accept"), 1);
+    EXPECT_EQ(headers.erase("missing"), 0);
+    EXPECT_EQ(headers.get(header_id::host), "a");
+    EXPECT_EQ(headers.get(header_id::location), "/b");
+    EXPECT_EQ(headers.find(header_id::accept), headers.end());
+}
+
+TEST(HeaderMapTest, GrowsPastInlineCapacity) {
+    header_map headers;
+    for (int i = 0; i < 40; ++i) {
+        headers.add("X-Header-" + std::to_string(i), std::to_string(i));
+        if (i == 20) {
+            headers[header_id::host] = "h";
+        }
+    }
+    ASSERT_EQ(headers.size(), 41);
+    EXPECT_EQ(headers["x-header-3"], "3");
+    EXPECT_EQ(headers["X-Header-39"], "39");
+    EXPECT_EQ(headers.get(header_id::host), "h");
+
+    header_map copy = headers;
+    header_map moved = std::move(headers);
+    EXPECT_TRUE(headers.empty());
+    EXPECT_EQ(copy, moved);
+    EXPECT_EQ(moved.get(header_id::host), "h");
+
+    moved.clear();
+    EXPECT_TRUE(moved.empty());
+    EXPECT_TRUE(moved.get(header_id::host).empty());
+}
+
+TEST(HeaderMapTest, EqualityIgnoresOrderAcrossNames) {
+    header_map a = { {"Content-Length", "1"}, {"Content-Type", "text/plain"} };
+    header_map b = { {"content-type", "text/plain"}, {"Content-Length", "1"} };
+    EXPECT_EQ(a, b);
+
+    header_map c = { {"Via", "1"}, {"Via", "2"} };
+    header_map d = { {"Via", "2"}, {"Via", "1"} };
+    EXPECT_NE(c, d);
+    EXPECT_NE(a, c);
+}
+
+TEST(HeaderMapTest, WellKnownIds) {
+    EXPECT_EQ(lookup_header_id("TRANSFER-encoding"), header_id::transfer_encoding);
+    EXPECT_EQ(lookup_header_id("Content-Lengthy"), header_id::other);
+    EXPECT_EQ(header_name(header_id::accept_encoding), "Accept-Encoding");
+    for (int i = 1; i < static_cast<int>(header_id::count); ++i) {
+        header_id id = static_cast<header_id>(i);
+        EXPECT_EQ(lookup_header_id(header_name(id)), id);
+    }
+}
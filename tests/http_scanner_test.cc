@@ -0,0 +1,83 @@
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "http_scanner.h"
+
+class HttpScannerTest : public ::testing::TestWithParam<http_scanner::level> {
+ protected:
+        void SetUp() override {
+            previous_ = http_scanner::active();
+            if (!http_scanner::use(GetParam())) {
+                GTEST_SKIP() << "CPU lacks this implementation";
+            }
+        }
+
+        void TearDown() override {
+            http_scanner::use(previous_);
+        }
+
+        // Per-byte classes from request_parser's checks.
+        static bool is_ctl(int c) { return c <= 31 || c == 127; }
+        static bool is_token(int c) {
+            return c <= 127 && !is_ctl(c) && std::strchr("()<>@,;:\\\"/[]?={} \t", c) == nullptr;
+        }
+
+        http_scanner::level previous_;
+};
+
+// Every byte value at every position of a run longer than one 32-byte block, so the
+// vector loop and the scalar tail both see it.
+TEST_P(HttpScannerTest, StopsAtFirstByteOutsideClass) {
+    for (int c = 0; c < 256; ++c) {
+        for (std::size_t position = 0; position < 70; ++position) {
+            std::string run(70, 'a');
+            run[position] = static_cast<char>(c);
+            const char* begin = run.data();
+            const char* end = begin + run.size();
+
+            std::size_t token = http_scanner::find_token_end(begin, end) - begin;
+            std::size_t uri = http_scanner::find_uri_end(begin, end) - begin;
+            std::size_t value = http_scanner::find_value_end(begin, end) - begin;
+            ASSERT_EQ(token, is_token(c) ? run.size() : position) << "byte " << c;
+            ASSERT_EQ(uri, !is_ctl(c) && c != ' ' ? run.size() : position) << "byte " << c;
+            ASSERT_EQ(value, !is_ctl(c) ? run.size() : position) << "byte " << c;
+        }
+    }
+}
+
+TEST_P(HttpScannerTest, EmptyAndShortInput) {
+    const char* text = "GET";
+    EXPECT_EQ(http_scanner::find_token_end(text, text), text);
+    EXPECT_EQ(http_scanner::find_token_end(text, text + 3), text + 3);
+    EXPECT_EQ(http_scanner::find_uri_end(text, text + 2), text + 2);
+}
+
+TEST_P(HttpScannerTest, HeaderLine) {
+    std::string line = "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n";
+    const char* begin = line.data();
+    const char* end = begin + line.size();
+    const char* colon = http_scanner::find_token_end(begin, end);
+    EXPECT_EQ(std::string(begin, colon), "User-Agent");
+    const char* cr = http_scanner::find_value_end(colon + 2, end);
+    EXPECT_EQ(std::string(colon + 2, cr), "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36");
+}
+
+TEST_P(HttpScannerTest, FindEither) {
+    for (std::size_t position = 0; position < 70; ++position) {
+        std::string run(70, 'a');
+        run[position] = '.';
+        const char* begin = run.data();
+        const char* end = begin + run.size();
+        ASSERT_EQ(http_scanner::find_either(begin, end, '%', '.'), begin + position);
+        ASSERT_EQ(http_scanner::find_either(begin, end, '.', '.'), begin + position);
+        ASSERT_EQ(http_scanner::find_either(begin, end, '%', '+'), end);
+    }
+    std::string path = "/a/very/long/path/to/some/file/name/with%20an/escape";
+    const char* begin = path.data();
+    EXPECT_EQ(http_scanner::find_either(begin, begin + path.size(), '%', '.') - begin, 40);
+}
+
+INSTANTIATE_TEST_SUITE_P(Implementations, HttpScannerTest,
+                         ::testing::Values(http_scanner::scalar, http_scanner::sse42,
+                                           http_scanner::avx2));
@@ -0,0 +1,53 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "header_map.h"
+#include "http_tokens.h"
+#include "request.h"
+#include "response.h"
+
+// The tables are built by the compiler, so they can be checked by it too.
+static_assert(http_tokens::methods.find("OPTIONS") == Request::OPTIONS, "");
+static_assert(http_tokens::headers.find("content-length") ==
+              static_cast<int>(header_id::content_length), "");
+
+TEST(HttpTokensTest, EveryTokenFindsItself) {
+    for (std::size_t i = 0; i < http_tokens::methods.size(); ++i) {
+        EXPECT_EQ(http_tokens::methods.find(http_tokens::methods[i]), static_cast<int>(i));
+    }
+    for (std::size_t i = 0; i < http_tokens::headers.size(); ++i) {
+        EXPECT_EQ(http_tokens::headers.find(http_tokens::headers[i]), static_cast<int>(i));
+    }
+    for (std::size_t i = 0; i < http_tokens::mime_extensions.size(); ++i) {
+        EXPECT_EQ(http_tokens::mime_extensions.find(http_tokens::mime_extensions[i]), static_cast<int>(i));
+    }
+}
+
+TEST(HttpTokensTest, CaseAndUnknownTokens) {
+    EXPECT_EQ(http_tokens::methods.find("get"), -1);
+    EXPECT_EQ(http_tokens::methods.find("PATCH"), -1);
+    EXPECT_EQ(http_tokens::methods.find("GETS"), -1);
+    EXPECT_EQ(http_tokens::headers.find("TRANSFER-ENCODING"), static_cast<int>(header_id::transfer_encoding));
+    EXPECT_EQ(http_tokens::headers.find("X-Forwarded-For"), -1);
+    EXPECT_EQ(lookup_header_id("hOsT"), header_id::host);
+    EXPECT_EQ(lookup_header_id("Hostname"), header_id::other);
+}
+
+TEST(HttpTokensTest, MimeTypes) {
+    EXPECT_EQ(http_tokens::mime_type("html"), "text/html");
+    EXPECT_EQ(http_tokens::mime_type("jpeg"), "image/jpeg");
+    EXPECT_EQ(http_tokens::mime_type("pdf"), "application/pdf");
+    EXPECT_TRUE(http_tokens::mime_type("exe").empty());
+    EXPECT_TRUE(http_tokens::mime_type("").empty());
+}
+
+TEST(HttpTokensTest, StatusLines) {
+    EXPECT_EQ(http_tokens::status_line(Response::ok), "HTTP/1.1 200 OK\r\n");
+    EXPECT_EQ(http_tokens::status_line(Response::moved_temporarily), "HTTP/1.1 302 Found\r\n");
+    EXPECT_EQ(http_tokens::status_line(Response::request_header_fields_too_large),
+              "HTTP/1.1 431 Request Header Fields Too Large\r\n");
+    EXPECT_EQ(http_tokens::status_line(Response::service_unavailable), "HTTP/1.1 503 Service Unavailable\r\n");
+    EXPECT_TRUE(http_tokens::status_line(418).empty());
+    EXPECT_TRUE(http_tokens::status_line(99).empty());
+    EXPECT_TRUE(http_tokens::status_line(600).empty());
+}
@@ -52,6 +52,7 @@ proxy_config1="proxy_config1"
 proxy_config2="proxy_config2"
 
 printf "port 8080; # The port my server listens on
+client_header_timeout 1s;
 
 location \"/echo\" EchoHandler {
 }
@@ -93,8 +94,8 @@ sleep $SLEEPTIME # Wait for Server to Start Up
 # ---------------------------------------------------------------------------- #
 # Run the Tests
 # ---------------------------------------------------------------------------- #
-printf "GET /echo HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sort > $output_file
+printf "GET /echo HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' | sort > $output_file
 
 sort $TEST_DIR/$get_request_file > $sorted_response_file
 diff $output_file $sorted_response_file
@@ -109,8 +110,8 @@ fi
 rm $sorted_response_file
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/masked HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sort > $output_file
+printf "GET /static/masked HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' | sort > $output_file
 
 sort $TEST_DIR/$masked_echo_request_file > $sorted_response_file
 diff $output_file $sorted_response_file
@@ -125,7 +126,7 @@ fi
 rm $sorted_response_file
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/helloworld.txt HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/helloworld.txt HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 12 > $output_file
 
 diff $output_file $STATIC_DIR/helloworld.txt
@@ -139,7 +140,7 @@ fi
 
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /sta%%20tic/helloworld.txt HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /sta%%20tic/helloworld.txt HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 12 > $output_file
 
 diff $output_file $STATIC_DIR/helloworld.txt
@@ -154,7 +155,7 @@ fi
 rm $output_file
 #---------------------------------------------------------------------------------------------------
 # Note that we need to put %%20 here becuase printf normally uses % to indicate format characters
-printf "GET /static/subdirectory/hello%%20world.txt HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/subdirectory/hello%%20world.txt HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 12 > $output_file
 
 diff $output_file $STATIC_DIR/subdirectory/hello\ world.txt
@@ -168,7 +169,7 @@ fi
 
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/subdirectory/two%%20%%20spaces.jpg HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/subdirectory/two%%20%%20spaces.jpg HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 23544 > $output_jpg_file
 
 diff $output_jpg_file $STATIC_DIR/subdirectory/two\ \ spaces.jpg
@@ -182,7 +183,7 @@ fi
 
 rm $output_jpg_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/nothanks.jpg HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/nothanks.jpg HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 23544 > $output_jpg_file
 
 diff $output_jpg_file $STATIC_DIR/nothanks.jpg
@@ -196,7 +197,7 @@ fi
 
 rm $output_jpg_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/subdirectory/helloworld.png HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/subdirectory/helloworld.png HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 18664 > $output_png_file
 
 diff $output_png_file $STATIC_DIR/subdirectory/helloworld.png
@@ -210,7 +211,7 @@ fi
 
 rm $output_png_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/hack.gif HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/hack.gif HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 3516529 > $output_gif_file
 
 diff $output_gif_file $STATIC_DIR/hack.gif
@@ -223,7 +224,7 @@ fi
 
 rm $output_gif_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/kek.html HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/kek.html HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 255791 > $output_html_file
 
 diff $output_html_file $STATIC_DIR/kek.html
@@ -237,7 +238,7 @@ fi
 
 rm $output_html_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/zippitydooda.zip HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/zippitydooda.zip HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 42266 > $output_zip_file
 
 diff $output_zip_file $STATIC_DIR/zippitydooda.zip
@@ -251,7 +252,7 @@ fi
 
 rm $output_zip_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/hulkhogan.pdf HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+printf "GET /static/hulkhogan.pdf HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
 Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | tail -c 77885 > $output_pdf_file
 
 diff $output_pdf_file $STATIC_DIR/hulkhogan.pdf
@@ -265,8 +266,8 @@ fi
 
 rm $output_pdf_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static/nonexistent.txt HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT > $output_file
+printf "GET /static/nonexistent.txt HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' > $output_file
 
 diff $output_file $TEST_DIR/$not_found_request_file
 
@@ -279,8 +280,8 @@ fi
 
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /static2939/nonexistentpath.txt HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT > $output_file
+printf "GET /static2939/nonexistentpath.txt HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' > $output_file
 
 diff $output_file $TEST_DIR/$not_found_request_file
 
@@ -293,14 +294,14 @@ fi
 
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "POST /echo2 HTTP/1.1\r\nHost: 34.83.52.12\r\n\
+printf "POST /echo2 HTTP/1.1\r\nConnection: close\r\nHost: 34.83.52.12\r\n\
 Upgrade-Insecure-Requests: 1\r\n\
 User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_14_0) AppleWebKit/537.36 \
 (KHTML, like Gecko) Chrome/80.0.3987.149 Safari/537.36\r\nAccept: \
 text/html,application/xhtml+xml,application/xml;q=0.9,\
 image/webp,image/apng,*/*;q=0.8,application/signed-exchange;\
 v=b3;q=0.9\r\nAccept-Encoding: gzip, deflate\r\nAccept-Language: \
-en-US,en;q=0.9\r\n\r\n" | nc $IP_ADDRESS $PORT | sort > $output_file
+en-US,en;q=0.9\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' | sort > $output_file
 
 sort $TEST_DIR/$post_request_file > $sorted_response_file
 diff $output_file $sorted_response_file
@@ -339,7 +340,7 @@ Content-Length: 1394\r\nHost: 127.1.1.1\r\n\r\nonce upon a time\
 ...............................................................\
 ...............................................................\
 ................................................the end" |\
-nc $IP_ADDRESS $PORT | sort > $output_file
+nc $IP_ADDRESS $PORT | sed '/^Date: /d' | sort > $output_file
 
 sort $TEST_DIR/$long_body_request_file > $sorted_response_file
 diff $output_file $sorted_response_file
@@ -356,7 +357,7 @@ rm $output_file
 #---------------------------------------------------------------------------------------------------
 printf "GET /echo2 HTTP/1.1\r\nConnection: Keep-Alive\r\nUser-Agent: nc/0.0.1\r\n\
 Host: 127.0.0.1\r\nAccept: */*\r\n\r\n" |\
-timeout .3 nc $IP_ADDRESS $PORT | sort > $output_file
+timeout .3 nc $IP_ADDRESS $PORT | sed '/^Date: /d' | sort > $output_file
 
 sort $TEST_DIR/$keep_alive_request_file > $sorted_response_file
 diff $output_file $sorted_response_file
@@ -374,9 +375,12 @@ rm $output_file
 printf "POST /test/test.php HTTP/1.0\r\nUser-Agent: Firefox\r\n\
 Content-Length: 30\r\nHost: 127.1.1.1\r\n\r\nonce upon a time\
 .....................................................the end" |\
-nc $IP_ADDRESS $PORT > $output_file
+nc $IP_ADDRESS $PORT | sed '/^Date: /d' > $output_file
 
-diff $output_file $TEST_DIR/$bad_request_file
+# The first 30 bytes of body complete the request (an unmapped path), and the
+# rest is dropped because the HTTP/1.0 connection closes after the response,
+# which answers with the request's version.
+sed 's#^HTTP/1.1 #HTTP/1.0 #' $TEST_DIR/$not_found_request_file | diff $output_file -
 
 if [ $? != 0 ]
 then
@@ -385,10 +389,44 @@ then
     exit 1 # Exit Failure
 fi
 
+rm $output_file
+#---------------------------------------------------------------------------------------------------
+# Three pipelined requests in one packet, answered in order on the same connection.
+# HTTP/1.1 keeps the connection open without a Connection header, until the last
+# request asks to close it.
+printf "GET /health HTTP/1.1\r\n\r\n\
+GET /health HTTP/1.1\r\n\r\n\
+GET /health HTTP/1.1\r\nConnection: close\r\n\r\n" | nc $IP_ADDRESS $PORT | grep -o "200 OK" | wc -l > $output_file
+echo 3 > ok.txt
+
+diff -w $output_file ok.txt
+
+if [ $? != 0 ]
+then
+    echo "FAILED: PipelinedRequests"
+    rm ok.txt
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+rm $output_file
+rm ok.txt
+#---------------------------------------------------------------------------------------------------
+# A client that stops halfway through the request head is disconnected once
+# client_header_timeout (1s above) runs out, so nc returns before its own timeout.
+(printf "GET /echo HT"; sleep 3) | timeout 2.5 nc $IP_ADDRESS $PORT > $output_file
+
+if [ $? != 0 ]
+then
+    echo "FAILED: HeaderTimeout"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
 rm $output_file
 #---------------------------------------------------------------------------------------------------
 printf "GET / HTTP/1.1\r\nUser-Agent: nc/0.0.1\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT > $output_file
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' > $output_file
 
 diff $output_file $TEST_DIR/$bad_request_file
 
@@ -401,8 +439,8 @@ fi
 
 rm $output_file
 #---------------------------------------------------------------------------------------------------
-printf "GET /status HTTP/1.1\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
-Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT > $output_file
+printf "GET /status HTTP/1.1\r\nConnection: close\r\nUser-Agent: nc/0.0.1\r\nHost: 127.0.0.1\r\n\
+Accept: */*\r\n\r\n" | nc $IP_ADDRESS $PORT | sed '/^Date: /d' > $output_file
 
 diff $output_file $TEST_DIR/$status_request_file
 
@@ -434,7 +472,36 @@ rm ok.txt
 # ---------------------------------------------------------------------------- #
 # Stop the WebServer
 # ---------------------------------------------------------------------------- #
+# SIGTERM drains: the idle keep-alive connection below is closed and the server
+# exits cleanly well before drain_timeout, rather than waiting on the client.
+(printf "GET /health HTTP/1.1\r\nConnection: Keep-Alive\r\n\r\n"; sleep 5) | \
+    timeout 4 nc $IP_ADDRESS $PORT > $output_file &
+NC_PID=$!
+sleep $SLEEPTIME
 kill $WEBSERVER_PID
+
+for i in $(seq 1 40)
+do
+    kill -0 $WEBSERVER_PID 2> /dev/null || break
+    sleep 0.05
+done
+
+if kill -0 $WEBSERVER_PID 2> /dev/null
+then
+    echo "FAILED: GracefulDrain"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+wait $WEBSERVER_PID
+if [ $? != 0 ]
+then
+    echo "FAILED: GracefulDrain"
+    exit 1 # Exit Failure
+fi
+
+wait $NC_PID
+rm $output_file
 rm $CONFIG_NAME
 
 # ---------------------------------------------------------------------------- #
@@ -471,12 +538,194 @@ then
     exit 1 # Exit Failure
 fi
 
+# The body is forwarded to the echo handler as it arrives, and comes back at the
+# end of the echoed request.
+upload_file="upload.txt"
+yes "streamed upload" | head -c 1048576 > $upload_file
+curl -s --data-binary @$upload_file http://localhost:8080/proxy | tail -c 1048576 > "$output_file"
+diff $output_file $upload_file > /dev/null
+
+if [ $? != 0 ]
+then
+    echo "FAILED: EchoProxyUpload"
+    kill $WEBSERVER1_PID
+    kill $WEBSERVER2_PID
+    exit 1 # Exit Failure
+fi
+
+# A client that asks first is told to go on before it sends the body.
+curl -sv -H "Expect: 100-continue" --expect100-timeout 30 --data-binary @$upload_file \
+    http://localhost:8080/proxy 2> "$request_log" | tail -c 1048576 > "$output_file"
+grep -q "< HTTP/1.1 100 Continue" "$request_log" && diff $output_file $upload_file > /dev/null
+
+if [ $? != 0 ]
+then
+    echo "FAILED: ExpectContinue"
+    kill $WEBSERVER1_PID
+    kill $WEBSERVER2_PID
+    exit 1 # Exit Failure
+fi
+
+# While an upload holds the only in-flight slot of /proxy (see proxy_config1), a
+# client that asks first is refused with a 503 instead of being told to go on, and
+# the connection closes after it.
+(printf "POST /proxy HTTP/1.1\r\nContent-Length: 100\r\n\r\nhalf"; sleep 3) | \
+    timeout 2.5 nc $IP_ADDRESS $PORT > /dev/null &
+HOLD_PID=$!
+sleep $SLEEPTIME
+(printf "POST /proxy HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 100\r\n\r\n"; sleep 3) | \
+    timeout 2.5 nc $IP_ADDRESS $PORT > $output_file
+
+if [ $? != 0 ] || ! head -1 $output_file | grep -q "^HTTP/1.1 503 " || grep -q "100 Continue" $output_file
+then
+    echo "FAILED: ExpectContinueShed"
+    kill $WEBSERVER1_PID
+    kill $WEBSERVER2_PID
+    exit 1 # Exit Failure
+fi
+
+wait $HOLD_PID
+rm $upload_file
+rm $output_file
+rm $request_log
+
 # ---------------------------------------------------------------------------- #
 # Kill Both webservers
 # ---------------------------------------------------------------------------- #
 kill $WEBSERVER1_PID
 kill $WEBSERVER2_PID
 
+# ---------------------------------------------------------------------------- #
+# Start a server with request size limits and do limit tests
+# ---------------------------------------------------------------------------- #
+sleep $SLEEPTIME # Wait for Servers to Shutdown
+$SRC_DIR/$BINARY_NAME $TEST_DIR"/limits_config" &
+WEBSERVER_PID=$!
+sleep $SLEEPTIME
+
+# Each request is over a limit of limits_config and answered with the status below.
+# The connection closes once that is written, so nc returns before its own timeout
+# although its input is still open, and the request pipelined after is never answered.
+long_uri=$(head -c 3000 /dev/zero | tr '\0' 'a')
+long_header=$(head -c 17000 /dev/zero | tr '\0' 'a')
+for limit in "414 GET /echo/$long_uri HTTP/1.1\r\n\r\n" \
+             "431 GET /echo HTTP/1.1\r\nX-Long: $long_header\r\n\r\n" \
+             "413 POST /upload HTTP/1.1\r\nContent-Length: 20000000\r\n\r\n"
+do
+    status=${limit%% *}
+    (printf "${limit#* }GET /upload HTTP/1.1\r\n\r\n"; sleep 3) | \
+        timeout 2.5 nc $IP_ADDRESS $PORT > $output_file
+
+    if [ $? != 0 ] || ! head -1 $output_file | grep -q "^HTTP/1.1 $status " || \
+       [ $(grep -c "^HTTP/1.1 " $output_file) != 1 ]
+    then
+        echo "FAILED: Rejection$status"
+        kill -9 $WEBSERVER_PID
+        exit 1 # Exit Failure
+    fi
+done
+
+# A client that asks first about a body over the limit is refused with a 413
+# instead of being told to go on, and the connection closes after it.
+(printf "POST /upload HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 20000000\r\n\r\n"; sleep 3) | \
+    timeout 2.5 nc $IP_ADDRESS $PORT > $output_file
+
+if [ $? != 0 ] || ! head -1 $output_file | grep -q "^HTTP/1.1 413 " || grep -q "100 Continue" $output_file
+then
+    echo "FAILED: ExpectContinueTooLarge"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+rm $output_file
+kill $WEBSERVER_PID
+
+# ---------------------------------------------------------------------------- #
+# Start a compressing server and do streamed body tests
+# ---------------------------------------------------------------------------- #
+# Compressed files are produced as they are sent, so their length is not known up
+# front. The second root holds a file that is cut short while it is sent.
+stream_root=$(mktemp -d)
+head -c 52428800 /dev/zero > $stream_root/big.txt
+printf "port 8080;
+gzip on;
+
+location \"/echo\" EchoHandler {
+}
+
+location \"/static\" StaticHandler {
+  root \"../files\";
+}
+
+location \"/shrinking\" StaticHandler {
+  root \"$stream_root\";
+}
+" > $CONFIG_NAME;
+
+sleep $SLEEPTIME # Wait for Server to Shutdown
+$SRC_DIR/$BINARY_NAME $CONFIG_NAME &
+WEBSERVER_PID=$!
+sleep $SLEEPTIME
+
+# An HTTP/1.1 client gets the body in chunks, ended by the last chunk.
+curl -s --raw -H "Accept-Encoding: gzip" -D $request_log \
+    http://localhost:$PORT/static/kek.html -o $output_file
+curl -s --compressed http://localhost:$PORT/static/kek.html | diff - $STATIC_DIR/kek.html > /dev/null
+
+if [ $? != 0 ] || ! grep -qi "^Transfer-Encoding: chunked" $request_log || \
+   grep -qi "^Content-Length" $request_log || [ "$(tail -c 5 $output_file)" != "$(printf "0\r\n\r\n")" ]
+then
+    echo "FAILED: ChunkedBody"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+# An HTTP/1.0 client cannot take chunks, so the end of the body is the end of the
+# connection.
+curl -s --http1.0 --compressed --max-time 5 -D $request_log \
+    http://localhost:$PORT/static/kek.html -o $output_file && diff $output_file $STATIC_DIR/kek.html > /dev/null
+
+if [ $? != 0 ] || grep -qi "^Transfer-Encoding\|^Content-Length" $request_log
+then
+    echo "FAILED: CloseDelimitedBody"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+# A request pipelined behind a streamed body is answered after its last chunk.
+printf "GET /static/kek.html HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n\
+GET /echo HTTP/1.1\r\nConnection: close\r\n\r\n" | nc $IP_ADDRESS $PORT > $output_file
+echo_line=$(grep -a -n "^HTTP/1.1 200 OK" $output_file | sed -n 2p | cut -d: -f1)
+
+if [ -z "$echo_line" ] || \
+   [ "$(sed -n "$((echo_line - 2)),$((echo_line - 1))p" $output_file)" != "$(printf "0\r\n\r")" ]
+then
+    echo "FAILED: PipelinedBehindStreamedBody"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+# A file that shrinks while it is sent ends before its Content-Length. The
+# connection closes, so the client sees the body cut short instead of waiting on it.
+curl -s --limit-rate 1M --max-time 10 http://localhost:$PORT/shrinking/big.txt -o /dev/null &
+CURL_PID=$!
+sleep $SLEEPTIME
+truncate -s 0 $stream_root/big.txt
+wait $CURL_PID
+
+if [ $? != 18 ] # Partial file
+then
+    echo "FAILED: BodyEndsEarly"
+    kill -9 $WEBSERVER_PID
+    exit 1 # Exit Failure
+fi
+
+rm -r $stream_root
+rm $output_file
+rm $request_log
+rm $CONFIG_NAME
+kill $WEBSERVER_PID
+
 # ---------------------------------------------------------------------------- #
 # Tests passed and Exit
 # ---------------------------------------------------------------------------- #
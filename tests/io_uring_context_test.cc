@@ -0,0 +1,150 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <boost/asio.hpp>
+
+#include "gtest/gtest.h"
+#include "io_uring_context.h"
+
+using boost::asio::ip::tcp;
+
+class IoUringContextTest : public ::testing::Test {
+ protected:
+        void SetUp() override {
+            if (!io_uring_context::supported()) {
+                GTEST_SKIP() << "io_uring is not available";
+            }
+            uring_.reset(new io_uring_context(io_service_, false));
+            ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds_), 0);
+        }
+
+        void TearDown() override {
+            if (uring_) {
+                close(fds_[0]);
+                close(fds_[1]);
+            }
+        }
+
+        // Runs the io_service until done is set, or gives up after a second.
+        void run_until(const bool& done) {
+            for (int i = 0; i < 1000 && !done; ++i) {
+                io_service_.run_for(std::chrono::milliseconds(1));
+                io_service_.restart();
+            }
+        }
+
+        boost::asio::io_service io_service_;
+        std::unique_ptr<io_uring_context> uring_;
+        int fds_[2];
+};
+
+TEST_F(IoUringContextTest, RecvIntoProvidedBuffer) {
+    io_uring_context::operation op;
+    bool done = false;
+    std::string received;
+    op.on_complete = [&](int result, unsigned flags) {
+        ASSERT_EQ(result, 5);
+        received.assign(uring_->buffer(flags), result);
+        uring_->recycle_buffer(flags);
+        done = true;
+    };
+    uring_->async_recv(fds_[0], op);
+    ASSERT_EQ(write(fds_[1], "hello", 5), 5);
+    run_until(done);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(received, "hello");
+}
+
+TEST_F(IoUringContextTest, RecvSeesEof) {
+    io_uring_context::operation op;
+    int result = -1;
+    op.on_complete = [&](int r, unsigned flags) {
+        uring_->recycle_buffer(flags);
+        result = r;
+    };
+    uring_->async_recv(fds_[0], op);
+    shutdown(fds_[1], SHUT_WR);
+    bool done = false;
+    for (int i = 0; i < 1000 && result == -1; ++i) {
+        run_until(done);
+    }
+    EXPECT_EQ(result, 0);
+}
+
+TEST_F(IoUringContextTest, SendmsgWithLinkedShutdown) {
+    io_uring_context::operation op;
+    bool done = false;
+    int result = 0;
+    op.on_complete = [&](int r, unsigned) {
+        result = r;
+        done = true;
+    };
+    char first[] = "GET ";
+    char second[] = "/echo";
+    iovec iov[2] = { { first, 4 }, { second, 5 } };
+    msghdr msg = msghdr();
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    uring_->async_sendmsg(fds_[0], &msg, true, op);
+    run_until(done);
+    EXPECT_EQ(result, 9);
+
+    // Both buffers arrive in order, followed by the FIN of the linked shutdown.
+    char buffer[16];
+    ASSERT_EQ(read(fds_[1], buffer, sizeof(buffer)), 9);
+    EXPECT_EQ(std::string(buffer, 9), "GET /echo");
+    EXPECT_EQ(read(fds_[1], buffer, sizeof(buffer)), 0);
+}
+
+TEST_F(IoUringContextTest, MultishotAcceptUntilCancelled) {
+    tcp::acceptor acceptor(io_service_, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    io_uring_context::operation op;
+    int accepted = 0;
+    bool ended = false;
+    op.on_complete = [&](int result, unsigned flags) {
+        if (result >= 0) {
+            ++accepted;
+            close(result);
+        } else {
+            EXPECT_EQ(result, -ECANCELED);
+        }
+        ended = !io_uring_context::more_completions(flags);
+    };
+    uring_->async_accept(acceptor.native_handle(), SOCK_NONBLOCK | SOCK_CLOEXEC, true, op);
+
+    std::vector<std::unique_ptr<tcp::socket> > clients;
+    for (int i = 0; i < 3; ++i) {
+        clients.emplace_back(new tcp::socket(io_service_));
+        clients.back()->connect(acceptor.local_endpoint());
+    }
+    bool three = false;
+    for (int i = 0; i < 1000 && accepted < 3; ++i) {
+        run_until(three);
+    }
+    EXPECT_EQ(accepted, 3);
+    EXPECT_FALSE(ended);
+
+    uring_->async_cancel(op);
+    run_until(ended);
+    EXPECT_TRUE(ended);
+}
+
+TEST_F(IoUringContextTest, ContextsHaveSeparateBuffers) {
+    io_uring_context other(io_service_, false);
+    io_uring_context::operation op;
+    bool done = false;
+    std::string received;
+    op.on_complete = [&](int result, unsigned flags) {
+        ASSERT_EQ(result, 3);
+        received.assign(other.buffer(flags), result);
+        other.recycle_buffer(flags);
+        done = true;
+    };
+    other.async_recv(fds_[0], op);
+    ASSERT_EQ(write(fds_[1], "abc", 3), 3);
+    run_until(done);
+    EXPECT_EQ(received, "abc");
+}
@@ -0,0 +1,106 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+#include "gtest/gtest.h"
+#include "listener_handoff.h"
+
+using boost::asio::ip::tcp;
+
+class ListenerHandoffTest : public ::testing::Test {
+ protected:
+        ListenerHandoffTest() : acceptor_(io_service_, tcp::endpoint(tcp::v4(), 0)) {
+            port_ = acceptor_.local_endpoint().port();
+        }
+
+        void TearDown() override {
+            unsetenv(listener_handoff::listen_fds_env);
+            unsetenv(listener_handoff::ready_fd_env);
+        }
+
+        boost::asio::io_service io_service_;
+        tcp::acceptor acceptor_;
+        int port_;
+};
+
+TEST_F(ListenerHandoffTest, NothingInherited) {
+    listener_handoff handoff;
+    EXPECT_FALSE(handoff.inherited());
+    EXPECT_EQ(handoff.take(0, port_), -1);
+}
+
+TEST_F(ListenerHandoffTest, TakesListeningSocketOnConfiguredPort) {
+    int fd = dup(acceptor_.native_handle());
+    setenv(listener_handoff::listen_fds_env, std::to_string(fd).c_str(), 1);
+
+    listener_handoff handoff;
+    EXPECT_TRUE(handoff.inherited());
+    EXPECT_EQ(getenv(listener_handoff::listen_fds_env), nullptr);
+    EXPECT_EQ(handoff.take(0, port_ + 1), -1);
+    EXPECT_EQ(handoff.take(0, port_), fd);
+    EXPECT_EQ(handoff.take(0, port_), -1);
+    EXPECT_EQ(handoff.take(1, port_), -1);
+    close(fd);
+}
+
+TEST_F(ListenerHandoffTest, IgnoresNonListeningFds) {
+    int unbound = socket(AF_INET, SOCK_STREAM, 0);
+    std::string fds = std::to_string(unbound) + ",junk,999999";
+    setenv(listener_handoff::listen_fds_env, fds.c_str(), 1);
+
+    listener_handoff handoff;
+    EXPECT_FALSE(handoff.inherited());
+    close(unbound);
+}
+
+TEST_F(ListenerHandoffTest, NotifyReadyWritesToPipe) {
+    int ready_pipe[2];
+    ASSERT_EQ(pipe(ready_pipe), 0);
+    setenv(listener_handoff::ready_fd_env, std::to_string(ready_pipe[1]).c_str(), 1);
+
+    listener_handoff handoff;
+    handoff.notify_ready();
+    char byte = 0;
+    EXPECT_EQ(read(ready_pipe[0], &byte, 1), 1);
+    // The write end is closed after the one byte.
+    EXPECT_EQ(read(ready_pipe[0], &byte, 1), 0);
+    close(ready_pipe[0]);
+}
+
+TEST_F(ListenerHandoffTest, DestructorWithoutNotifyClosesPipe) {
+    int ready_pipe[2];
+    ASSERT_EQ(pipe(ready_pipe), 0);
+    setenv(listener_handoff::ready_fd_env, std::to_string(ready_pipe[1]).c_str(), 1);
+    {
+        listener_handoff handoff;
+    }
+    char byte = 0;
+    EXPECT_EQ(read(ready_pipe[0], &byte, 1), 0);
+    close(ready_pipe[0]);
+}
+
+TEST_F(ListenerHandoffTest, SpawnedProcessInheritsListeningSocket) {
+    // The child checks the named fd is still a socket after exec, then reports ready.
+    std::string script = "fd=${WEBSERVER_LISTEN_FDS}; test -S /proc/self/fd/$fd && "
+        "printf x >&${WEBSERVER_READY_FD}";
+    std::vector<char*> argv = {const_cast<char*>("sh"), const_cast<char*>("-c"),
+                               &script[0], nullptr};
+    std::vector<int> fds = {acceptor_.native_handle()};
+    int ready_fd = -1;
+    pid_t pid = listener_handoff::spawn(argv.data(), fds, &ready_fd);
+    ASSERT_GT(pid, 0);
+
+    char byte = 0;
+    EXPECT_EQ(read(ready_fd, &byte, 1), 1);
+    EXPECT_EQ(byte, 'x');
+    close(ready_fd);
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
@@ -24,6 +24,7 @@ Date Created:
 """
 from subprocess import Popen
 from subprocess import PIPE
+import re
 import socket
 import sys
 import os
@@ -68,15 +69,19 @@ time.sleep(1);
 # ---------------------------------------------------------------------------- #
 expected_multithreaded_output = (
     "HTTP/1.0 200 OK\r\n"
+    "Server: mrjk-web-server\r\n"
     "Content-Length: 22\r\n"
     "Content-Type: text/plain\r\n"
+    "Connection: close\r\n"
     "\r\n"
     "GET /echo HTTP/1.0\r\n"
     "\r\n"
 )
 
 def diff_check(multithreaded_output):
-    if not multithreaded_output == expected_multithreaded_output:
+    # The Date header changes every second, so only its presence is checked
+    multithreaded_output, dates = re.subn(r"Date: [^\r]* GMT\r\n", "", multithreaded_output)
+    if dates != 1 or not multithreaded_output == expected_multithreaded_output:
         exit_code = 1
         sys.stdout.write("\nFAILED to match the following server output:\n")
         sys.stdout.write(expected_multithreaded_output)
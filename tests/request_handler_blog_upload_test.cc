@@ -51,7 +51,7 @@ TEST_F(Blog_Upload_Request_Handler_Test, GetBlogUploadFailureTest) {
   html_body_get_response += "</body>\n</html>\n";
 
   Response test = blog_upload_request_handler_->handle_request(request_);
-  std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(test.body_.size())}, {"Content-Type", "text/html"} };
+  header_map response_header = { {"Content-Length", std::to_string(test.body_.size())}, {"Content-Type", "text/html"} };
   EXPECT_EQ(test.code_, Response::ok);
   EXPECT_EQ(test.body_, html_body_get_response);
   EXPECT_EQ(test.headers_, response_header);
@@ -64,7 +64,7 @@ TEST_F(Blog_Upload_Request_Handler_Test, POSTBlogUploadSuccessTest) {
   const std::string entry_number = "1";
 
   Response test = blog_upload_request_handler_->handle_request(request_);
-  std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(test.body_.size())}, {"Content-Type", "text/html"}, {"Location", std::string(blog_upload_request_handler_->getLocationPrefix()) + "/" + entry_number} };
+  header_map response_header = { {"Content-Length", std::to_string(test.body_.size())}, {"Content-Type", "text/html"}, {"Location", std::string(blog_upload_request_handler_->getLocationPrefix()) + "/" + entry_number} };
   EXPECT_EQ(test.code_, Response::moved_temporarily);
   EXPECT_EQ(test.headers_, response_header);
 
@@ -84,7 +84,7 @@ TEST_F(Blog_Upload_Request_Handler_Test, POSTBlogUploadSuccessTest) {
   html_body_get_response += std::string("<p>\n") + "</p>\n";
   html_body_get_response += "</body>\n<div style=\"position: fixed;bottom: 0;right: 0;\">POSTID: " + entry_number + "</div></html>\n";
 
-  std::map<std::string, std::string> response_header_2 = { {"Content-Length", std::to_string(test_2.body_.size())}, {"Content-Type", "text/html"} };
+  header_map response_header_2 = { {"Content-Length", std::to_string(test_2.body_.size())}, {"Content-Type", "text/html"} };
   EXPECT_EQ(test_2.code_, Response::ok);
   EXPECT_EQ(test_2.body_, html_body_get_response);
   EXPECT_EQ(test_2.headers_, response_header_2);
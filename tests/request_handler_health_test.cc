@@ -26,7 +26,7 @@ TEST_F(HealthRequestHandler, SimpleGetRequest) {
             request_builder_, request_data, request_data + sizeof(request_data));
   response_ = health_request_handler_.handle_request(request_builder_.build_request());
   EXPECT_EQ(response_.code_, Response::ok);
-  EXPECT_EQ(response_.body_, text_payload);
-  std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+  EXPECT_EQ(response_.body(), text_payload);
+  header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
   EXPECT_EQ(response_.headers_, response_header);
 }
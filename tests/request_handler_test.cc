@@ -27,9 +27,9 @@ TEST_F(RequestHandlerTest, GETRequest) {
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
 
     EXPECT_EQ(response_.headers_, response_header);
 }
@@ -48,9 +48,9 @@ TEST_F(RequestHandlerTest, BadRequest) {
     "<head><title>Bad Request</title></head>"
     "<body><h1>400 Bad Request</h1></body>"
     "</html>";
-    EXPECT_EQ(response_.body_, std::string(bad_request));
+    EXPECT_EQ(response_.body(), std::string(bad_request));
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/html"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/html"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -66,9 +66,9 @@ TEST_F(RequestHandlerTest, EmptyRequest) {
     "<head><title>Bad Request</title></head>"
     "<body><h1>400 Bad Request</h1></body>"
     "</html>";
-    EXPECT_EQ(response_.body_, std::string(bad_request));
+    EXPECT_EQ(response_.body(), std::string(bad_request));
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/html"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/html"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -85,9 +85,9 @@ User-Agent: nc/0.01\r\nHost: 127.0.0.1\r\nAccept: */*\r\n\r\nBODY";
     "<head><title>Bad Request</title></head>"
     "<body><h1>400 Bad Request</h1></body>"
     "</html>";
-    EXPECT_EQ(response_.body_, std::string(bad_request));
+    EXPECT_EQ(response_.body(), std::string(bad_request));
 
-   std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/html"} };
+   header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/html"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -99,9 +99,9 @@ TEST_F(RequestHandlerTest, EmptyBodyRequest) {
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -114,9 +114,9 @@ name1=value1&name2=value2";
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -161,9 +161,9 @@ the end";
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -211,9 +211,9 @@ the end";
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -247,9 +247,9 @@ once upon a time.............................\
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
 
@@ -283,8 +283,8 @@ once upon a time.............................\
 
     response_ = echo_request_handler_.handle_request(request_builder_.build_request());
     EXPECT_EQ(response_.code_, Response::ok);
-    EXPECT_EQ(response_.body_, data);
+    EXPECT_EQ(response_.body(), data);
 
-    std::map<std::string, std::string> response_header = { {"Content-Length", std::to_string(response_.body_.size())}, {"Content-Type", "text/plain"} };
+    header_map response_header = { {"Content-Length", std::to_string(response_.body().size())}, {"Content-Type", "text/plain"} };
     EXPECT_EQ(response_.headers_, response_header);
 }
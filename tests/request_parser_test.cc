@@ -27,7 +27,7 @@ TEST_F(RequestParserTest, ParseGETRequest) {
     EXPECT_EQ(request_.uri, "/index.html");
     EXPECT_EQ(request_.http_version_major, 1);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
     EXPECT_TRUE(request_.headers.empty());
 }
@@ -47,7 +47,7 @@ TEST_F(RequestParserTest, ParseTwoPartGETRequest) {
     EXPECT_EQ(request_.uri, "/index.html");
     EXPECT_EQ(request_.http_version_major, 1);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
     EXPECT_TRUE(request_.headers.empty());
 }
@@ -62,11 +62,49 @@ TEST_F(RequestParserTest, ParseBadRequest) {
 TEST_F(RequestParserTest, ParseGETRequestWithIllegalBody) {
     char data[] = "GET /index.html HTTP/1.1\r\n\r\n\
 i shouldn't be sending this unless i have a content length";
-    std::tie(result, std::ignore) = request_parser_.parse(
+    char* consumed_end;
+    std::tie(result, consumed_end) = request_parser_.parse(
               request_, data, data + strlen(data));
+    // Without a content length the request ends at the blank line, and the rest
+    // is left over as the start of the next request.
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(std::string(consumed_end), "i shouldn't be sending this unless i have a content length");
+
+    request_parser_.reset();
+    request_builder next_request;
+    std::tie(result, std::ignore) = request_parser_.parse(
+              next_request, consumed_end, data + strlen(data));
     EXPECT_EQ(result, request_parser::bad);
 }
 
+TEST_F(RequestParserTest, ParsePipelinedRequests) {
+    char data[] = "GET /echo HTTP/1.1\r\nConnection: keep-alive\r\n\r\n\
+POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nBODY\
+GET /health HTTP/1.1\r\n\r\n";
+    char* begin = data;
+    char* end = data + strlen(data);
+
+    std::tie(result, begin) = request_parser_.parse(request_, begin, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.method, "GET");
+    EXPECT_EQ(request_.uri, "/echo");
+    EXPECT_TRUE(request_.keep_alive);
+
+    request_parser_.reset();
+    request_builder second;
+    std::tie(result, begin) = request_parser_.parse(second, begin, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(second.method, "POST");
+    EXPECT_EQ(std::string(second.body.begin(), second.body.end()), "BODY");
+
+    request_parser_.reset();
+    request_builder third;
+    std::tie(result, begin) = request_parser_.parse(third, begin, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(third.uri, "/health");
+    EXPECT_EQ(begin, end);
+}
+
 TEST_F(RequestParserTest, ParseEmptyRequest) {
     char data[] = "";
     std::tie(result, std::ignore) = request_parser_.parse(
@@ -85,16 +123,16 @@ User-Agent: nc/0.01\r\nHost: 127.0.0.1\r\nAccept: */*\r\nContent-Length: 4\r\n\r
     EXPECT_EQ(request_.uri, "/");
     EXPECT_EQ(request_.http_version_major, 2);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "nc/0.01"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"},
-        header{"Content-Length", "4"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "nc/0.01"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"},
+        header_view{"Content-Length", "4"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 
@@ -109,15 +147,15 @@ User-Agent: Chrome\r\nHost: 127.0.0.1\r\nAccept: */*\r\n\r\n";
     EXPECT_EQ(request_.uri, "/test.html");
     EXPECT_EQ(request_.http_version_major, 3);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Chrome"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Chrome"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, ParsePOSTRequest) {
@@ -134,13 +172,13 @@ name1=value1&name2=value2";
     EXPECT_EQ(request_.http_version_minor, 0);
     EXPECT_FALSE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Firefox"},
-        header{"Host", "127.1.1.1"},
-        header{"Content-Length", "25"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Firefox"},
+        header_view{"Host", "127.1.1.1"},
+        header_view{"Content-Length", "25"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, ParseEmptyBodyPOSTRequest) {
@@ -156,13 +194,13 @@ User-Agent: Firefox\r\nHost: 127.1.1.1\r\nContent-Length: 0\r\n\r\n";
     EXPECT_EQ(request_.http_version_minor, 0);
     EXPECT_FALSE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Firefox"},
-        header{"Host", "127.1.1.1"},
-        header{"Content-Length", "0"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Firefox"},
+        header_view{"Host", "127.1.1.1"},
+        header_view{"Content-Length", "0"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, ParseIncorrentContentLengthPOSTRequest) {
@@ -201,13 +239,13 @@ a...................................................................\
     EXPECT_EQ(request_.http_version_minor, 0);
     EXPECT_FALSE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Firefox"},
-        header{"Host", "127.1.1.1"},
-        header{"Content-Length", "1024"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Firefox"},
+        header_view{"Host", "127.1.1.1"},
+        header_view{"Content-Length", "1024"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, ParseTrickyLongPOSTRequest) {
@@ -237,13 +275,13 @@ once upon a timea............................................................\
     EXPECT_EQ(request_.http_version_minor, 0);
     EXPECT_FALSE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Firefox"},
-        header{"Host", "127.1.1.1"},
-        header{"Content-Length", "1047"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Firefox"},
+        header_view{"Host", "127.1.1.1"},
+        header_view{"Content-Length", "1047"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, ParseGoogleGETRequest) {
@@ -265,17 +303,17 @@ en-US,en;q=0.9\r\n\r\n";
     EXPECT_EQ(request_.http_version_minor, 1);
     EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"Host", "34.83.52.12"},
-        header{"Connection", "keep-alive"},
-        header{"Upgrade-Insecure-Requests", "1"},
-        header{"User-Agent", "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_14_0) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/80.0.3987.149 Safari/537.36"},
-        header{"Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.9"},
-        header{"Accept-Encoding", "gzip, deflate"},
-        header{"Accept-Language", "en-US,en;q=0.9"}
+    std::vector<header_view> request_header {
+        header_view{"Host", "34.83.52.12"},
+        header_view{"Connection", "keep-alive"},
+        header_view{"Upgrade-Insecure-Requests", "1"},
+        header_view{"User-Agent", "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_14_0) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/80.0.3987.149 Safari/537.36"},
+        header_view{"Accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.9"},
+        header_view{"Accept-Encoding", "gzip, deflate"},
+        header_view{"Accept-Language", "en-US,en;q=0.9"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, GETRequestNoNewLine2) {
@@ -345,15 +383,15 @@ User-Agent: Chrome\r\nHost: 127.0.0.1\r\nAccept: */*\r\n\r\n";
     EXPECT_EQ(request_.uri, "/test.html");
     EXPECT_EQ(request_.http_version_major, 13);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Chrome"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Chrome"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, GETHTTPVersionMinorTwoDigits) {
@@ -367,15 +405,15 @@ User-Agent: Chrome\r\nHost: 127.0.0.1\r\nAccept: */*\r\n\r\n";
     EXPECT_EQ(request_.uri, "/test.html");
     EXPECT_EQ(request_.http_version_major, 3);
     EXPECT_EQ(request_.http_version_minor, 12);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Chrome"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Chrome"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, GETHTTPVersionMinorLetterInsteadOfNum) {
@@ -513,15 +551,15 @@ User-Agent: Chrome\r\nHost: 127.0.0.1\r\nAccept: */*\r\n\r\n";
     EXPECT_EQ(request_.uri, "/test.html");
     EXPECT_EQ(request_.http_version_major, 3);
     EXPECT_EQ(request_.http_version_minor, 1);
-    EXPECT_FALSE(request_.keep_alive);
+    EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"User-Agent", "Chrome"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"}
+    std::vector<header_view> request_header {
+        header_view{"User-Agent", "Chrome"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
 }
 
 TEST_F(RequestParserTest, GETBadHeaderLineStartSpecial) {
@@ -578,12 +616,445 @@ Host: 127.0.0.1\r\nAccept: */*\r\n\r\n";
     EXPECT_EQ(request_.http_version_minor, 1);
     EXPECT_TRUE(request_.keep_alive);
 
-    std::vector<header> request_header {
-        header{"Connection", "Keep-Alive"},
-        header{"User-Agent", "Chrome"},
-        header{"Host", "127.0.0.1"},
-        header{"Accept", "*/*"}
+    std::vector<header_view> request_header {
+        header_view{"Connection", "Keep-Alive"},
+        header_view{"User-Agent", "Chrome"},
+        header_view{"Host", "127.0.0.1"},
+        header_view{"Accept", "*/*"}
     };
 
-    EXPECT_EQ(request_.headers, request_header);
+    EXPECT_EQ(request_.view().headers_, request_header);
+}
+
+TEST_F(RequestParserTest, ConnectionDefaults) {
+    struct {
+        const char* data;
+        bool keep_alive;
+    } cases[] = {
+        {"GET / HTTP/1.1\r\nConnection: close\r\n\r\n", false},
+        {"GET / HTTP/1.1\r\nConnection: Upgrade, Close\r\n\r\n", false},
+        {"GET / HTTP/1.0\r\n\r\n", false},
+        {"GET / HTTP/1.0\r\nConnection: keep-alive, TE\r\n\r\n", true},
+        {"GET / HTTP/1.1\r\nConnection: Upgrade\r\n\r\n", true},
+    };
+    for (const auto& c : cases) {
+        request_parser_.reset();
+        request_builder request;
+        std::tie(result, std::ignore) = request_parser_.parse(request, c.data, c.data + strlen(c.data));
+        EXPECT_EQ(result, request_parser::good) << c.data;
+        EXPECT_EQ(request.keep_alive, c.keep_alive) << c.data;
+    }
+}
+
+// HTTP/1.1 clients such as benchmarks and CDNs pipeline without a Connection header,
+// and every request they send is answered.
+TEST_F(RequestParserTest, ParsePipelinedRequestsWithoutConnectionHeader) {
+    char data[] = "GET /echo HTTP/1.1\r\nHost: a\r\n\r\nGET /health HTTP/1.1\r\nHost: a\r\n\r\n";
+    char* begin = data;
+    char* end = data + strlen(data);
+
+    std::tie(result, begin) = request_parser_.parse(request_, begin, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.uri, "/echo");
+    EXPECT_TRUE(request_.keep_alive);
+
+    request_parser_.reset();
+    request_builder second;
+    std::tie(result, begin) = request_parser_.parse(second, begin, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(second.uri, "/health");
+    EXPECT_TRUE(second.keep_alive);
+    EXPECT_EQ(begin, end);
+}
+
+// The contiguous fast path must give the same request whichever byte a read ends on.
+TEST_F(RequestParserTest, SplitAtEveryByte) {
+    std::string data = "POST /upload/a/rather/long/path/to/cross/a/vector/block?x=1 HTTP/1.1\r\n\
+User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_14_0) AppleWebKit/537.36\r\n\
+Connection: keep-alive\r\nContent-Length: 40\r\n\r\n\
+0123456789012345678901234567890123456789";
+    for (std::size_t split = 0; split <= data.size(); ++split) {
+        request_parser parser;
+        request_builder request;
+        const char* begin = data.data();
+        std::tie(result, std::ignore) = parser.parse(request, begin, begin + split);
+        if (split < data.size()) {
+            ASSERT_EQ(result, request_parser::indeterminate) << "split at " << split;
+            std::tie(result, std::ignore) = parser.parse(request, begin + split, begin + data.size());
+        }
+        ASSERT_EQ(result, request_parser::good) << "split at " << split;
+        EXPECT_EQ(request.method, "POST");
+        EXPECT_EQ(request.uri, "/upload/a/rather/long/path/to/cross/a/vector/block?x=1");
+        ASSERT_EQ(request.headers.size(), 3);
+        EXPECT_EQ(request.headers[0].value,
+                  "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_14_0) AppleWebKit/537.36");
+        EXPECT_TRUE(request.keep_alive);
+        EXPECT_EQ(std::string(request.body.begin(), request.body.end()),
+                  "0123456789012345678901234567890123456789");
+        EXPECT_EQ(request.message_size, data.size());
+    }
+}
+
+TEST_F(RequestParserTest, BadByteDeepInsideLongHeaderValue) {
+    char data[] = "GET / HTTP/1.1\r\n\
+X-Long: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\aaaaa\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::bad);
+}
+
+TEST_F(RequestParserTest, BadByteDeepInsideLongHeaderName) {
+    char data[] = "GET / HTTP/1.1\r\n\
+X-A-Very-Long-Header-Name-Over-Thirty-Two(Bytes): 1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::bad);
+}
+
+TEST_F(RequestParserTest, CompleteRequestPointsIntoInput) {
+    char data[] = "POST /echo HTTP/1.1\r\nHost: a\r\nContent-Length: 4\r\n\r\nBODY";
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, data, data + strlen(data));
+    ASSERT_EQ(result, request_parser::good);
+
+    RequestView view = request_.view();
+    EXPECT_EQ(view.method_, Request::POST);
+    EXPECT_EQ(view.method_name_.data(), data);
+    EXPECT_EQ(view.uri_.data(), data + 5);
+    EXPECT_EQ(view.version_, "HTTP/1.1");
+    EXPECT_EQ(view.headers_[0].value.data(), data + 27);
+    EXPECT_EQ(view.body_.data(), data + strlen(data) - 4);
+}
+
+TEST_F(RequestParserTest, PartialRequestSurvivesBufferReuse) {
+    char buffer[64];
+    std::strcpy(buffer, "GET /a/long/pa");
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, buffer, buffer + strlen(buffer));
+    ASSERT_EQ(result, request_parser::indeterminate);
+
+    // The session reads the rest into the same buffer.
+    std::strcpy(buffer, "th HTTP/1.1\r\nX-Split: on\r\n\r\n");
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, buffer, buffer + strlen(buffer));
+    ASSERT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.uri, "/a/long/path");
+    EXPECT_EQ(request_.method, "GET");
+    EXPECT_EQ(request_.view().header("x-split"), "on");
+}
+
+TEST_F(RequestParserTest, ViewLookupAndOwnedCopy) {
+    char data[] = "GET /q HTTP/1.0\r\nAccept: */*\r\nACCEPT: text/html\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, data, data + strlen(data));
+    ASSERT_EQ(result, request_parser::good);
+
+    RequestView view = request_.view();
+    EXPECT_EQ(view.header("accept"), "*/*");
+    EXPECT_TRUE(view.header("Host").empty());
+
+    Request owned = view.to_request();
+    std::memset(data, 'x', strlen(data));
+    EXPECT_EQ(owned.uri_, "/q");
+    EXPECT_EQ(owned.version_, "HTTP/1.0");
+    // Both headers are kept, in order, and lookups ignore case.
+    ASSERT_EQ(owned.headers_.size(), 2);
+    EXPECT_EQ(owned.headers_["ACCEPT"], "*/*");
+    EXPECT_EQ(owned.headers_.begin()[1].value, "text/html");
+
+    RequestView round_trip(owned);
+    EXPECT_EQ(round_trip.method_name_, "GET");
+    EXPECT_EQ(round_trip.uri_, "/q");
+}
+
+TEST_F(RequestParserTest, PauseBeforeBodyThenParseItSeparately) {
+    request_parser_.pause_before_body(true);
+    char data[] = "POST /up HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234";
+    const char* end = data + strlen(data);
+    const char* consumed;
+    std::tie(result, consumed) = request_parser_.parse(request_, data, end);
+    ASSERT_EQ(result, request_parser::head_complete);
+    EXPECT_EQ(std::string(consumed), "01234");
+    EXPECT_TRUE(request_parser_.in_body());
+    EXPECT_EQ(request_.uri, "/up");
+
+    // The head was copied out, the body is left to the caller.
+    std::memset(data, 'x', consumed - data);
+    std::string_view body;
+    std::tie(result, consumed) = request_parser_.parse_body(request_, consumed, end, body);
+    EXPECT_EQ(result, request_parser::indeterminate);
+    EXPECT_EQ(body, "01234");
+    EXPECT_EQ(consumed, end);
+
+    char rest[] = "56789GET / HTTP/1.1\r\n\r\n";
+    std::tie(result, consumed) = request_parser_.parse_body(request_, rest, rest + strlen(rest), body);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(body, "56789");
+    EXPECT_EQ(std::string(consumed), "GET / HTTP/1.1\r\n\r\n");
+    EXPECT_EQ(request_.uri, "/up");
+    EXPECT_TRUE(request_.body.empty());
+    EXPECT_EQ(request_.message_size, strlen(data) + 5);
+}
+
+TEST_F(RequestParserTest, PausedBodyCanStillBeBuffered) {
+    request_parser_.pause_before_body(true);
+    char data[] = "POST /up HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+    const char* consumed;
+    std::tie(result, consumed) = request_parser_.parse(request_, data, data + strlen(data));
+    ASSERT_EQ(result, request_parser::head_complete);
+    std::tie(result, consumed) = request_parser_.parse(request_, consumed, data + strlen(data));
+    ASSERT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.body, "body");
+
+    // Requests without a body never pause.
+    request_parser_.reset();
+    request_ = request_builder();
+    char get[] = "GET / HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, get, get + strlen(get));
+    EXPECT_EQ(result, request_parser::good);
+}
+
+TEST_F(RequestParserTest, ChunkedBodySplitAtEveryByte) {
+    std::string data = "POST /upload HTTP/1.1\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n\
+5;name=value\r\nhello\r\n\
+1A\r\n, world of chunked bodies!\r\n\
+0\r\nX-Checksum: abc\r\nX-Other: def\r\n\r\n";
+    for (std::size_t split = 0; split <= data.size(); ++split) {
+        request_parser parser;
+        request_builder request;
+        const char* begin = data.data();
+        const char* consumed;
+        std::tie(result, consumed) = parser.parse(request, begin, begin + split);
+        if (split < data.size()) {
+            ASSERT_EQ(result, request_parser::indeterminate) << "split at " << split;
+            std::tie(result, consumed) = parser.parse(request, begin + split, begin + data.size());
+        }
+        ASSERT_EQ(result, request_parser::good) << "split at " << split;
+        EXPECT_EQ(consumed, begin + data.size());
+        EXPECT_EQ(std::string(request.body.begin(), request.body.end()),
+                  "hello, world of chunked bodies!");
+        // Trailers are dropped.
+        EXPECT_EQ(request.headers.size(), 1);
+        EXPECT_EQ(request.message_size, data.size());
+    }
+}
+
+TEST_F(RequestParserTest, ChunkedBodyParsedSeparately) {
+    request_parser_.pause_before_body(true);
+    char data[] = "POST /up HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n\
+3\r\nabc\r\n4 ; ext\r\ndefg\r\n0\r\n\r\nGET";
+    const char* end = data + strlen(data);
+    const char* consumed;
+    std::tie(result, consumed) = request_parser_.parse(request_, data, end);
+    ASSERT_EQ(result, request_parser::head_complete);
+
+    std::string body;
+    std::string_view piece;
+    do {
+        std::tie(result, consumed) = request_parser_.parse_body(request_, consumed, end, piece);
+        body.append(piece.data(), piece.size());
+    } while (result == request_parser::indeterminate && consumed != end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(body, "abcdefg");
+    EXPECT_EQ(std::string(consumed), "GET");
+    EXPECT_TRUE(request_.body.empty());
+}
+
+TEST_F(RequestParserTest, BadChunkedBodies) {
+    const char* bodies[] = {
+        "Transfer-Encoding: gzip\r\n\r\n",
+        "Transfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\n3\r\nabc\r\n0\r\n\r\n",
+        "Transfer-Encoding: chunked\r\n\r\nxyz\r\n",
+        "Transfer-Encoding: chunked\r\n\r\n3\r\nabcd\r\n",
+        "Transfer-Encoding: chunked\r\n\r\n3\r\nabc\n0\r\n\r\n",
+        "Transfer-Encoding: chunked\r\n\r\n3;a\x01b\r\nabc\r\n",
+        "Transfer-Encoding: chunked\r\n\r\n11111111111111111\r\n",
+        "Transfer-Encoding: chunked\r\n\r\n0\r\n folded\r\n\r\n",
+    };
+    for (const char* body : bodies) {
+        request_parser parser;
+        request_builder request;
+        std::string data = std::string("POST / HTTP/1.1\r\n") + body;
+        std::tie(result, std::ignore) = parser.parse(request, data.data(), data.data() + data.size());
+        EXPECT_EQ(result, request_parser::bad) << body;
+    }
+}
+
+TEST_F(RequestParserTest, HeadLimits) {
+    request_parser::limits limits;
+    limits.max_uri_size = 16;
+    limits.max_header_size = 64;
+    limits.max_header_count = 2;
+    const char* requests[] = {
+        "GET /a/uri/longer/than/sixteen HTTP/1.1\r\n\r\n",
+        "GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n",
+        "GET / HTTP/1.1\r\nUser-Agent: a value that takes the head past its limit\r\n\r\n",
+    };
+    request_parser::result_type expected[] = {
+        request_parser::uri_too_long, request_parser::header_too_large, request_parser::header_too_large,
+    };
+    for (int i = 0; i < 3; ++i) {
+        // Fed a byte at a time, the limit is still found before the head is complete.
+        request_parser parser;
+        request_builder request;
+        parser.set_limits(limits);
+        const char* begin = requests[i];
+        const char* end = begin + strlen(begin);
+        result = request_parser::indeterminate;
+        while (result == request_parser::indeterminate && begin != end) {
+            std::tie(result, begin) = parser.parse(request, begin, begin + 1);
+        }
+        EXPECT_EQ(result, expected[i]) << requests[i];
+        EXPECT_NE(begin, end) << requests[i];
+    }
+
+    char data[] = "GET /sixteen/bytes/xy HTTP/1.1\r\nA: 1\r\nB: 2\r\n\r\n";
+    request_parser_.set_limits(limits);
+    std::tie(result, std::ignore) = request_parser_.parse(request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::uri_too_long);
+    request_parser_.reset();
+    request_ = request_builder();
+    char fits[] = "GET /sixteen/bytes/x HTTP/1.1\r\nA: 1\r\nB: 2\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, fits, fits + strlen(fits));
+    EXPECT_EQ(result, request_parser::good);
+}
+
+TEST_F(RequestParserTest, BodyLimit) {
+    request_parser::limits limits;
+    limits.max_body_size = 4;
+    request_parser_.set_limits(limits);
+    char data[] = "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    const char* consumed;
+    std::tie(result, consumed) = request_parser_.parse(request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::body_too_large);
+    EXPECT_EQ(std::string(consumed), "hello");
+
+    // Chunks are refused once their sizes add up to more than the limit.
+    request_parser parser;
+    request_builder request;
+    parser.set_limits(limits);
+    char chunked[] = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n";
+    std::tie(result, consumed) = parser.parse(request, chunked, chunked + strlen(chunked));
+    EXPECT_EQ(result, request_parser::body_too_large);
+    EXPECT_EQ(std::string(consumed), "de\r\n0\r\n\r\n");
+
+    // Lengths too big for any limit are refused too.
+    request_parser unlimited;
+    request_builder huge;
+    char too_big[] = "POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n";
+    std::tie(result, std::ignore) = unlimited.parse(huge, too_big, too_big + strlen(too_big));
+    EXPECT_EQ(result, request_parser::body_too_large);
+}
+
+TEST_F(RequestParserTest, LocationBodyLimitAfterHead) {
+    request_parser::limits limits;
+    limits.max_body_size = 4;
+    request_parser_.set_limits(limits);
+    request_parser_.pause_before_body(true);
+    char data[] = "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    const char* end = data + strlen(data);
+    const char* consumed;
+    std::tie(result, consumed) = request_parser_.parse(request_, data, end);
+    ASSERT_EQ(result, request_parser::head_complete);
+    // A location may allow more than the server's limit, or less.
+    EXPECT_FALSE(request_parser_.limit_body(3));
+    EXPECT_TRUE(request_parser_.limit_body(5));
+    std::tie(result, consumed) = request_parser_.parse(request_, consumed, end);
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.body, "hello");
+
+    // The next request is back to the server's limit.
+    request_parser_.reset();
+    request_ = request_builder();
+    std::tie(result, consumed) = request_parser_.parse(request_, data, end);
+    ASSERT_EQ(result, request_parser::head_complete);
+    std::string_view piece;
+    std::tie(result, consumed) = request_parser_.parse_body(request_, consumed, end, piece);
+    EXPECT_EQ(result, request_parser::body_too_large);
+    EXPECT_TRUE(piece.empty());
+}
+
+TEST_F(RequestParserTest, PathAndQuery) {
+    char data[] = "GET /static/index.html?lang=en&q=two+words HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.uri, "/static/index.html?lang=en&q=two+words");
+    EXPECT_EQ(request_.path, "/static/index.html");
+    EXPECT_EQ(request_.query, "lang=en&q=two+words");
+    // A clean path is a view of the URI's bytes, not a copy.
+    EXPECT_EQ(request_.path.begin(), request_.uri.begin());
+
+    RequestView view = request_.view();
+    std::string value;
+    EXPECT_TRUE(view.query_.get("q", value));
+    EXPECT_EQ(value, "two words");
+    EXPECT_TRUE(view.query_.get("lang", value));
+    EXPECT_EQ(value, "en");
+    EXPECT_FALSE(view.query_.has("missing"));
+}
+
+TEST_F(RequestParserTest, DecodesAndNormalizesPath) {
+    char data[] = "GET /static/./docs/../my%20file%2Etxt?x=1 HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.path, "/static/my file.txt");
+    EXPECT_EQ(request_.query, "x=1");
+    EXPECT_EQ(request_.view().path_, "/static/my file.txt");
+}
+
+TEST_F(RequestParserTest, DotSegmentsStayBelowRoot) {
+    char data[] = "GET /static/%2e%2e/%2E%2E/../etc/passwd HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, data, data + strlen(data));
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.path, "/etc/passwd");
+
+    request_ = request_builder();
+    request_parser_.reset();
+    char directory[] = "GET /a/b/.. HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(request_, directory, directory + strlen(directory));
+    EXPECT_EQ(result, request_parser::good);
+    EXPECT_EQ(request_.path, "/a/");
+}
+
+TEST_F(RequestParserTest, BadPercentEscape) {
+    const char* requests[] = {
+        "GET /a%zzb HTTP/1.1\r\n\r\n",
+        "GET /a%4 HTTP/1.1\r\n\r\n",
+        "GET /a%00b HTTP/1.1\r\n\r\n",
+    };
+    for (const char* data : requests) {
+        request_ = request_builder();
+        request_parser_.reset();
+        std::tie(result, std::ignore) = request_parser_.parse(request_, data, data + strlen(data));
+        EXPECT_EQ(result, request_parser::bad) << data;
+    }
+}
+
+TEST_F(RequestParserTest, PathOfUriSplitAcrossReads) {
+    std::string first = "GET /static/fi";
+    std::string second = "le.txt?a=b HTTP/1.1\r\n\r\n";
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, first.data(), first.data() + first.size());
+    EXPECT_EQ(result, request_parser::indeterminate);
+    request_.detach();
+    first.assign(first.size(), 'x');
+    std::tie(result, std::ignore) = request_parser_.parse(
+              request_, second.data(), second.data() + second.size());
+    EXPECT_EQ(result, request_parser::good);
+    request_.detach();
+    second.assign(second.size(), 'x');
+    EXPECT_EQ(request_.path, "/static/file.txt");
+    EXPECT_EQ(request_.query, "a=b");
+}
+
+TEST_F(RequestParserTest, ViewOfRequestDecodesPath) {
+    Request request;
+    request.method_ = Request::GET;
+    request.uri_ = "/static/a%20b/./c.txt?k%20ey=v%2Bw";
+    RequestView view(request);
+    RequestView copy = view;
+    EXPECT_EQ(copy.path_, "/static/a b/c.txt");
+    std::string value;
+    EXPECT_TRUE(copy.query_.get("k ey", value));
+    EXPECT_EQ(value, "v+w");
 }
@@ -0,0 +1,184 @@
+#include <memory>
+#include <string>
+
+#include "compression_test_util.h"
+#include "gtest/gtest.h"
+#include "request_dispatcher.h"
+#include "request_view.h"
+#include "response_compressor.h"
+
+class ResponseCompressorTest : public ::testing::Test {
+ protected:
+        ResponseCompressorTest() {
+            config_.compression.enabled = true;
+            config_.compression.types.push_back("text/css");
+        }
+
+        // Compress a response to a request with the given Accept-Encoding, or none.
+        void compress(Response& response, const char* accept_encoding) {
+            Request request;
+            request.method_ = Request::GET;
+            request.uri_ = "/page";
+            if (accept_encoding != nullptr) {
+                request.headers_["Accept-Encoding"] = accept_encoding;
+            }
+            request_dispatcher dispatcher(config_);
+            response_compressor compressor(config_, dispatcher);
+            compressor.compress(RequestView(request), nullptr, response);
+        }
+
+        static Response html_response(std::size_t size) {
+            Response response;
+            response.code_ = Response::ok;
+            response.headers_[header_id::content_type] = "text/html; charset=utf-8";
+            response.body_ = compression_test::html_page(size);
+            response.headers_[header_id::content_length] = std::to_string(size);
+            return response;
+        }
+
+        NginxConfig config_;
+};
+
+namespace {
+
+class known_size_producer : public body_producer {
+ public:
+    explicit known_size_producer(std::string body) : body_(body), offset_(0) {}
+    long long size() const { return body_.size(); }
+    bool read(char* buffer, std::size_t capacity, std::size_t& size) {
+        size = std::min(capacity, body_.size() - offset_);
+        body_.copy(buffer, size, offset_);
+        offset_ += size;
+        return true;
+    }
+
+ private:
+    std::string body_;
+    std::size_t offset_;
+};
+
+}  // namespace
+
+using compression_test::inflate_body;
+using compression_test::read_all;
+
+TEST_F(ResponseCompressorTest, Negotiate) {
+    EXPECT_EQ(response_compressor::negotiate(""), response_compressor::identity);
+    EXPECT_EQ(response_compressor::negotiate("gzip"), response_compressor::gzip);
+    EXPECT_EQ(response_compressor::negotiate("deflate, gzip"), response_compressor::gzip);
+    EXPECT_EQ(response_compressor::negotiate("GZIP;q=0.5, deflate"), response_compressor::deflate);
+    EXPECT_EQ(response_compressor::negotiate("gzip;q=0, deflate;q=0.001"), response_compressor::deflate);
+    EXPECT_EQ(response_compressor::negotiate("gzip; q=0.000"), response_compressor::identity);
+    EXPECT_EQ(response_compressor::negotiate("*"), response_compressor::gzip);
+    EXPECT_EQ(response_compressor::negotiate("*;q=0, identity"), response_compressor::identity);
+    EXPECT_EQ(response_compressor::negotiate("br, x-gzip"), response_compressor::gzip);
+    EXPECT_EQ(response_compressor::negotiate("gzip;q=2"), response_compressor::identity);
+}
+
+TEST_F(ResponseCompressorTest, LevelForLoad) {
+    EXPECT_EQ(response_compressor::level_for_load(6, 0), 6);
+    EXPECT_EQ(response_compressor::level_for_load(6, response_compressor::backoff_busy_percent - 1), 6);
+    EXPECT_EQ(response_compressor::level_for_load(6, response_compressor::backoff_busy_percent), 1);
+    EXPECT_EQ(response_compressor::level_for_load(6, response_compressor::off_busy_percent), 0);
+    EXPECT_EQ(response_compressor::level_for_load(6, 100), 0);
+}
+
+TEST_F(ResponseCompressorTest, CompressesSmallBodyWhole) {
+    Response response = html_response(5000);
+    std::string original = response.body_;
+    compress(response, "gzip, deflate");
+
+    EXPECT_EQ(response.headers_.get(header_id::content_encoding), "gzip");
+    EXPECT_EQ(response.headers_.get(header_id::vary), "Accept-Encoding");
+    EXPECT_LT(response.body_.size(), original.size());
+    EXPECT_EQ(response.headers_.get(header_id::content_length), std::to_string(response.body_.size()));
+    EXPECT_EQ(inflate_body(response.body_, 15 + 16), original);
+
+    response = html_response(5000);
+    compress(response, "deflate");
+    EXPECT_EQ(response.headers_.get(header_id::content_encoding), "deflate");
+    EXPECT_EQ(inflate_body(response.body_, 15), original);
+}
+
+TEST_F(ResponseCompressorTest, StreamsLargeBody) {
+    Response response = html_response(response_compressor::buffered_limit + 100000);
+    std::string original = response.body_;
+    compress(response, "gzip");
+
+    ASSERT_TRUE(response.body_producer_ != nullptr);
+    EXPECT_TRUE(response.body_.empty());
+    EXPECT_EQ(response.body_producer_->size(), -1);
+    EXPECT_EQ(response.headers_.find(header_id::content_length), response.headers_.end());
+    EXPECT_EQ(inflate_body(read_all(*response.body_producer_), 15 + 16), original);
+}
+
+TEST_F(ResponseCompressorTest, CompressesProducedBody) {
+    Response response = html_response(0);
+    std::string original = html_response(300000).body_;
+    response.body_producer_ = std::make_shared<known_size_producer>(original);
+    compress(response, "gzip");
+
+    ASSERT_TRUE(response.body_producer_ != nullptr);
+    EXPECT_EQ(response.body_producer_->size(), -1);
+    EXPECT_EQ(response.headers_.get(header_id::content_encoding), "gzip");
+    EXPECT_EQ(inflate_body(read_all(*response.body_producer_), 15 + 16), original);
+}
+
+TEST_F(ResponseCompressorTest, CompressesSharedBody) {
+    Response response = html_response(5000);
+    auto shared = std::make_shared<const std::string>(html_response(300000).body_);
+    response.body_.clear();
+    response.shared_body_ = shared;
+    Response small = html_response(5000);
+    small.shared_body_ = std::make_shared<const std::string>(std::move(small.body_));
+    compress(response, "gzip");
+    compress(small, "gzip");
+
+    // The shared bodies are read, never changed
+    ASSERT_TRUE(response.body_producer_ != nullptr);
+    EXPECT_EQ(response.shared_body_, nullptr);
+    EXPECT_EQ(inflate_body(read_all(*response.body_producer_), 15 + 16), *shared);
+    EXPECT_EQ(small.shared_body_, nullptr);
+    EXPECT_EQ(inflate_body(small.body_, 15 + 16), html_response(5000).body_);
+}
+
+TEST_F(ResponseCompressorTest, LeavesOtherResponsesAlone) {
+    // Shorter than gzip_min_length
+    Response response = html_response(100);
+    std::string original = response.body_;
+    compress(response, "gzip");
+    EXPECT_EQ(response.body_, original);
+    EXPECT_TRUE(response.headers_.get(header_id::vary).empty());
+
+    // Not a listed type
+    response = html_response(5000);
+    response.headers_[header_id::content_type] = "image/png";
+    original = response.body_;
+    compress(response, "gzip");
+    EXPECT_EQ(response.body_, original);
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+
+    // Already encoded
+    response = html_response(5000);
+    response.headers_[header_id::content_encoding] = "br";
+    compress(response, "gzip");
+    EXPECT_EQ(response.headers_.get(header_id::content_encoding), "br");
+
+    // Turned off
+    config_.compression.enabled = false;
+    response = html_response(5000);
+    compress(response, "gzip");
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+}
+
+TEST_F(ResponseCompressorTest, IdentityClientStillGetsVary) {
+    Response response = html_response(5000);
+    response.headers_[header_id::content_type] = "text/css";
+    response.headers_[header_id::vary] = "Cookie";
+    std::string original = response.body_;
+    compress(response, nullptr);
+
+    EXPECT_EQ(response.body_, original);
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+    EXPECT_EQ(response.headers_.get(header_id::vary), "Cookie, Accept-Encoding");
+}
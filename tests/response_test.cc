@@ -1,6 +1,10 @@
+#include <cstring>
+#include <memory>
+
 #include "gtest/gtest.h"
 
 #include "header.h"
+#include "header_cache.h"
 #include "request.h"
 #include "request_parser.h"
 #include "request_handler.h"
@@ -17,6 +21,18 @@ class ResponseTest : public ::testing::Test {
         boost::asio::const_buffer const_buffer_;
         // Size of status string buffer.
         std::size_t const_buffer_size_;
+        // A serialized head with its Date lines (which change every second) taken out,
+        // after checking each is where header_cache puts it.
+        static std::string without_date(std::string head) {
+            std::size_t date;
+            while ((date = head.find("\r\nDate: ")) != std::string::npos) {
+                std::size_t end = head.find("\r\n", date + 2);
+                EXPECT_EQ(end - date - 2, 6 + header_cache::date_size);
+                head.erase(date + 2, end - date);
+            }
+            return head;
+        }
+
         // Pointer which reads values from status string buffer.
         unsigned const char* read_buff_ptr_;
 };
@@ -26,7 +42,7 @@ TEST_F(ResponseTest, ToBufferOKReply) {
 	const_buffer_ = ResponseHelperLibrary::to_buffer(Response::ok);
 	const_buffer_size_ = boost::asio::buffer_size(const_buffer_);
 	std::string check_status_string_(boost::asio::buffer_cast<const char*>(const_buffer_));
-	EXPECT_EQ(check_status_string_, "HTTP/1.0 200 OK\r\n");
+	EXPECT_EQ(check_status_string_, "HTTP/1.1 200 OK\r\n");
 }
 
 TEST_F(ResponseTest, ToBufferBADReply) {
@@ -34,7 +50,7 @@ TEST_F(ResponseTest, ToBufferBADReply) {
 	const_buffer_ = ResponseHelperLibrary::to_buffer(Response::bad_request);
 	const_buffer_size_ = boost::asio::buffer_size(const_buffer_);
 	std::string check_status_string_(boost::asio::buffer_cast<const char*>(const_buffer_));
-	EXPECT_EQ(check_status_string_, "HTTP/1.0 400 Bad Request\r\n");
+	EXPECT_EQ(check_status_string_, "HTTP/1.1 400 Bad Request\r\n");
 }
 
 TEST_F(ResponseTest, ToBufferOtherReply) {
@@ -42,30 +58,132 @@ TEST_F(ResponseTest, ToBufferOtherReply) {
 	const_buffer_ = ResponseHelperLibrary::to_buffer(Response::not_implemented);
 	const_buffer_size_ = boost::asio::buffer_size(const_buffer_);
 	std::string check_status_string_(boost::asio::buffer_cast<const char*>(const_buffer_));
-	EXPECT_EQ(check_status_string_, "HTTP/1.0 400 Bad Request\r\n");
+	EXPECT_EQ(check_status_string_, "HTTP/1.1 501 Not Implemented\r\n");
+	EXPECT_EQ(const_buffer_size_, check_status_string_.size());
 }
 
 TEST_F(ResponseTest, ReplyToBuffersTest) {
 
 	response_.code_ = Response::StatusCode::ok;
-	response_.headers_["Content-Length"] = "0";
+	response_.headers_["Content-Length"] = "5";
 	response_.headers_["Host"] = "127.1.1.1";
 	response_.headers_["User-Agent"] = "Firefox";
-	// Ordered by Key
-	std::vector<boost::asio::const_buffer> buffers = ResponseHelperLibrary::to_buffers(response_);
-	std::string contentlength(boost::asio::buffer_cast<const char*>(buffers[1]));
-	std::string contentlengthval(boost::asio::buffer_cast<const char*>(buffers[3]));
-	std::string host(boost::asio::buffer_cast<const char*>(buffers[5]));
-	std::string hostval(boost::asio::buffer_cast<const char*>(buffers[7]));
-	std::string useragent(boost::asio::buffer_cast<const char*>(buffers[9]));
-	std::string useragentval(boost::asio::buffer_cast<const char*>(buffers[11]));
-
-	EXPECT_EQ(contentlength, "Content-Length");
-	EXPECT_EQ(contentlengthval, "0");
-	EXPECT_EQ(host, "Host");
-	EXPECT_EQ(hostval, "127.1.1.1");
-	EXPECT_EQ(useragent, "User-Agent");
-	EXPECT_EQ(useragentval, "Firefox");
+	response_.body_ = "hello";
+	std::vector<Response> responses(1, response_);
+	pooled_buffer heads;
+	std::vector<boost::asio::const_buffer> buffers;
+	ResponseHelperLibrary::to_buffers(responses, heads, buffers);
+
+	// The head in one buffer, headers in the order they were set, then the body
+	ASSERT_EQ(buffers.size(), 2);
+	std::string head(static_cast<const char*>(buffers[0].data()), buffers[0].size());
+	EXPECT_EQ(without_date(head), "HTTP/1.1 200 OK\r\nServer: mrjk-web-server\r\n"
+	                "Content-Length: 5\r\nHost: 127.1.1.1\r\nUser-Agent: Firefox\r\n\r\n");
+	EXPECT_EQ(head.size(), ResponseHelperLibrary::head_size(response_));
+	EXPECT_EQ(buffers[1].data(), responses[0].body_.data());
+	EXPECT_EQ(buffers[1].size(), 5);
+}
+
+TEST_F(ResponseTest, ToBuffersVersionAndStatusLines) {
+	std::vector<Response> responses(3);
+	responses[0].code_ = Response::bad_gateway;
+	responses[0].http_version_minor_ = 0;
+	responses[1].code_ = static_cast<Response::StatusCode>(418);
+	responses[2].code_ = Response::not_modified;
+	responses[2].body_ = "x";
+	responses[2].close_connection_ = true;
+	pooled_buffer heads;
+	std::vector<boost::asio::const_buffer> buffers;
+	ResponseHelperLibrary::to_buffers(responses, heads, buffers);
+
+	// Heads without a body between them go out as one buffer
+	ASSERT_EQ(buffers.size(), 2);
+	std::string head(static_cast<const char*>(buffers[0].data()), buffers[0].size());
+	std::string server = "Server: mrjk-web-server\r\n";
+	EXPECT_EQ(without_date(head), "HTTP/1.0 502 Bad Gateway\r\n" + server + "Connection: keep-alive\r\n\r\n"
+	                "HTTP/1.1 418 \r\n" + server + "\r\n"
+	                "HTTP/1.1 304 Not Modified\r\n" + server + "Connection: close\r\n\r\n");
+}
+
+TEST_F(ResponseTest, ToBuffersKeepsOwnServerAndDate) {
+	std::vector<Response> responses(1);
+	responses[0].code_ = Response::ok;
+	responses[0].headers_["Date"] = "Tue, 15 Nov 1994 08:12:31 GMT";
+	responses[0].headers_["Connection"] = "close";
+	pooled_buffer heads;
+	std::vector<boost::asio::const_buffer> buffers;
+	ResponseHelperLibrary::to_buffers(responses, heads, buffers);
+
+	ASSERT_EQ(buffers.size(), 1);
+	std::string head(static_cast<const char*>(buffers[0].data()), buffers[0].size());
+	EXPECT_EQ(head, "HTTP/1.1 200 OK\r\nServer: mrjk-web-server\r\n"
+	                "Date: Tue, 15 Nov 1994 08:12:31 GMT\r\nConnection: close\r\n\r\n");
+}
+
+namespace {
+
+class empty_producer : public body_producer {
+ public:
+	bool read(char* buffer, std::size_t capacity, std::size_t& size) {
+		size = 0;
+		return true;
+	}
+};
+
+}  // namespace
+
+TEST_F(ResponseTest, ToBuffersCountAndProducedBody) {
+	std::vector<Response> responses(2);
+	responses[0].code_ = Response::ok;
+	responses[0].body_ = "not sent";
+	responses[0].body_producer_ = std::make_shared<empty_producer>();
+	responses[1].code_ = Response::ok;
+	responses[1].body_ = "later";
+	pooled_buffer heads;
+	std::vector<boost::asio::const_buffer> buffers;
+	ResponseHelperLibrary::to_buffers(responses.data(), 1, heads, buffers);
+
+	// Only the head of the first response, whose body the session writes
+	ASSERT_EQ(buffers.size(), 1);
+	std::string head(static_cast<const char*>(buffers[0].data()), buffers[0].size());
+	EXPECT_EQ(without_date(head), "HTTP/1.1 200 OK\r\nServer: mrjk-web-server\r\n\r\n");
+}
+
+TEST_F(ResponseTest, ToBuffersSharedBody) {
+	std::vector<Response> responses(2);
+	responses[0] = ResponseHelperLibrary::stock_response(Response::not_found);
+	responses[1] = responses[0];
+	// Every stock 404, on any thread, points at the same page
+	EXPECT_EQ(responses[0].shared_body_, ResponseHelperLibrary::stock_body(Response::not_found));
+	EXPECT_EQ(responses[0].body(), stock_responses::not_found);
+	pooled_buffer heads;
+	std::vector<boost::asio::const_buffer> buffers;
+	ResponseHelperLibrary::to_buffers(responses, heads, buffers);
+
+	// Both bodies are written from the shared page itself
+	ASSERT_EQ(buffers.size(), 4);
+	EXPECT_EQ(buffers[1].data(), responses[0].shared_body_->data());
+	EXPECT_EQ(buffers[3].data(), responses[0].shared_body_->data());
+	EXPECT_EQ(buffers[3].size(), responses[0].shared_body_->size());
+}
+
+TEST_F(ResponseTest, FrameChunk) {
+	const std::size_t room = ResponseHelperLibrary::chunk_head_room;
+	char block[room + 300 + ResponseHelperLibrary::chunk_tail_room];
+	char* data = block + room;
+	std::memset(data, 'a', 300);
+
+	boost::asio::const_buffer chunk = ResponseHelperLibrary::frame_chunk(data, 300);
+	std::string framed(static_cast<const char*>(chunk.data()), chunk.size());
+	EXPECT_EQ(framed, "12c\r\n" + std::string(300, 'a') + "\r\n");
+
+	chunk = ResponseHelperLibrary::frame_chunk(data, 1);
+	framed.assign(static_cast<const char*>(chunk.data()), chunk.size());
+	EXPECT_EQ(framed, "1\r\na\r\n");
+
+	chunk = ResponseHelperLibrary::last_chunk();
+	framed.assign(static_cast<const char*>(chunk.data()), chunk.size());
+	EXPECT_EQ(framed, "0\r\n\r\n");
 }
 
 TEST_F(ResponseTest, StockRepliesToStringOtherRequest) {
@@ -77,5 +195,5 @@ TEST_F(ResponseTest, StockRepliesToStringOtherRequest) {
     "<head><title>Bad Request</title></head>"
     "<body><h1>400 Bad Request</h1></body>"
     "</html>";
-    EXPECT_EQ(response_.body_, std::string(bad_request));
+    EXPECT_EQ(response_.body(), std::string(bad_request));
 }
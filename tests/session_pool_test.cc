@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+#include "session.h"
+#include "session_pool.h"
+
+class SessionPoolTest : public ::testing::Test {
+ protected:
+        SessionPoolTest() : wheel_(io_service_), pool_(io_service_, nullptr, nullptr, nullptr, &wheel_, &config_, nullptr, 2) {}
+
+        boost::asio::io_service io_service_;
+        NginxConfig config_;
+        timing_wheel wheel_;
+        session_pool pool_;
+};
+
+TEST_F(SessionPoolTest, ReleasedSessionIsReused) {
+    session* first = pool_.acquire();
+    EXPECT_EQ(pool_.live_count(), 1);
+    pool_.release(first);
+    EXPECT_EQ(pool_.live_count(), 0);
+    EXPECT_EQ(pool_.free_count(), 1);
+
+    session* second = pool_.acquire();
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(pool_.free_count(), 0);
+    pool_.release(second);
+}
+
+TEST_F(SessionPoolTest, FreeListIsBounded) {
+    session* sessions[3];
+    for (int i = 0; i < 3; i++) {
+        sessions[i] = pool_.acquire();
+    }
+    EXPECT_EQ(pool_.live_count(), 3);
+    for (int i = 0; i < 3; i++) {
+        pool_.release(sessions[i]);
+    }
+    EXPECT_EQ(pool_.live_count(), 0);
+    EXPECT_EQ(pool_.free_count(), 2);
+}
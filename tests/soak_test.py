@@ -0,0 +1,106 @@
+""" soak_test.py
+Checks that the webserver's memory stays flat over many connections.
+
+Every connection sends one non keep-alive request, reads the response until the
+server closes, and closes. Sessions are recycled through the session pool, so
+after a warm-up the resident set size must stop growing: a session (or buffer)
+leaked per connection shows up as steady growth.
+
+How to run: In the build directory: python3 ../tests/soak_test.py [connections]
+    The default is small enough for ctest; pass e.g. 2000000 for a real soak.
+
+Author(s):
+    Kubilay Agi
+    Michael Gee
+    Jane Lee
+    Roy Lin
+
+Date Created:
+    October 17th, 2026
+"""
+from subprocess import Popen
+from subprocess import DEVNULL
+import os
+import shutil
+import socket
+import sys
+import tempfile
+import threading
+import time
+
+NUM_CONNECTIONS = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+NUM_CLIENTS = 8
+WARMUP_CONNECTIONS = NUM_CONNECTIONS // 10
+# Allowed RSS growth after the warm-up, in kB. Leaking even one small session
+# per connection would blow well past this during the default run.
+MAX_GROWTH_KB = 2048
+EXECUTABLE_PATH = os.path.abspath("./bin/webserver")
+IP_ADDRESS = "localhost"
+PORT = 8080
+REQUEST = b'GET /echo HTTP/1.0\r\n\r\n'
+
+def rss_kb(pid):
+    with open("/proc/%d/status" % pid) as status:
+        for line in status:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1])
+    return 0
+
+def one_connection():
+    s = socket.create_connection((IP_ADDRESS, PORT))
+    s.settimeout(5)
+    s.sendall(REQUEST)
+    received = b''
+    while True:
+        data = s.recv(4096)
+        if not data:
+            break
+        received += data
+    s.close()
+    return received.startswith(b'HTTP/1.0 200 OK')
+
+def run_connections(count):
+    failures = []
+    def client(n):
+        for _ in range(n):
+            if not one_connection():
+                failures.append(1)
+    threads = [threading.Thread(target=client, args=(count // NUM_CLIENTS,))
+               for _ in range(NUM_CLIENTS)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return len(failures)
+
+# The server logs every request, so run it in a scratch directory.
+work_dir = tempfile.mkdtemp()
+config_path = os.path.join(work_dir, "config")
+with open(config_path, "w") as f:
+    f.write("port 8080;\nlocation \"/echo\" EchoHandler {\n}\n")
+
+webserver = Popen([EXECUTABLE_PATH, config_path], cwd=work_dir, stdout=DEVNULL)
+time.sleep(1)
+
+exit_code = 0
+try:
+    failures = run_connections(WARMUP_CONNECTIONS)
+    baseline_kb = rss_kb(webserver.pid)
+    failures += run_connections(NUM_CONNECTIONS - WARMUP_CONNECTIONS)
+    final_kb = rss_kb(webserver.pid)
+
+    sys.stdout.write("RSS after warm-up: %d kB, after %d connections: %d kB\n"
+                     % (baseline_kb, NUM_CONNECTIONS, final_kb))
+    if failures:
+        sys.stdout.write("%d requests did not get a 200 response\n" % failures)
+        exit_code = 1
+    if final_kb - baseline_kb > MAX_GROWTH_KB:
+        sys.stdout.write("Memory grew by %d kB\n" % (final_kb - baseline_kb))
+        exit_code = 1
+finally:
+    webserver.terminate()
+    webserver.wait()
+    shutil.rmtree(work_dir)
+
+sys.stdout.write("SOAK TEST " + ("SUCCEEDED" if exit_code == 0 else "FAILED") + "\n")
+sys.exit(exit_code)
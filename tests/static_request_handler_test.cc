@@ -0,0 +1,184 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "compression_test_util.h"
+#include "gtest/gtest.h"
+#include "request_view.h"
+#include "static_request_handler.h"
+
+class StaticRequestHandlerTest : public ::testing::Test {
+ protected:
+        StaticRequestHandlerTest() {
+            char root[] = "/tmp/static_request_handler_test.XXXXXX";
+            root_ = ::mkdtemp(root);
+            page_ = compression_test::html_page(20000);
+            write_file("page.html", page_);
+            write_file("image.png", page_);
+            config_.static_locations_["/static"] = root_;
+            config_.compression.static_variants = true;
+        }
+
+        ~StaticRequestHandlerTest() {
+            // remove() takes the directory standing in for a variant as well
+            for (const char* name : {"page.html", "page.html.gz", "image.png", "image.png.gz"}) {
+                std::remove((root_ + "/" + name).c_str());
+            }
+            ::rmdir(root_.c_str());
+        }
+
+        void write_file(const std::string& name, const std::string& contents) {
+            std::ofstream file(root_ + "/" + name, std::ios::binary | std::ios::trunc);
+            file << contents;
+        }
+
+        // Serve uri to a request with the given Accept-Encoding, or none.
+        Response serve(const std::string& uri, const char* accept_encoding) {
+            Request request;
+            request.method_ = Request::GET;
+            request.uri_ = uri;
+            if (accept_encoding != nullptr) {
+                request.headers_["Accept-Encoding"] = accept_encoding;
+            }
+            std::unique_ptr<static_request_handler> handler(static_request_handler::Init("/static", config_));
+            return handler->handle_request(RequestView(request));
+        }
+
+        // Serve uri to a gzip client once its variant has been built in the background,
+        // or whatever it gets after a few seconds.
+        Response serve_variant(const std::string& uri) {
+            Response response;
+            for (int i = 0; i < 500; ++i) {
+                response = serve(uri, "gzip");
+                if (!response.headers_.get(header_id::content_encoding).empty()) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return response;
+        }
+
+        // Modification time of the root, which a build attempt changes by making its
+        // temporary file there.
+        struct timespec root_mtime() {
+            struct stat root;
+            EXPECT_EQ(::stat(root_.c_str(), &root), 0);
+            return root.st_mtim;
+        }
+
+        static bool same_time(const struct timespec& a, const struct timespec& b) {
+            return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+        }
+
+        std::string root_;
+        std::string page_;
+        NginxConfig config_;
+};
+
+using compression_test::gunzip;
+using compression_test::read_all;
+
+TEST_F(StaticRequestHandlerTest, ServesGzipVariant) {
+    // The variant is built off the request's thread, which sends the file meanwhile
+    Response response = serve("/static/page.html", "gzip, deflate");
+    EXPECT_EQ(response.code_, Response::ok);
+    EXPECT_EQ(response.headers_.get(header_id::vary), "Accept-Encoding");
+    if (response.headers_.get(header_id::content_encoding).empty()) {
+        EXPECT_EQ(read_all(*response.body_producer_), page_);
+    }
+
+    response = serve_variant("/static/page.html");
+    EXPECT_EQ(response.code_, Response::ok);
+    EXPECT_EQ(response.headers_.get(header_id::content_encoding), "gzip");
+    EXPECT_EQ(response.headers_.get(header_id::vary), "Accept-Encoding");
+    EXPECT_EQ(response.headers_.get(header_id::content_type), "text/html");
+    ASSERT_TRUE(response.body_producer_ != nullptr);
+    std::string body = read_all(*response.body_producer_);
+    EXPECT_LT(body.size(), page_.size());
+    EXPECT_EQ(response.headers_.get(header_id::content_length), std::to_string(body.size()));
+    EXPECT_EQ(gunzip(body), page_);
+
+    // The variant is left next to the file, with the file's modification time
+    struct stat source, variant;
+    ASSERT_EQ(::stat((root_ + "/page.html").c_str(), &source), 0);
+    ASSERT_EQ(::stat((root_ + "/page.html.gz").c_str(), &variant), 0);
+    EXPECT_EQ(variant.st_mtim.tv_sec, source.st_mtim.tv_sec);
+    EXPECT_EQ(variant.st_mtim.tv_nsec, source.st_mtim.tv_nsec);
+}
+
+TEST_F(StaticRequestHandlerTest, ClientWithoutGzipGetsFile) {
+    Response response = serve("/static/page.html", "deflate");
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+    EXPECT_EQ(response.headers_.get(header_id::vary), "Accept-Encoding");
+    EXPECT_EQ(read_all(*response.body_producer_), page_);
+    EXPECT_NE(::access((root_ + "/page.html.gz").c_str(), F_OK), 0);
+}
+
+TEST_F(StaticRequestHandlerTest, RemakesVariantOfChangedFile) {
+    EXPECT_EQ(gunzip(read_all(*serve_variant("/static/page.html").body_producer_)), page_);
+
+    page_ = "<h1>changed</h1>\n" + page_;
+    write_file("page.html", page_);
+    struct timespec times[2] = { {1000000000, 0}, {1000000000, 0} };
+    ASSERT_EQ(::utimensat(AT_FDCWD, (root_ + "/page.html").c_str(), times, 0), 0);
+    // The stale variant is never sent
+    Response response = serve("/static/page.html", "gzip");
+    if (response.headers_.get(header_id::content_encoding).empty()) {
+        EXPECT_EQ(read_all(*response.body_producer_), page_);
+    }
+    EXPECT_EQ(gunzip(read_all(*serve_variant("/static/page.html").body_producer_)), page_);
+}
+
+TEST_F(StaticRequestHandlerTest, LeavesOtherFilesAlone) {
+    // Not a listed type
+    Response response = serve("/static/image.png", "gzip");
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+    EXPECT_TRUE(response.headers_.get(header_id::vary).empty());
+    EXPECT_EQ(read_all(*response.body_producer_), page_);
+
+    // Turned off
+    config_.compression.static_variants = false;
+    response = serve("/static/page.html", "gzip");
+    EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+    EXPECT_EQ(read_all(*response.body_producer_), page_);
+    EXPECT_NE(::access((root_ + "/page.html.gz").c_str(), F_OK), 0);
+}
+
+TEST_F(StaticRequestHandlerTest, DoesNotRetryFailedVariantUntilFileChanges) {
+    // A directory in the variant's place makes every build fail
+    ASSERT_EQ(::mkdir((root_ + "/page.html.gz").c_str(), 0755), 0);
+    struct timespec before = root_mtime();
+    EXPECT_TRUE(serve("/static/page.html", "gzip").headers_.get(header_id::content_encoding).empty());
+    for (int i = 0; i < 500 && same_time(root_mtime(), before); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_FALSE(same_time(root_mtime(), before));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    before = root_mtime();
+    for (int i = 0; i < 3; ++i) {
+        Response response = serve("/static/page.html", "gzip");
+        EXPECT_TRUE(response.headers_.get(header_id::content_encoding).empty());
+        EXPECT_EQ(read_all(*response.body_producer_), page_);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_TRUE(same_time(root_mtime(), before));
+
+    // Once the file changes it is tried again
+    struct timespec times[2] = { {1000000000, 0}, {1000000000, 0} };
+    ASSERT_EQ(::utimensat(AT_FDCWD, (root_ + "/page.html").c_str(), times, 0), 0);
+    serve("/static/page.html", "gzip");
+    for (int i = 0; i < 500 && same_time(root_mtime(), before); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_FALSE(same_time(root_mtime(), before));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
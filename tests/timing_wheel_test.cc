@@ -0,0 +1,98 @@
+#include <chrono>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "timing_wheel.h"
+
+class TimingWheelTest : public ::testing::Test {
+ protected:
+        TimingWheelTest() : wheel_(io_service_, std::chrono::milliseconds(10), 8) {}
+
+        void arm(timing_wheel::timer& t, int id, int timeout_ms) {
+            t.on_expire = [this, id]() { fired_.push_back(id); };
+            wheel_.schedule(t, std::chrono::milliseconds(timeout_ms));
+        }
+
+        void run_for(int ms) {
+            io_service_.restart();
+            io_service_.run_for(std::chrono::milliseconds(ms));
+        }
+
+        boost::asio::io_service io_service_;
+        timing_wheel wheel_;
+        std::vector<int> fired_;
+};
+
+TEST_F(TimingWheelTest, FiresInDeadlineOrder) {
+    timing_wheel::timer late, early;
+    arm(late, 2, 50);
+    arm(early, 1, 20);
+    EXPECT_EQ(wheel_.size(), 2);
+
+    wheel_.start();
+    run_for(150);
+    ASSERT_EQ(fired_.size(), 2);
+    EXPECT_EQ(fired_[0], 1);
+    EXPECT_EQ(fired_[1], 2);
+    EXPECT_FALSE(late.armed());
+    EXPECT_EQ(wheel_.size(), 0);
+}
+
+TEST_F(TimingWheelTest, CancelledTimerNeverFires) {
+    timing_wheel::timer t;
+    arm(t, 1, 20);
+    EXPECT_TRUE(t.armed());
+    wheel_.cancel(t);
+    EXPECT_FALSE(t.armed());
+
+    wheel_.start();
+    run_for(80);
+    EXPECT_TRUE(fired_.empty());
+}
+
+TEST_F(TimingWheelTest, RescheduleReplacesDeadline) {
+    timing_wheel::timer t;
+    arm(t, 1, 20);
+    wheel_.schedule(t, std::chrono::milliseconds(200));
+    EXPECT_EQ(wheel_.size(), 1);
+
+    wheel_.start();
+    run_for(80);
+    EXPECT_TRUE(fired_.empty());
+    EXPECT_TRUE(t.armed());
+    wheel_.cancel(t);
+}
+
+TEST_F(TimingWheelTest, ZeroTimeoutDisarms) {
+    timing_wheel::timer t;
+    arm(t, 1, 20);
+    wheel_.schedule(t, std::chrono::milliseconds(0));
+    EXPECT_FALSE(t.armed());
+    EXPECT_EQ(wheel_.size(), 0);
+}
+
+TEST_F(TimingWheelTest, TimeoutLongerThanOneRevolution) {
+    // 8 slots of 10ms: a 150ms timer shares a slot with 70ms and must wait a lap.
+    timing_wheel::timer t;
+    arm(t, 1, 150);
+
+    wheel_.start();
+    run_for(100);
+    EXPECT_TRUE(fired_.empty());
+    run_for(150);
+    ASSERT_EQ(fired_.size(), 1);
+}
+
+TEST_F(TimingWheelTest, ExpireIdleFiresOnlyIdleTimers) {
+    timing_wheel::timer idle, busy;
+    idle.idle = true;
+    arm(idle, 1, 1000);
+    arm(busy, 2, 1000);
+
+    EXPECT_EQ(wheel_.expire_idle(), 1);
+    ASSERT_EQ(fired_.size(), 1);
+    EXPECT_EQ(fired_[0], 1);
+    EXPECT_FALSE(idle.armed());
+    EXPECT_TRUE(busy.armed());
+    wheel_.cancel(busy);
+}